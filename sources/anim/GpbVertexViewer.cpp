@@ -22,6 +22,7 @@
 #include "sample/IndexBuffer.h"
 #include "sample/Texture.h"
 #include "sample/Mesh.h"
+#include "sample/MeshOptimizer.h"
 #include "transform_hier.h"
 #include "imgui_input.h"
 #include "hud.h"
@@ -99,6 +100,8 @@ void MeshFromGpbXml(Mesh& outMesh, GpbMesh& attributes)
     memcpy(texcoords, attributes.texcoords);
     memcpy(indices, attributes.indices);
 
+    // The vertex grids in the json files refer to vertices by index, only reorder triangles
+    OptimizeVertexCache(outMesh, "MeshFromGpbXml", false);
     outMesh.UpdateOpenGLBuffers();
 }
 
@@ -163,6 +166,7 @@ void MeshFromGpb(Mesh& outMesh, const el::NodePtr& node)
         }
     }
 
+    OptimizeVertexCache(outMesh, "MeshFromGpb", false);
     outMesh.UpdateOpenGLBuffers();
 }
 
@@ -0,0 +1,54 @@
+#version 330 core
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+in vec3 position;
+in vec3 normal;
+in vec2 texCoord;
+in vec4 weights;
+in ivec4 joints;
+
+uniform mat4 pose[120];
+uniform mat4 invBindPose[120];
+
+out vec3 norm;
+out vec3 fragPos;
+out vec2 uv;
+
+// Set by Mesh::SetCompactUniforms. Compact meshes store positions as 16 bit unorm
+// inside the mesh bounds and normals octahedral encoded in two snorms, 0 for floats
+uniform int compact;
+uniform vec3 positionMin;
+uniform vec3 positionExtent;
+
+vec3 decodePosition(vec3 p) {
+	return compact != 0 ? positionMin + p * positionExtent : p;
+}
+
+vec3 decodeNormal(vec3 n) {
+	if (compact == 0) {
+		return n;
+	}
+	vec3 o = vec3(n.xy, 1.0 - abs(n.x) - abs(n.y));
+	float t = max(-o.z, 0.0);
+	o.x += o.x >= 0.0 ? -t : t;
+	o.y += o.y >= 0.0 ? -t : t;
+	return normalize(o);
+}
+
+void main() {
+	vec3 localPosition = decodePosition(position);
+	vec3 localNormal = decodeNormal(normal);
+	// Vertices with at most 3 joints, sorted by Mesh::SortByInfluenceCount
+	mat4 skin = (pose[joints.x] *  invBindPose[joints.x]) * weights.x;
+	skin += (pose[joints.y] *  invBindPose[joints.y]) * weights.y;
+	skin += (pose[joints.z] * invBindPose[joints.z]) * weights.z;
+
+	gl_Position = projection * view * model * skin * vec4(localPosition, 1.0);
+    
+	fragPos = vec3(model * skin * vec4(localPosition, 1.0));
+	norm = vec3(model * skin * vec4(localNormal, 0.0f));
+	uv = texCoord;
+}
@@ -12,10 +12,33 @@ out vec3 norm;
 out vec3 fragPos;
 out vec2 uv;
 
+// Set by Mesh::SetCompactUniforms. Compact meshes store positions as 16 bit unorm
+// inside the mesh bounds and normals octahedral encoded in two snorms, 0 for floats
+uniform int compact;
+uniform vec3 positionMin;
+uniform vec3 positionExtent;
+
+vec3 decodePosition(vec3 p) {
+	return compact != 0 ? positionMin + p * positionExtent : p;
+}
+
+vec3 decodeNormal(vec3 n) {
+	if (compact == 0) {
+		return n;
+	}
+	vec3 o = vec3(n.xy, 1.0 - abs(n.x) - abs(n.y));
+	float t = max(-o.z, 0.0);
+	o.x += o.x >= 0.0 ? -t : t;
+	o.y += o.y >= 0.0 ? -t : t;
+	return normalize(o);
+}
+
 void main() {
-	gl_Position = projection * view * model * vec4(position, 1.0);
+	vec3 localPosition = decodePosition(position);
+	vec3 localNormal = decodeNormal(normal);
+	gl_Position = projection * view * model * vec4(localPosition, 1.0);
 	
-	fragPos = vec3(model * vec4(position, 1.0));
-	norm = vec3(model * vec4(normal, 0.0f));
+	fragPos = vec3(model * vec4(localPosition, 1.0));
+	norm = vec3(model * vec4(localNormal, 0.0f));
 	uv = texCoord;
 }
\ No newline at end of file
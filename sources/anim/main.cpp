@@ -11,6 +11,7 @@
 #include <Chapter09Sample01.h>
 #include <Chapter10Sample01.h>
 #include <Chapter10Sample02.h>
+#include <BenchmarkSample.h>
 #include <Profile.h>
 #include <ImGuizmo.h>
 
@@ -121,6 +122,7 @@ enum class EnumSample {
     kChapter10Sample02,
     kDecomposeSample,
     kXmlViewer,
+    kBenchmarkSample,
 };
 
 std::vector<const char*> SampleName {
@@ -129,7 +131,8 @@ std::vector<const char*> SampleName {
     "Chapter10/Sample01",
     "Chapter10/Sample02",
     "Sample/Decompose",
-    "Sample/XmlViewer"
+    "Sample/XmlViewer",
+    "Sample/Benchmark"
 };
 
 std::shared_ptr<Application> Factory(EnumSample kSample) 
@@ -147,6 +150,8 @@ std::shared_ptr<Application> Factory(EnumSample kSample)
         return std::make_shared<DecomposeSample>();
     case EnumSample::kXmlViewer:
         return std::make_shared<GpbVertexViewer>();
+    case EnumSample::kBenchmarkSample:
+        return std::make_shared<BenchmarkSample>();
     };
     return nullptr;
 }
@@ -160,6 +165,7 @@ void UpdateMenuUI()
         EnumSample::kChapter10Sample01,
         EnumSample::kChapter10Sample02,
         EnumSample::kDecomposeSample,
+        EnumSample::kBenchmarkSample,
     };
     std::vector<const char*> items;
     for (auto kSample : sampleList)
@@ -390,6 +396,7 @@ int main(int, char**)
     GLuint gVertexArrayObject = 0;
     glGenVertexArrays(1, &gVertexArrayObject);
     glBindVertexArray(gVertexArrayObject);
+    Mesh::SetDefaultVertexArray(gVertexArrayObject);
 
     while (!glfwWindowShouldClose(window)) {
         profile.EventMessageStart();
@@ -458,6 +465,7 @@ int main(int, char**)
     nvgDeleteGL3(vg);
 
     glBindVertexArray(0);
+    Mesh::SetDefaultVertexArray(0);
     glDeleteVertexArrays(1, &gVertexArrayObject);
     gVertexArrayObject = 0;
 
@@ -8,18 +8,6 @@
 #include "vec4.h"
 #include "quat.h"
 
-template Attribute<int>;
-template Attribute<float>;
-template Attribute<vec2>;
-template Attribute<vec3>;
-template Attribute<vec4>;
-template Attribute<ivec4>;
-template Attribute<quat>;
-
-template Attribute<glm::vec2>;
-template Attribute<glm::vec3>;
-template Attribute<glm::vec4>;
-
 
 template<typename T>
 unsigned int Attribute<T>::Count() {
@@ -28,55 +16,73 @@ unsigned int Attribute<T>::Count() {
 
 template<typename T>
 unsigned int Attribute<T>::GetHandle() {
-	return mHandle;
+	return mStream != 0 ? mStream->GetHandle() : mHandle;
+}
+
+template<typename T>
+unsigned int Attribute<T>::GetOffset() {
+	return mStream != 0 ? mStream->GetOffset() : 0;
 }
 
 template<>
-void Attribute<int>::SetAttribPointer(unsigned int slot) {
-	glVertexAttribIPointer(slot, 1, GL_INT, 0, (void*)0);
+void Attribute<int>::SetAttribPointer(unsigned int slot, unsigned int offset) {
+	glVertexAttribIPointer(slot, 1, GL_INT, 0, (void*)(size_t)offset);
 }
 
 template<>
-void Attribute<ivec4>::SetAttribPointer(unsigned int slot) {
-	glVertexAttribIPointer(slot, 4, GL_INT, 0, (void*)0);
+void Attribute<ivec4>::SetAttribPointer(unsigned int slot, unsigned int offset) {
+	glVertexAttribIPointer(slot, 4, GL_INT, 0, (void*)(size_t)offset);
 }
 
 template<>
-void Attribute<float>::SetAttribPointer(unsigned int slot) {
-	glVertexAttribPointer(slot, 1, GL_FLOAT, GL_FALSE, 0, (void*)0);
+void Attribute<float>::SetAttribPointer(unsigned int slot, unsigned int offset) {
+	glVertexAttribPointer(slot, 1, GL_FLOAT, GL_FALSE, 0, (void*)(size_t)offset);
 }
 
 template<>
-void Attribute<vec2>::SetAttribPointer(unsigned int slot) {
-	glVertexAttribPointer(slot, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+void Attribute<vec2>::SetAttribPointer(unsigned int slot, unsigned int offset) {
+	glVertexAttribPointer(slot, 2, GL_FLOAT, GL_FALSE, 0, (void*)(size_t)offset);
 }
 
 template<>
-void Attribute<vec3>::SetAttribPointer(unsigned int slot) {
-	glVertexAttribPointer(slot, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+void Attribute<vec3>::SetAttribPointer(unsigned int slot, unsigned int offset) {
+	glVertexAttribPointer(slot, 3, GL_FLOAT, GL_FALSE, 0, (void*)(size_t)offset);
 }
 
 template<>
-void Attribute<vec4>::SetAttribPointer(unsigned int slot) {
-	glVertexAttribPointer(slot, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+void Attribute<vec4>::SetAttribPointer(unsigned int slot, unsigned int offset) {
+	glVertexAttribPointer(slot, 4, GL_FLOAT, GL_FALSE, 0, (void*)(size_t)offset);
 }
 
 template<>
-void Attribute<quat>::SetAttribPointer(unsigned int slot) {
-	glVertexAttribPointer(slot, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+void Attribute<quat>::SetAttribPointer(unsigned int slot, unsigned int offset) {
+	glVertexAttribPointer(slot, 4, GL_FLOAT, GL_FALSE, 0, (void*)(size_t)offset);
 }
 
 template<>
-void Attribute<glm::vec2>::SetAttribPointer(unsigned int slot) {
-	glVertexAttribPointer(slot, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+void Attribute<glm::vec2>::SetAttribPointer(unsigned int slot, unsigned int offset) {
+	glVertexAttribPointer(slot, 2, GL_FLOAT, GL_FALSE, 0, (void*)(size_t)offset);
 }
 
 template<>
-void Attribute<glm::vec3>::SetAttribPointer(unsigned int slot) {
-	glVertexAttribPointer(slot, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+void Attribute<glm::vec3>::SetAttribPointer(unsigned int slot, unsigned int offset) {
+	glVertexAttribPointer(slot, 3, GL_FLOAT, GL_FALSE, 0, (void*)(size_t)offset);
 }
 
 template<>
-void Attribute<glm::vec4>::SetAttribPointer(unsigned int slot) {
-	glVertexAttribPointer(slot, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+void Attribute<glm::vec4>::SetAttribPointer(unsigned int slot, unsigned int offset) {
+	glVertexAttribPointer(slot, 4, GL_FLOAT, GL_FALSE, 0, (void*)(size_t)offset);
 }
+
+// After every member definition, so all of them are instantiated
+template Attribute<int>;
+template Attribute<float>;
+template Attribute<vec2>;
+template Attribute<vec3>;
+template Attribute<vec4>;
+template Attribute<ivec4>;
+template Attribute<quat>;
+
+template Attribute<glm::vec2>;
+template Attribute<glm::vec3>;
+template Attribute<glm::vec4>;
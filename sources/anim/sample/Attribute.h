@@ -4,16 +4,19 @@
 #include <vector>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <cstring>
+#include "StreamRing.h"
 
 template<typename T>
 class Attribute {
 protected:
 	unsigned int mHandle;
 	unsigned int mCount;
+	StreamRing* mStream; // Set when streaming, owns the buffer draws read from
 private:
 	Attribute(const Attribute& other);
 	Attribute& operator=(const Attribute& other);
-	void SetAttribPointer(unsigned int slot);
+	void SetAttribPointer(unsigned int slot, unsigned int offset);
 public:
 	Attribute();
 	~Attribute();
@@ -21,26 +24,73 @@ public:
 	void Set(T* inputArray, unsigned int arrayLength);
 	void Set(std::vector<T>& input);
 
+	// Streaming attributes are rewritten every frame (CPU skinning) through a StreamRing
+	// instead of reallocating their storage in each Set
+	void SetStreaming(bool streaming);
+	bool IsStreaming();
+	// Streaming only: room for arrayLength values, write them and call Unmap before
+	// drawing. Mapped memory is write only, do not read it back.
+	T* Map(unsigned int arrayLength);
+	void Unmap();
+
 	void BindTo(unsigned int slot);
 	void UnBindFrom(unsigned int slot);
 
 	unsigned int Count();
 	unsigned int GetHandle();
+	// Byte offset of the data in GetHandle's buffer, not 0 when streaming
+	unsigned int GetOffset();
 };
 
 template<typename T>
 Attribute<T>::Attribute() {
     glGenBuffers(1, &mHandle);
     mCount = 0;
+    mStream = 0;
 }
 
 template<typename T>
 Attribute<T>::~Attribute() {
+    delete mStream;
     glDeleteBuffers(1, &mHandle);
 }
 
+template<typename T>
+void Attribute<T>::SetStreaming(bool streaming) {
+    if (streaming && mStream == 0) {
+        mStream = new StreamRing(GL_ARRAY_BUFFER);
+    }
+    else if (!streaming && mStream != 0) {
+        delete mStream;
+        mStream = 0;
+        mCount = 0;
+    }
+}
+
+template<typename T>
+bool Attribute<T>::IsStreaming() {
+    return mStream != 0;
+}
+
+template<typename T>
+T* Attribute<T>::Map(unsigned int arrayLength) {
+    mCount = arrayLength;
+    return (T*)mStream->Map(sizeof(T) * arrayLength);
+}
+
+template<typename T>
+void Attribute<T>::Unmap() {
+    mStream->Unmap();
+}
+
 template<typename T>
 void Attribute<T>::Set(T* inputArray, unsigned int arrayLength) {
+    if (mStream != 0) {
+        memcpy(Map(arrayLength), inputArray, sizeof(T) * arrayLength);
+        Unmap();
+        return;
+    }
+
     mCount = arrayLength;
     unsigned int size = sizeof(T);
 
@@ -56,25 +106,15 @@ void Attribute<T>::Set(std::vector<T>& input) {
 
 template<typename T>
 void Attribute<T>::BindTo(unsigned int slot) {
-    glBindBuffer(GL_ARRAY_BUFFER, mHandle);
-    auto e = glGetError();
-
+    glBindBuffer(GL_ARRAY_BUFFER, GetHandle());
     glEnableVertexAttribArray(slot);
-    e = glGetError();
-
-    SetAttribPointer(slot);
-    e = glGetError();
-
+    SetAttribPointer(slot, GetOffset());
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    e = glGetError();
-
 }
 
 template<typename T>
 void Attribute<T>::UnBindFrom(unsigned int slot) {
-    glBindBuffer(GL_ARRAY_BUFFER, mHandle);
     glDisableVertexAttribArray(slot);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 #endif
@@ -0,0 +1,659 @@
+#include "BenchmarkSample.h"
+
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <imgui.h>
+#include <el_debug.h>
+
+#include "GLTFLoader.h"
+#include "SoAClip.h"
+#include "SoAPose.h"
+#include "BlendGraph.h"
+#include "StaticClip.h"
+#include "BoundClip.h"
+
+namespace BenchmarkHelpers {
+	// Average time of one call to func in microseconds, best of a few rounds
+	template<typename F>
+	double Time(unsigned int iterations, F func) {
+		func(); // Warm up caches
+		double best = 0.0;
+		for (unsigned int round = 0; round < 5; ++round) {
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			for (unsigned int i = 0; i < iterations; ++i) {
+				func();
+			}
+			std::chrono::high_resolution_clock::time_point stop = std::chrono::high_resolution_clock::now();
+			double time = std::chrono::duration<double, std::micro>(stop - start).count() / (double)iterations;
+			best = round == 0 || time < best ? time : best;
+		}
+		return best;
+	}
+
+	// Gives a linear track Catmull-Rom tangents, so the cubic paths can be timed on a
+	// clip with as many keys as the linear one
+	template<typename T, int N>
+	void MakeCubic(Track<T, N>& track) {
+		unsigned int size = track.Size();
+		if (size < 3) {
+			return;
+		}
+		track.SetInterpolation(Interpolation::Cubic);
+		for (unsigned int i = 0; i < size; ++i) {
+			unsigned int prev = i > 0 ? i - 1 : 0;
+			unsigned int next = i + 1 < size ? i + 1 : size - 1;
+			float delta = track[next].mTime - track[prev].mTime;
+			for (int c = 0; c < N; ++c) {
+				float slope = (track[next].mValue[c] - track[prev].mValue[c]) / delta;
+				track[i].mIn[c] = slope;
+				track[i].mOut[c] = slope;
+			}
+		}
+	}
+
+	// 250 joints in ten chains of 25, each chain hanging off the fourth joint of the previous
+	// one. Stored children first, so nothing is in parent order by accident.
+	inline Skeleton MakeSyntheticSkeleton() {
+		const unsigned int numJoints = 250;
+		const unsigned int chainLength = 25;
+		Pose pose(numJoints);
+		std::vector<std::string> names(numJoints);
+		for (unsigned int i = 0; i < numJoints; ++i) {
+			unsigned int chain = i / chainLength;
+			unsigned int link = i % chainLength;
+			int parent = link > 0 ? (int)i - 1 : (chain > 0 ? (int)((chain - 1) * chainLength + 3) : -1);
+
+			unsigned int index = numJoints - 1 - i;
+			Transform local;
+			local.position = vec3(0.1f * (float)link, 1.0f, 0.05f * (float)chain);
+			local.rotation = angleAxis(0.05f * (float)(i % 7), normalized(vec3(1.0f, 0.3f, 0.2f)));
+			pose.SetParent(index, parent < 0 ? -1 : (int)(numJoints - 1) - parent);
+			pose.SetLocalTransform(index, local);
+			names[index] = "Joint" + std::to_string(i);
+		}
+		return Skeleton(pose, pose, names);
+	}
+
+	inline Clip MakeCubic(Clip& clip) {
+		Clip result = clip;
+		for (unsigned int i = 0, size = result.Size(); i < size; ++i) {
+			TransformTrack& track = result[result.GetIdAtIndex(i)];
+			MakeCubic(track.GetPositionTrack());
+			MakeCubic(track.GetRotationTrack());
+			MakeCubic(track.GetScaleTrack());
+		}
+		return result;
+	}
+
+	// count copies of every mesh as one mesh, a single skinning target with 100k+ vertices
+	inline void MergeMeshes(Mesh& out, std::vector<Mesh>& meshes, unsigned int count) {
+		for (unsigned int c = 0; c < count; ++c) {
+			for (unsigned int i = 0, size = (unsigned int)meshes.size(); i < size; ++i) {
+				Mesh& mesh = meshes[i];
+				unsigned int offset = (unsigned int)out.GetPosition().size();
+				out.GetPosition().insert(out.GetPosition().end(), mesh.GetPosition().begin(), mesh.GetPosition().end());
+				out.GetNormal().insert(out.GetNormal().end(), mesh.GetNormal().begin(), mesh.GetNormal().end());
+				out.GetTexCoord().insert(out.GetTexCoord().end(), mesh.GetTexCoord().begin(), mesh.GetTexCoord().end());
+				out.GetWeights().insert(out.GetWeights().end(), mesh.GetWeights().begin(), mesh.GetWeights().end());
+				out.GetInfluences().insert(out.GetInfluences().end(), mesh.GetInfluences().begin(), mesh.GetInfluences().end());
+				for (unsigned int j = 0, numIndices = (unsigned int)mesh.GetIndices().size(); j < numIndices; ++j) {
+					out.GetIndices().push_back(mesh.GetIndices()[j] + offset);
+				}
+			}
+		}
+	}
+}
+
+void BenchmarkSample::Initialize() {
+	cgltf_data* gltf = LoadGLTFFile("Assets/Woman.gltf");
+	WorkerPool pool;
+	unsigned int numCores = std::thread::hardware_concurrency();
+	pool.Start(numCores > 1 ? numCores - 1 : 0);
+	LoadGLTFParallel(gltf, mMeshes, mSkeleton, mClips, pool);
+	FreeGLTFFile(gltf);
+	UploadMeshes(mMeshes);
+
+	Run();
+}
+
+void BenchmarkSample::Shutdown() {
+	mClips.clear();
+	mMeshes.clear();
+	mResults.clear();
+}
+
+Clip* BenchmarkSample::FindClip(const std::string& name) {
+	for (unsigned int i = 0, size = (unsigned int)mClips.size(); i < size; ++i) {
+		if (mClips[i].GetName() == name) {
+			return &mClips[i];
+		}
+	}
+	return 0;
+}
+
+void BenchmarkSample::AddResult(const std::string& name, double us, double reference) {
+	double speedup = us > 0.0 ? reference / us : 0.0;
+	mResults.push_back(BenchmarkResult(name, us, speedup));
+	el::trace("%-40s %10.3f us  x%.2f\n", name.c_str(), us, speedup);
+}
+
+void BenchmarkSample::Run() {
+	mResults.clear();
+	RunClipSampling();
+	RunCubicSampling();
+	RunPaletteBuilding();
+	RunPoseBlending();
+	RunSkinning();
+	RunLoading();
+}
+
+void BenchmarkSample::RunClipSampling() {
+	const unsigned int iterations = 20000;
+	const float deltaTime = 1.0f / 60.0f;
+	const char* names[] = { "Walking", "Running" };
+	unsigned int numJoints = mSkeleton.GetRestPose().Size();
+
+	for (unsigned int i = 0; i < 2; ++i) {
+		Clip* clip = FindClip(names[i]);
+		if (clip == 0) {
+			continue;
+		}
+		Pose pose = mSkeleton.GetRestPose();
+		SoAPose soaPose;
+		soaPose.FromPose(pose);
+		SoAClip soaClip = MakeSoAClip(*clip, numJoints);
+		float time = 0.0f;
+
+		double reference = BenchmarkHelpers::Time(iterations, [&]() {
+			time = clip->Sample(pose, time + deltaTime);
+		});
+		AddResult(std::string(names[i]) + ": Clip::Sample", reference, reference);
+
+		Clip reduced = ReduceClip(*clip);
+		ClipCursor cursor;
+		time = 0.0f;
+		double reduce = BenchmarkHelpers::Time(iterations, [&]() {
+			time = reduced.Sample(pose, time + deltaTime, cursor);
+		});
+		AddResult(std::string(names[i]) + ": ReduceClip, cursor", reduce, reference);
+		el::trace("%-40s %u -> %u bytes\n", (std::string(names[i]) + ": ReduceClip").c_str(),
+			clip->GetMemorySize(), reduced.GetMemorySize());
+
+		QuantizedClip quantized = QuantizeClip(*clip);
+		ClipCursor quantizedCursor;
+		time = 0.0f;
+		double quantize = BenchmarkHelpers::Time(iterations, [&]() {
+			time = quantized.Sample(pose, time + deltaTime, quantizedCursor);
+		});
+		AddResult(std::string(names[i]) + ": QuantizeClip, cursor", quantize, reference);
+		el::trace("%-40s %u -> %u bytes\n", (std::string(names[i]) + ": QuantizeClip").c_str(),
+			clip->GetMemorySize(), quantized.GetMemorySize());
+		std::vector<JointError> errors = MeasureClipError(*clip, quantized, mSkeleton.GetRestPose());
+		for (unsigned int j = 0, size = (unsigned int)errors.size(); j < size; ++j) {
+			el::trace("    %-24s position %f rotation %f scale %f\n", mSkeleton.GetJointName(errors[j].mJoint).c_str(),
+				errors[j].mPosition, errors[j].mRotation, errors[j].mScale);
+		}
+
+		BoundClip boundClip = BindClip(*clip, mSkeleton);
+		ClipCursor boundCursor;
+		time = 0.0f;
+		double bound = BenchmarkHelpers::Time(iterations, [&]() {
+			time = boundClip.Sample(pose, time + deltaTime, boundCursor);
+		});
+		AddResult(std::string(names[i]) + ": BoundClip, cursor", bound, reference);
+
+		StaticClip staticClip = MakeStaticClip(*clip);
+		ClipCursor staticCursor;
+		time = 0.0f;
+		double specialized = BenchmarkHelpers::Time(iterations, [&]() {
+			time = staticClip.Sample(pose, time + deltaTime, staticCursor);
+		});
+		AddResult(std::string(names[i]) + ": StaticClip, cursor", specialized, reference);
+
+		time = 0.0f;
+		double soa = BenchmarkHelpers::Time(iterations, [&]() {
+			time = soaClip.Sample(soaPose, time + deltaTime);
+		});
+		AddResult(std::string(names[i]) + ": SoAClip::Sample", soa, reference);
+	}
+}
+
+void BenchmarkSample::RunCubicSampling() {
+	const unsigned int iterations = 20000;
+	const float deltaTime = 1.0f / 60.0f;
+
+	// The CUBICSPLINE channels shipped with the samples
+	cgltf_data* gltf = LoadGLTFFile("Assets/dq.gltf");
+	Skeleton skeleton = LoadSkeleton(gltf);
+	std::vector<Clip> clips = LoadAnimationClips(gltf);
+	FreeGLTFFile(gltf);
+
+	// dq.gltf only animates a few joints, Woman.gltf with Catmull-Rom tangents is the bigger case
+	Clip* walking = FindClip("Walking");
+	if (walking != 0) {
+		clips.push_back(BenchmarkHelpers::MakeCubic(*walking));
+		clips.back().SetName("Walking (cubic)");
+	}
+
+	for (unsigned int i = 0, size = (unsigned int)clips.size(); i < size; ++i) {
+		Clip& clip = clips[i];
+		Pose pose = i + 1 == size && walking != 0 ? mSkeleton.GetRestPose() : skeleton.GetRestPose();
+		CubicClip cubic = PrecomputeClip(clip);
+		ClipCursor cursor;
+		float time = 0.0f;
+
+		double reference = BenchmarkHelpers::Time(iterations, [&]() {
+			time = clip.Sample(pose, time + deltaTime, cursor);
+		});
+		AddResult(clip.GetName() + ": Clip::Sample, cursor", reference, reference);
+
+		cursor.Reset();
+		time = 0.0f;
+		double precomputed = BenchmarkHelpers::Time(iterations, [&]() {
+			time = cubic.Sample(pose, time + deltaTime, cursor);
+		});
+		AddResult(clip.GetName() + ": PrecomputeClip, cursor", precomputed, reference);
+	}
+}
+
+void BenchmarkSample::RunPaletteBuilding() {
+	const unsigned int iterations = 5000;
+	Skeleton synthetic = BenchmarkHelpers::MakeSyntheticSkeleton();
+	Skeleton* skeletons[] = { &mSkeleton, &synthetic };
+	const char* names[] = { "Woman", "Synthetic 250" };
+
+	for (unsigned int i = 0; i < 2; ++i) {
+		Skeleton& skeleton = *skeletons[i];
+		Pose pose = skeleton.GetRestPose();
+		std::vector<mat4> palette;
+
+		double reference = BenchmarkHelpers::Time(iterations, [&]() {
+			pose.GetMatrixPalette(palette);
+		});
+		AddResult(std::string(names[i]) + ": GetMatrixPalette", reference, reference);
+
+		double ordered = BenchmarkHelpers::Time(iterations, [&]() {
+			pose.GetMatrixPalette(palette, skeleton.GetJointOrder());
+		});
+		AddResult(std::string(names[i]) + ": GetMatrixPalette, joint order", ordered, reference);
+
+		std::vector<DualQuaternion> dualQuaternions;
+		std::vector<Transform> globals;
+		double dualQuaternion = BenchmarkHelpers::Time(iterations, [&]() {
+			pose.GetDualQuaternionPalette(dualQuaternions, skeleton.GetJointOrder(), globals);
+		});
+		AddResult(std::string(names[i]) + ": GetDualQuaternionPalette, joint order", dualQuaternion, reference);
+
+		// One leaf edited per frame, as an IK or look-at pass would. The last joint is not
+		// always one, on Woman it is a root
+		unsigned int leaf = 0;
+		for (unsigned int j = 0, size = pose.Size(); j < size; ++j) {
+			bool hasChildren = false;
+			for (unsigned int k = 0; k < size && !hasChildren; ++k) {
+				hasChildren = pose.GetParent(k) == (int)j;
+			}
+			leaf = hasChildren || pose.GetParent(j) < 0 ? leaf : j;
+		}
+		Transform local = pose.GetLocalTransform(leaf);
+		double edited = BenchmarkHelpers::Time(iterations, [&]() {
+			pose.SetLocalTransform(leaf, local);
+			pose.GetMatrixPalette(palette);
+		});
+		AddResult(std::string(names[i]) + ": one joint edited", edited, reference);
+
+		pose.EnableGlobalCache(true);
+		double cached = BenchmarkHelpers::Time(iterations, [&]() {
+			pose.SetLocalTransform(leaf, local);
+			pose.GetMatrixPalette(palette);
+		});
+		AddResult(std::string(names[i]) + ": one joint edited, global cache", cached, reference);
+
+		double cachedOrdered = BenchmarkHelpers::Time(iterations, [&]() {
+			pose.SetLocalTransform(leaf, local);
+			pose.GetMatrixPalette(palette, skeleton.GetJointOrder());
+		});
+		AddResult(std::string(names[i]) + ": one joint edited, global cache, joint order", cachedOrdered, reference);
+	}
+}
+
+void BenchmarkSample::ImGui(nk_context* inContext) {
+	ImGui::Begin("Benchmark");
+	if (ImGui::Button("Run again")) {
+		Run();
+	}
+	ImGui::Separator();
+	for (unsigned int i = 0, size = (unsigned int)mResults.size(); i < size; ++i) {
+		BenchmarkResult& result = mResults[i];
+		ImGui::Text("%-40s %10.3f us  x%.2f", result.mName.c_str(), result.mMicroseconds, result.mSpeedup);
+	}
+	ImGui::End();
+}
+
+void BenchmarkSample::RunPoseBlending() {
+	const unsigned int iterations = 20000;
+	Clip* walking = FindClip("Walking");
+	Clip* running = FindClip("Running");
+	if (walking == 0 || running == 0) {
+		return;
+	}
+	Pose a = mSkeleton.GetRestPose();
+	Pose b = a;
+	Pose out = a;
+	walking->Sample(a, 0.3f);
+	running->Sample(b, 0.3f);
+	unsigned int numJoints = a.Size();
+
+	double reference = BenchmarkHelpers::Time(iterations, [&]() {
+		for (unsigned int i = 0; i < numJoints; ++i) {
+			out.SetLocalTransform(i, mix(a.GetLocalTransform(i), b.GetLocalTransform(i), 0.4f));
+		}
+	});
+	AddResult("Woman: Transform mix per joint", reference, reference);
+
+	SoAPose soaA;
+	SoAPose soaB;
+	SoAPose soaOut;
+	soaA.FromPose(a);
+	soaB.FromPose(b);
+	double blend = BenchmarkHelpers::Time(iterations, [&]() {
+		Blend(soaOut, soaA, soaB, 0.4f);
+	});
+	AddResult("Woman: SoA Blend", blend, reference);
+
+	std::vector<float> mask = MakeJointMask(soaA, numJoints > 1 ? 1 : -1);
+	double masked = BenchmarkHelpers::Time(iterations, [&]() {
+		Blend(soaOut, soaA, soaB, 0.4f, mask);
+	});
+	AddResult("Woman: SoA Blend, masked", masked, reference);
+
+	SoAPose soaBase;
+	soaBase.FromPose(mSkeleton.GetRestPose());
+	double add = BenchmarkHelpers::Time(iterations, [&]() {
+		Add(soaOut, soaA, soaB, soaBase, 0.5f);
+	});
+	AddResult("Woman: SoA Add", add, reference);
+
+	// The reference folded into the keys, no base pose to sample or invert per frame
+	Clip deltaClip = MakeAdditiveClip(*running, a);
+	Pose delta;
+	MakeDeltaPose(delta, a);
+	deltaClip.Sample(delta, 0.3f);
+	SoAPose soaDelta;
+	soaDelta.FromPose(delta);
+	double addDelta = BenchmarkHelpers::Time(iterations, [&]() {
+		AddDelta(soaOut, soaA, soaDelta, 0.5f);
+	});
+	AddResult("Woman: SoA AddDelta, additive clip", addDelta, reference);
+
+	std::vector<mat4> palette;
+	double posePalette = BenchmarkHelpers::Time(iterations, [&]() {
+		a.GetMatrixPalette(palette, mSkeleton.GetJointOrder());
+	});
+	AddResult("Woman: Pose palette, joint order", posePalette, posePalette);
+	double soaPalette = BenchmarkHelpers::Time(iterations, [&]() {
+		soaA.GetMatrixPalette(palette, mSkeleton.GetJointOrder());
+	});
+	AddResult("Woman: SoAPose palette, joint order", soaPalette, posePalette);
+
+	// Crossfade, masked layer and additive over four clips, for a crowd of characters
+	const unsigned int numCharacters = 100;
+	std::vector<SoAClip> clips;
+	for (unsigned int i = 0; i < 4 && i < mClips.size(); ++i) {
+		clips.push_back(MakeSoAClip(mClips[i], numJoints));
+	}
+	if (clips.size() < 4) {
+		return;
+	}
+	Pose additiveReference = mSkeleton.GetRestPose();
+	mClips[3].Sample(additiveReference, mClips[3].GetStartTime());
+	// The same tree blended per joint on Pose, with the book's Transform and quat math
+	std::vector<Pose> sampled(4, mSkeleton.GetRestPose());
+	std::vector<float> times(numCharacters * 4, 0.0f);
+	for (unsigned int i = 0; i < numCharacters; ++i) {
+		times[i * 4] = i * 0.01f;
+	}
+	std::vector<Pose> poses(numCharacters, mSkeleton.GetRestPose());
+	double perJoint = BenchmarkHelpers::Time(20, [&]() {
+		for (unsigned int i = 0; i < numCharacters; ++i) {
+			for (unsigned int c = 0; c < 4; ++c) {
+				sampled[c] = mSkeleton.GetRestPose();
+				times[i * 4 + c] = mClips[c].Sample(sampled[c], times[i * 4 + c] + 1.0f / 60.0f);
+			}
+			for (unsigned int j = 0; j < numJoints; ++j) {
+				Transform result = mix(sampled[0].GetLocalTransform(j), sampled[1].GetLocalTransform(j), 0.3f);
+				result = mix(result, sampled[2].GetLocalTransform(j), 0.7f * mask[j]);
+				Transform additive = sampled[3].GetLocalTransform(j);
+				Transform base = additiveReference.GetLocalTransform(j);
+				quat delta = inverse(base.rotation) * additive.rotation;
+				if (delta.w < 0.0f) {
+					delta = -delta;
+				}
+				result.position = result.position + (additive.position - base.position) * 0.5f;
+				result.rotation = normalized(result.rotation * nlerp(quat(), delta, 0.5f));
+				result.scale = result.scale + (additive.scale - base.scale) * 0.5f;
+				poses[i].SetLocalTransform(j, result);
+			}
+		}
+	});
+	AddResult("100 characters: Pose, per joint, 4 clips", perJoint, perJoint);
+
+	std::vector<BlendGraph> graphs(numCharacters);
+	for (unsigned int i = 0; i < numCharacters; ++i) {
+		BlendGraph& graph = graphs[i];
+		graph.Initialize(mSkeleton.GetRestPose(), 4);
+		unsigned int crossfade = graph.AddCrossfade(graph.AddClip(&clips[0], i * 0.01f), graph.AddClip(&clips[1]), 0.3f);
+		unsigned int layer = graph.AddLayer(crossfade, graph.AddClip(&clips[2]), mask, 0.7f);
+		graph.AddAdditive(layer, graph.AddClip(&clips[3]), additiveReference, 0.5f);
+	}
+	double graph = BenchmarkHelpers::Time(20, [&]() {
+		for (unsigned int i = 0; i < numCharacters; ++i) {
+			graphs[i].Update(1.0f / 60.0f);
+			graphs[i].Evaluate(poses[i]);
+		}
+	});
+	AddResult("100 characters: BlendGraph, 4 clips", graph, perJoint);
+}
+
+void BenchmarkSample::RunSkinning() {
+	const unsigned int iterations = 200;
+	Clip* walking = FindClip("Walking");
+	if (walking == 0 || mMeshes.size() == 0) {
+		return;
+	}
+	Pose pose = mSkeleton.GetRestPose();
+	walking->Sample(pose, 0.4f);
+	unsigned int numMeshes = (unsigned int)mMeshes.size();
+
+	double reference = BenchmarkHelpers::Time(iterations, [&]() {
+		for (unsigned int i = 0; i < numMeshes; ++i) {
+			mMeshes[i].CPUSkin(mSkeleton, pose);
+		}
+	});
+	AddResult("Woman: CPUSkin, palette per mesh", reference, reference);
+
+	std::vector<mat4> skinPalette;
+	double shared = BenchmarkHelpers::Time(iterations, [&]() {
+		mSkeleton.GetSkinPalette(pose, skinPalette);
+		for (unsigned int i = 0; i < numMeshes; ++i) {
+			mMeshes[i].CPUSkin(skinPalette);
+		}
+	});
+	AddResult("Woman: CPUSkin, shared skin palette", shared, reference);
+
+	double simd = BenchmarkHelpers::Time(iterations, [&]() {
+		mSkeleton.GetSkinPalette(pose, skinPalette);
+		for (unsigned int i = 0; i < numMeshes; ++i) {
+			mMeshes[i].CPUSkinSIMD(skinPalette);
+		}
+	});
+	AddResult("Woman: CPUSkinSIMD, shared skin palette", simd, reference);
+
+	std::vector<Mesh> sorted = mMeshes;
+	for (unsigned int i = 0; i < numMeshes; ++i) {
+		sorted[i].SortByInfluenceCount();
+	}
+	double sortedScalar = BenchmarkHelpers::Time(iterations, [&]() {
+		mSkeleton.GetSkinPalette(pose, skinPalette);
+		for (unsigned int i = 0; i < numMeshes; ++i) {
+			sorted[i].CPUSkin(skinPalette);
+		}
+	});
+	AddResult("Woman: CPUSkin, sorted by influence count", sortedScalar, reference);
+	double sortedSIMD = BenchmarkHelpers::Time(iterations, [&]() {
+		mSkeleton.GetSkinPalette(pose, skinPalette);
+		for (unsigned int i = 0; i < numMeshes; ++i) {
+			sorted[i].CPUSkinSIMD(skinPalette);
+		}
+	});
+	AddResult("Woman: CPUSkinSIMD, sorted by influence count", sortedSIMD, reference);
+	std::vector<DualQuaternion> dualQuaternionPalette;
+	std::vector<Transform> globals;
+	double dualQuaternion = BenchmarkHelpers::Time(iterations, [&]() {
+		mSkeleton.GetDualQuaternionSkinPalette(pose, dualQuaternionPalette, globals);
+		for (unsigned int i = 0; i < numMeshes; ++i) {
+			sorted[i].CPUSkin(dualQuaternionPalette);
+		}
+	});
+	AddResult("Woman: CPUSkin, dual quaternion", dualQuaternion, dualQuaternion);
+	double dualQuaternionSIMD = BenchmarkHelpers::Time(iterations, [&]() {
+		mSkeleton.GetDualQuaternionSkinPalette(pose, dualQuaternionPalette, globals);
+		for (unsigned int i = 0; i < numMeshes; ++i) {
+			sorted[i].CPUSkinSIMD(dualQuaternionPalette);
+		}
+	});
+	AddResult("Woman: CPUSkinSIMD, dual quaternion", dualQuaternionSIMD, dualQuaternion);
+
+	// Compact vertices decode as they skin, the SIMD streams are decoded once
+	std::vector<Mesh> compact = sorted;
+	unsigned int floatBytes = 0;
+	unsigned int compactBytes = 0;
+	for (unsigned int i = 0; i < numMeshes; ++i) {
+		compact[i].SetCompact(true);
+		unsigned int numVerts = (unsigned int)compact[i].GetPosition().size();
+		floatBytes += numVerts * (sizeof(vec3) * 2 + sizeof(vec2) + sizeof(vec4) + sizeof(ivec4));
+		compactBytes += (unsigned int)(compact[i].GetCompactVertices().size() * sizeof(CompactVertex));
+	}
+	double compactScalar = BenchmarkHelpers::Time(iterations, [&]() {
+		mSkeleton.GetSkinPalette(pose, skinPalette);
+		for (unsigned int i = 0; i < numMeshes; ++i) {
+			compact[i].CPUSkin(skinPalette);
+		}
+	});
+	AddResult("Woman: CPUSkin, compact vertices", compactScalar, reference);
+	double compactSIMD = BenchmarkHelpers::Time(iterations, [&]() {
+		mSkeleton.GetSkinPalette(pose, skinPalette);
+		for (unsigned int i = 0; i < numMeshes; ++i) {
+			compact[i].CPUSkinSIMD(skinPalette);
+		}
+	});
+	AddResult("Woman: CPUSkinSIMD, compact vertices", compactSIMD, reference);
+
+	float compactError = 0.0f;
+	for (unsigned int i = 0; i < numMeshes; ++i) {
+		sorted[i].CPUSkin(skinPalette);
+		compact[i].CPUSkin(skinPalette);
+		std::vector<vec3>& expected = sorted[i].GetSkinnedPosition();
+		std::vector<vec3>& actual = compact[i].GetSkinnedPosition();
+		for (unsigned int v = 0, size = (unsigned int)expected.size(); v < size; ++v) {
+			float error = sqrtf(lenSq(expected[v] - actual[v]));
+			compactError = error > compactError ? error : compactError;
+		}
+	}
+	el::trace("Compact vertices: %u bytes instead of %u, skinned position error %g\n", compactBytes, floatBytes, compactError);
+
+	for (unsigned int n = 1; n <= 4; ++n) {
+		unsigned int numVerts = 0;
+		for (unsigned int i = 0; i < numMeshes; ++i) {
+			numVerts += sorted[i].GetInfluenceVertexCount(n);
+		}
+		el::trace("SortByInfluenceCount: %u vertices with %u influence%s\n", numVerts, n, n == 1 ? "" : "s");
+	}
+
+	// The scalar kernel is the reference, both should agree to a few float ulps
+	float positionError = 0.0f;
+	float normalError = 0.0f;
+	for (unsigned int i = 0; i < numMeshes; ++i) {
+		mMeshes[i].CPUSkin(skinPalette);
+		std::vector<vec3> positions = mMeshes[i].GetSkinnedPosition();
+		std::vector<vec3> normals = mMeshes[i].GetSkinnedNormal();
+		mMeshes[i].CPUSkinSIMD(skinPalette);
+		for (unsigned int v = 0, size = (unsigned int)positions.size(); v < size; ++v) {
+			vec3 position = positions[v];
+			float scale = lenSq(position) > 1.0f ? sqrtf(lenSq(position)) : 1.0f;
+			float error = sqrtf(lenSq(position - mMeshes[i].GetSkinnedPosition()[v])) / scale;
+			positionError = error > positionError ? error : positionError;
+			error = sqrtf(lenSq(normals[v] - mMeshes[i].GetSkinnedNormal()[v]));
+			normalError = error > normalError ? error : normalError;
+		}
+	}
+	el::trace("CPUSkinSIMD vs CPUSkin: relative position error %g, normal error %g%s\n", positionError, normalError,
+		positionError < 1e-5f && normalError < 1e-5f ? "" : " (FAILED)");
+
+	// Thread scaling, a crowd of separate meshes and one dense mesh
+	std::vector<Mesh> crowd;
+	for (unsigned int i = 0; i < 16; ++i) {
+		crowd.insert(crowd.end(), mMeshes.begin(), mMeshes.end());
+	}
+	std::vector<Mesh> dense(1);
+	BenchmarkHelpers::MergeMeshes(dense[0], mMeshes, 20);
+	dense[0].UpdateOpenGLBuffers();
+
+	unsigned int numCores = std::thread::hardware_concurrency();
+	unsigned int maxThreads = numCores > 4 ? numCores : 4;
+	std::vector<Mesh>* batches[] = { &crowd, &dense };
+	const char* batchNames[] = { "16 characters", "dense mesh" };
+	for (unsigned int b = 0; b < 2; ++b) {
+		std::vector<Mesh>& meshes = *batches[b];
+		unsigned int numVerts = 0;
+		for (unsigned int i = 0, size = (unsigned int)meshes.size(); i < size; ++i) {
+			numVerts += (unsigned int)meshes[i].GetPosition().size();
+		}
+		double single = 0.0;
+		for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+			WorkerPool pool;
+			pool.Start(threads - 1);
+			double time = BenchmarkHelpers::Time(20, [&]() {
+				CPUSkinParallel(meshes, skinPalette, pool);
+			});
+			single = threads == 1 ? time : single;
+			char name[128];
+			sprintf(name, "%s (%u verts): CPUSkinParallel, %u thread%s", batchNames[b], numVerts, threads, threads == 1 ? "" : "s");
+			AddResult(name, time, single);
+		}
+	}
+	el::trace("CPUSkinParallel: %u hardware threads\n", numCores);
+}
+
+void BenchmarkSample::RunLoading() {
+	const unsigned int iterations = 5;
+	cgltf_data* gltf = LoadGLTFFile("Assets/Woman.gltf");
+	if (gltf == 0) {
+		return;
+	}
+
+	double reference = BenchmarkHelpers::Time(iterations, [&]() {
+		std::vector<Mesh> meshes = LoadMeshes(gltf);
+		Skeleton skeleton = LoadSkeleton(gltf);
+		std::vector<Clip> clips = LoadAnimationClips(gltf);
+	});
+	AddResult("Woman.gltf import: LoadMeshes, LoadSkeleton, LoadAnimationClips", reference, reference);
+
+	unsigned int numCores = std::thread::hardware_concurrency();
+	unsigned int maxThreads = numCores > 4 ? numCores : 4;
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+		WorkerPool pool;
+		pool.Start(threads - 1);
+		double time = BenchmarkHelpers::Time(iterations, [&]() {
+			std::vector<Mesh> meshes;
+			Skeleton skeleton;
+			std::vector<Clip> clips;
+			LoadGLTFParallel(gltf, meshes, skeleton, clips, pool);
+			UploadMeshes(meshes);
+		});
+		char name[128];
+		sprintf(name, "Woman.gltf import: LoadGLTFParallel, %u thread%s", threads, threads == 1 ? "" : "s");
+		AddResult(name, time, reference);
+	}
+	FreeGLTFFile(gltf);
+}
@@ -0,0 +1,45 @@
+#ifndef _H_BENCHMARKSAMPLE_
+#define _H_BENCHMARKSAMPLE_
+
+#include "Application.h"
+#include <vector>
+#include <string>
+#include "Pose.h"
+#include "Clip.h"
+#include "Skeleton.h"
+#include "Mesh.h"
+
+struct BenchmarkResult {
+	std::string mName;
+	double mMicroseconds;
+	double mSpeedup; // Relative to the first result of its group
+
+	inline BenchmarkResult(const std::string& name, double us, double speedup) :
+		mName(name), mMicroseconds(us), mSpeedup(speedup) { }
+};
+
+// Times the optimized animation paths against the reference ones on Woman.gltf.
+// Results are printed through el::trace and listed in the ImGui window.
+class BenchmarkSample : public Application {
+protected:
+	Skeleton mSkeleton;
+	std::vector<Clip> mClips;
+	std::vector<Mesh> mMeshes;
+	std::vector<BenchmarkResult> mResults;
+protected:
+	Clip* FindClip(const std::string& name);
+	void AddResult(const std::string& name, double us, double reference);
+	void RunClipSampling();
+	void RunCubicSampling();
+	void RunPaletteBuilding();
+	void RunPoseBlending();
+	void RunSkinning();
+	void RunLoading();
+	void Run();
+public:
+	void Initialize();
+	void Shutdown();
+	void ImGui(nk_context* inContext);
+};
+
+#endif
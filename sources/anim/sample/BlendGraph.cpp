@@ -0,0 +1,247 @@
+#include "BlendGraph.h"
+#include <cstring>
+
+namespace BlendGraphHelpers {
+	// Same skeleton, so the component arrays line up and the parents already match
+	inline void CopyComponents(SoAPose& out, SoAPose& source) {
+		memcpy(out.GetComponent(0), source.GetComponent(0),
+			sizeof(float) * source.PaddedSize() * SoAPose::NumComponents);
+	}
+} // End BlendGraphHelpers namespace
+
+SoAPosePool::SoAPosePool() { }
+
+SoAPosePool::SoAPosePool(const SoAPosePool& other) {
+	*this = other;
+}
+
+SoAPosePool& SoAPosePool::operator=(const SoAPosePool& other) {
+	if (&other == this) {
+		return *this;
+	}
+	mPoses = other.mPoses;
+	mFree.clear();
+	mFree.reserve(mPoses.size()); // Release never reallocates
+	for (unsigned int i = 0, size = (unsigned int)other.mFree.size(); i < size; ++i) {
+		mFree.push_back(&mPoses[0] + (other.mFree[i] - &other.mPoses[0]));
+	}
+	return *this;
+}
+
+void SoAPosePool::Initialize(Pose& restPose, unsigned int count) {
+	mPoses.resize(count);
+	mFree.resize(count);
+	for (unsigned int i = 0; i < count; ++i) {
+		mPoses[i].FromPose(restPose);
+		mFree[i] = &mPoses[count - 1 - i];
+	}
+}
+
+SoAPose* SoAPosePool::Acquire() {
+	if (mFree.size() == 0) {
+		return 0;
+	}
+	SoAPose* result = mFree.back();
+	mFree.pop_back();
+	return result;
+}
+
+void SoAPosePool::Release(SoAPose* pose) {
+	if (pose != 0) {
+		mFree.push_back(pose); // Never grows past the capacity reserved in Initialize
+	}
+}
+
+unsigned int SoAPosePool::Size() {
+	return (unsigned int)mPoses.size();
+}
+
+unsigned int SoAPosePool::NumFree() {
+	return (unsigned int)mFree.size();
+}
+
+BlendGraph::BlendGraph() {
+	mRoot = -1;
+}
+
+void BlendGraph::Initialize(Pose& restPose, unsigned int poolSize) {
+	mNodes.clear();
+	mMasks.clear();
+	mReferences.clear();
+	mRestPose.FromPose(restPose);
+	Pose delta;
+	MakeDeltaPose(delta, restPose);
+	mDeltaPose.FromPose(delta);
+	mPool.Initialize(restPose, poolSize);
+	mRoot = -1;
+}
+
+unsigned int BlendGraph::AddNode(BlendNodeType type, int input0, int input1, float weight) {
+	BlendNode node;
+	node.mType = type;
+	node.mClip = 0;
+	node.mTime = 0.0f;
+	node.mWeight = weight;
+	node.mInputs[0] = input0;
+	node.mInputs[1] = input1;
+	node.mMask = -1;
+	node.mReference = -1;
+	mNodes.push_back(node);
+	mRoot = (int)mNodes.size() - 1;
+	return (unsigned int)mRoot;
+}
+
+unsigned int BlendGraph::AddClip(SoAClip* clip, float time) {
+	unsigned int index = AddNode(BlendNodeType::Clip, -1, -1, 1.0f);
+	mNodes[index].mClip = clip;
+	mNodes[index].mTime = time;
+	return index;
+}
+
+unsigned int BlendGraph::AddDeltaClip(SoAClip* clip, float time) {
+	unsigned int index = AddClip(clip, time);
+	mNodes[index].mReference = -2;
+	return index;
+}
+
+unsigned int BlendGraph::AddCrossfade(unsigned int from, unsigned int to, float t) {
+	return AddNode(BlendNodeType::Crossfade, (int)from, (int)to, t);
+}
+
+unsigned int BlendGraph::AddAdditive(unsigned int base, unsigned int additive, Pose& reference, float weight) {
+	mReferences.push_back(SoAPose());
+	mReferences.back().FromPose(reference);
+	unsigned int index = AddNode(BlendNodeType::Additive, (int)base, (int)additive, weight);
+	mNodes[index].mReference = (int)mReferences.size() - 1;
+	return index;
+}
+
+unsigned int BlendGraph::AddAdditive(unsigned int base, unsigned int delta, float weight) {
+	return AddNode(BlendNodeType::Additive, (int)base, (int)delta, weight);
+}
+
+unsigned int BlendGraph::AddLayer(unsigned int base, unsigned int layer, const std::vector<float>& mask, float weight) {
+	// Stored padded, so the masked blend never has to pad it per frame
+	std::vector<float> padded(mRestPose.PaddedSize(), 0.0f);
+	for (unsigned int i = 0, size = (unsigned int)mask.size(); i < size && i < padded.size(); ++i) {
+		padded[i] = mask[i];
+	}
+	mMasks.push_back(padded);
+	unsigned int index = AddNode(BlendNodeType::Layer, (int)base, (int)layer, weight);
+	mNodes[index].mMask = (int)mMasks.size() - 1;
+	return index;
+}
+
+unsigned int BlendGraph::Size() {
+	return (unsigned int)mNodes.size();
+}
+
+BlendNode& BlendGraph::GetNode(unsigned int index) {
+	return mNodes[index];
+}
+
+void BlendGraph::SetWeight(unsigned int index, float weight) {
+	mNodes[index].mWeight = weight;
+}
+
+void BlendGraph::SetTime(unsigned int index, float time) {
+	mNodes[index].mTime = time;
+}
+
+int BlendGraph::GetRoot() {
+	return mRoot;
+}
+
+void BlendGraph::SetRoot(unsigned int index) {
+	mRoot = (int)index;
+}
+
+void BlendGraph::Update(float deltaTime) {
+	for (unsigned int i = 0, size = (unsigned int)mNodes.size(); i < size; ++i) {
+		if (mNodes[i].mType == BlendNodeType::Clip) {
+			mNodes[i].mTime += deltaTime;
+		}
+	}
+}
+
+SoAPose* BlendGraph::EvaluateNode(int index) {
+	BlendNode& node = mNodes[index];
+	if (node.mType == BlendNodeType::Clip) {
+		SoAPose* result = mPool.Acquire();
+		if (result != 0) {
+			BlendGraphHelpers::CopyComponents(*result, node.mReference == -2 ? mDeltaPose : mRestPose);
+			if (node.mClip != 0) {
+				node.mTime = node.mClip->Sample(*result, node.mTime);
+			}
+		}
+		return result;
+	}
+
+	// Weights at either end only need one input
+	float weight = node.mWeight;
+	if (weight <= 0.0f) {
+		return EvaluateNode(node.mInputs[0]);
+	}
+	if (weight >= 1.0f && node.mType == BlendNodeType::Crossfade) {
+		return EvaluateNode(node.mInputs[1]);
+	}
+
+	SoAPose* a = EvaluateNode(node.mInputs[0]);
+	if (a == 0) {
+		return 0;
+	}
+	SoAPose* b = EvaluateNode(node.mInputs[1]);
+	if (b == 0) {
+		mPool.Release(a);
+		return 0;
+	}
+
+	if (node.mType == BlendNodeType::Crossfade) {
+		Blend(*a, *a, *b, weight);
+	}
+	else if (node.mType == BlendNodeType::Additive) {
+		if (node.mReference >= 0) {
+			Add(*a, *a, *b, mReferences[node.mReference], weight);
+		}
+		else {
+			AddDelta(*a, *a, *b, weight);
+		}
+	}
+	else {
+		Blend(*a, *a, *b, weight, mMasks[node.mMask]);
+	}
+	mPool.Release(b);
+	return a;
+}
+
+bool BlendGraph::Evaluate(SoAPose& outPose) {
+	if (mRoot < 0) {
+		return false;
+	}
+	SoAPose* result = EvaluateNode(mRoot);
+	if (result == 0) {
+		return false;
+	}
+	if (outPose.Size() != result->Size()) {
+		outPose.Resize(result->Size());
+		for (unsigned int i = 0, size = result->Size(); i < size; ++i) {
+			outPose.SetParent(i, result->GetParent(i));
+		}
+	}
+	BlendGraphHelpers::CopyComponents(outPose, *result);
+	mPool.Release(result);
+	return true;
+}
+
+bool BlendGraph::Evaluate(Pose& outPose) {
+	if (mRoot < 0) {
+		return false;
+	}
+	SoAPose* result = EvaluateNode(mRoot);
+	if (result == 0) {
+		return false;
+	}
+	result->ToPose(outPose);
+	mPool.Release(result);
+	return true;
+}
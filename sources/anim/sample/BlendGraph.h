@@ -0,0 +1,93 @@
+#ifndef _H_BLENDGRAPH_
+#define _H_BLENDGRAPH_
+
+#include <vector>
+#include "Pose.h"
+#include "SoAPose.h"
+#include "SoAClip.h"
+
+// Poses for one skeleton, allocated up front. Acquire and Release only move pointers
+// on a free list, so evaluating a graph out of the pool never touches the heap.
+class SoAPosePool {
+protected:
+	std::vector<SoAPose> mPoses;
+	std::vector<SoAPose*> mFree;
+public:
+	SoAPosePool();
+	// Copies the poses and which of them are free, the free list points into the copy
+	SoAPosePool(const SoAPosePool& other);
+	SoAPosePool& operator=(const SoAPosePool& other);
+	void Initialize(Pose& restPose, unsigned int count);
+	// 0 when every pose is in use
+	SoAPose* Acquire();
+	void Release(SoAPose* pose);
+	unsigned int Size();
+	unsigned int NumFree();
+};
+
+enum class BlendNodeType {
+	Clip,      // Samples mClip at mTime on top of the rest pose, or of identity deltas
+	           // if mReference is -2 (an additive clip)
+	Crossfade, // Blends input 0 into input 1 by mWeight
+	Additive,  // Adds input 1 minus mReference onto input 0, scaled by mWeight. Without a
+	           // reference input 1 is already a delta
+	Layer      // Blends input 1 over input 0 by mWeight times the joint mask
+};
+
+struct BlendNode {
+	BlendNodeType mType;
+	SoAClip* mClip;
+	float mTime;
+	float mWeight;
+	int mInputs[2];
+	int mMask;      // Layer nodes, index into the graph's masks
+	int mReference; // Additive nodes, index into the graph's reference poses or -1
+};
+
+// A tree of clip, crossfade, additive and masked layer nodes evaluated with the SoA
+// blend operations. Nodes live in one array and refer to each other by index, every
+// intermediate pose comes from the pool. Once built, Update and Evaluate do not
+// allocate. The pool needs one pose per level of the deepest branch, plus one.
+class BlendGraph {
+protected:
+	std::vector<BlendNode> mNodes;
+	std::vector<std::vector<float> > mMasks;
+	std::vector<SoAPose> mReferences;
+	SoAPose mRestPose;
+	SoAPose mDeltaPose;
+	SoAPosePool mPool;
+	int mRoot;
+protected:
+	unsigned int AddNode(BlendNodeType type, int input0, int input1, float weight);
+	SoAPose* EvaluateNode(int index);
+public:
+	BlendGraph();
+	void Initialize(Pose& restPose, unsigned int poolSize = 8);
+
+	// Each Add returns the index of the new node, the last one added becomes the root
+	unsigned int AddClip(SoAClip* clip, float time = 0.0f);
+	// clip was made with MakeAdditiveClip, combine it with the AddAdditive below
+	unsigned int AddDeltaClip(SoAClip* clip, float time = 0.0f);
+	unsigned int AddCrossfade(unsigned int from, unsigned int to, float t);
+	// reference is the pose the additive input is relative to, usually its first frame
+	unsigned int AddAdditive(unsigned int base, unsigned int additive, Pose& reference, float weight);
+	// delta is a delta clip node, nothing is subtracted at runtime
+	unsigned int AddAdditive(unsigned int base, unsigned int delta, float weight);
+	// mask comes from MakeJointMask on a pose of the same skeleton
+	unsigned int AddLayer(unsigned int base, unsigned int layer, const std::vector<float>& mask, float weight);
+
+	unsigned int Size();
+	BlendNode& GetNode(unsigned int index);
+	void SetWeight(unsigned int index, float weight);
+	void SetTime(unsigned int index, float time);
+	int GetRoot();
+	void SetRoot(unsigned int index);
+
+	// Advances every clip node, looping clips wrap
+	void Update(float deltaTime);
+	// False if the graph is empty or the pool ran out of poses
+	bool Evaluate(SoAPose& outPose);
+	bool Evaluate(Pose& outPose);
+};
+
+#endif
@@ -0,0 +1,201 @@
+#include "BoundClip.h"
+#include <algorithm>
+#include <cmath>
+
+namespace BoundClipHelpers {
+	inline bool Has(unsigned int channels, BoundChannel channel) {
+		return (channels & (unsigned int)channel) != 0;
+	}
+
+	// Animated tracks interpolate, single key tracks hold their value
+	template<typename T, int N>
+	inline T Sample(Track<T, N>& track, float time, bool looping) {
+		return track.Size() > 1 ? track.Sample(time, looping) : track.GetValue(0);
+	}
+
+	template<typename T, int N>
+	inline T Sample(Track<T, N>& track, float time, bool looping, TrackCursor& cursor) {
+		return track.Size() > 1 ? track.Sample(time, looping, cursor) : track.GetValue(0);
+	}
+} // End BoundClipHelpers namespace
+
+BoundClip::BoundClip() {
+	mName = "No name given";
+	mStartTime = 0.0f;
+	mEndTime = 0.0f;
+	mLooping = true;
+}
+
+void BoundClip::Bind(Clip& clip, Skeleton& skeleton) {
+	mName = clip.GetName();
+	mLooping = clip.GetLooping();
+	mStartTime = clip.GetStartTime();
+	mEndTime = clip.GetEndTime();
+
+	unsigned int numJoints = skeleton.GetRestPose().Size();
+	mTrackIndex.assign(numJoints, -1);
+	mTracks.clear();
+	mJoints.clear();
+	mChannels.clear();
+
+	// Joint order keeps the writes walking forward through the pose
+	std::vector<unsigned int> joints;
+	for (unsigned int i = 0, size = clip.Size(); i < size; ++i) {
+		unsigned int joint = clip.GetIdAtIndex(i);
+		if (joint < numJoints) {
+			joints.push_back(joint);
+		}
+	}
+	std::sort(joints.begin(), joints.end());
+	joints.erase(std::unique(joints.begin(), joints.end()), joints.end());
+
+	for (unsigned int i = 0, size = (unsigned int)joints.size(); i < size; ++i) {
+		unsigned int joint = joints[i];
+		TransformTrack& track = clip[joint];
+		unsigned int channels = 0;
+		if (track.GetPositionTrack().Size() > 0) {
+			channels |= (unsigned int)BoundChannel::Position;
+		}
+		if (track.GetRotationTrack().Size() > 0) {
+			channels |= (unsigned int)BoundChannel::Rotation;
+		}
+		if (track.GetScaleTrack().Size() > 0) {
+			channels |= (unsigned int)BoundChannel::Scale;
+		}
+		if (channels == 0) {
+			continue;
+		}
+		mTrackIndex[joint] = (int)mTracks.size();
+		mTracks.push_back(track);
+		mJoints.push_back(joint);
+		mChannels.push_back(channels);
+	}
+}
+
+float BoundClip::Sample(Pose& outPose, float time) {
+	if (GetDuration() == 0.0f) {
+		return 0.0f;
+	}
+	time = AdjustTimeToFitRange(time);
+
+	Transform* locals = outPose.GetLocalTransforms();
+	for (unsigned int i = 0, size = (unsigned int)mTracks.size(); i < size; ++i) {
+		TransformTrack& track = mTracks[i];
+		Transform& local = locals[mJoints[i]];
+		unsigned int channels = mChannels[i];
+		if (BoundClipHelpers::Has(channels, BoundChannel::Position)) {
+			local.position = BoundClipHelpers::Sample(track.GetPositionTrack(), time, mLooping);
+		}
+		if (BoundClipHelpers::Has(channels, BoundChannel::Rotation)) {
+			local.rotation = BoundClipHelpers::Sample(track.GetRotationTrack(), time, mLooping);
+		}
+		if (BoundClipHelpers::Has(channels, BoundChannel::Scale)) {
+			local.scale = BoundClipHelpers::Sample(track.GetScaleTrack(), time, mLooping);
+		}
+	}
+	return time;
+}
+
+float BoundClip::Sample(Pose& outPose, float time, ClipCursor& cursor) {
+	if (GetDuration() == 0.0f) {
+		return 0.0f;
+	}
+	time = AdjustTimeToFitRange(time);
+
+	unsigned int size = (unsigned int)mTracks.size();
+	if (cursor.mTracks.size() != size) {
+		cursor.mTracks.resize(size);
+	}
+	Transform* locals = outPose.GetLocalTransforms();
+	for (unsigned int i = 0; i < size; ++i) {
+		TransformTrack& track = mTracks[i];
+		TransformTrackCursor& trackCursor = cursor.mTracks[i];
+		Transform& local = locals[mJoints[i]];
+		unsigned int channels = mChannels[i];
+		if (BoundClipHelpers::Has(channels, BoundChannel::Position)) {
+			local.position = BoundClipHelpers::Sample(track.GetPositionTrack(), time, mLooping, trackCursor.mPosition);
+		}
+		if (BoundClipHelpers::Has(channels, BoundChannel::Rotation)) {
+			local.rotation = BoundClipHelpers::Sample(track.GetRotationTrack(), time, mLooping, trackCursor.mRotation);
+		}
+		if (BoundClipHelpers::Has(channels, BoundChannel::Scale)) {
+			local.scale = BoundClipHelpers::Sample(track.GetScaleTrack(), time, mLooping, trackCursor.mScale);
+		}
+	}
+	return time;
+}
+
+float BoundClip::AdjustTimeToFitRange(float inTime) {
+	if (mLooping) {
+		float duration = mEndTime - mStartTime;
+		if (duration <= 0) {
+			return 0.0f;
+		}
+		inTime = fmodf(inTime - mStartTime, mEndTime - mStartTime);
+		if (inTime < 0.0f) {
+			inTime += mEndTime - mStartTime;
+		}
+		inTime = inTime + mStartTime;
+	}
+	else {
+		if (inTime < mStartTime) {
+			inTime = mStartTime;
+		}
+		if (inTime > mEndTime) {
+			inTime = mEndTime;
+		}
+	}
+	return inTime;
+}
+
+unsigned int BoundClip::Size() {
+	return (unsigned int)mTracks.size();
+}
+
+unsigned int BoundClip::GetNumJoints() {
+	return (unsigned int)mTrackIndex.size();
+}
+
+TransformTrack* BoundClip::GetTrack(unsigned int joint) {
+	if (joint >= mTrackIndex.size() || mTrackIndex[joint] < 0) {
+		return 0;
+	}
+	return &mTracks[mTrackIndex[joint]];
+}
+
+unsigned int BoundClip::GetChannels(unsigned int joint) {
+	if (joint >= mTrackIndex.size() || mTrackIndex[joint] < 0) {
+		return 0;
+	}
+	return mChannels[mTrackIndex[joint]];
+}
+
+std::string& BoundClip::GetName() {
+	return mName;
+}
+
+float BoundClip::GetDuration() {
+	return mEndTime - mStartTime;
+}
+
+float BoundClip::GetStartTime() {
+	return mStartTime;
+}
+
+float BoundClip::GetEndTime() {
+	return mEndTime;
+}
+
+bool BoundClip::GetLooping() {
+	return mLooping;
+}
+
+void BoundClip::SetLooping(bool inLooping) {
+	mLooping = inLooping;
+}
+
+BoundClip BindClip(Clip& clip, Skeleton& skeleton) {
+	BoundClip result;
+	result.Bind(clip, skeleton);
+	return result;
+}
@@ -0,0 +1,52 @@
+#ifndef _H_BOUNDCLIP_
+#define _H_BOUNDCLIP_
+
+#include <vector>
+#include <string>
+#include "Clip.h"
+#include "Skeleton.h"
+
+// Which channels of a bound track are written by Sample
+enum class BoundChannel {
+	Position = 1,
+	Rotation = 2,
+	Scale = 4
+};
+
+// A clip bound to one skeleton. Tracks are sorted by joint, a dense table maps every
+// joint of the skeleton to its track, and each track records which of its channels are
+// animated. Sample writes only those channels, straight into the pose's local transforms.
+class BoundClip {
+protected:
+	std::vector<TransformTrack> mTracks;
+	std::vector<unsigned int> mJoints;      // Joint of every track
+	std::vector<unsigned int> mChannels;    // BoundChannel bits of every track
+	std::vector<int> mTrackIndex;           // Track of every joint, -1 if not animated
+	std::string mName;
+	float mStartTime;
+	float mEndTime;
+	bool mLooping;
+protected:
+	float AdjustTimeToFitRange(float inTime);
+public:
+	BoundClip();
+	// Tracks for joints the skeleton does not have are dropped
+	void Bind(Clip& clip, Skeleton& skeleton);
+	float Sample(Pose& outPose, float inTime);
+	float Sample(Pose& outPose, float inTime, ClipCursor& cursor);
+	unsigned int Size();
+	unsigned int GetNumJoints();
+	// The track animating joint, or 0 if the clip leaves it alone
+	TransformTrack* GetTrack(unsigned int joint);
+	unsigned int GetChannels(unsigned int joint);
+	std::string& GetName();
+	float GetDuration();
+	float GetStartTime();
+	float GetEndTime();
+	bool GetLooping();
+	void SetLooping(bool inLooping);
+};
+
+BoundClip BindClip(Clip& clip, Skeleton& skeleton);
+
+#endif
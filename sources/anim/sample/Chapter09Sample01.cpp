@@ -10,10 +10,12 @@
 void Chapter09Sample01::Initialize()
 {
 	cgltf_data* gltf = LoadGLTFFile("Assets/Woman.gltf");
-	mMeshes = LoadMeshes(gltf);
-	mSkeleton = LoadSkeleton(gltf);
-	mClips = LoadAnimationClips(gltf);
+	WorkerPool pool;
+	unsigned int numCores = std::thread::hardware_concurrency();
+	pool.Start(numCores > 1 ? numCores - 1 : 0);
+	LoadGLTFParallel(gltf, mMeshes, mSkeleton, mClips, pool);
 	FreeGLTFFile(gltf);
+	UploadMeshes(mMeshes);
 
 	mStaticShader = new Shader("Shaders/static.vert", "Shaders/lit.frag");
 	mSkinnedShader = new Shader("Shaders/skinned.vert", "Shaders/lit.frag");
@@ -89,12 +91,13 @@ void Chapter09Sample01::Update(float deltaTime)
 	mPlaybackTime = mClips[mCurrentClip].Sample(mCurrentPose, mPlaybackTime + deltaTime);
 	mCurrentPoseVisual->FromPose(mCurrentPose);
 	if (mSkinType == SkinningType::CPU) {
+		mSkeleton.GetSkinPalette(mCurrentPose, mSkinPalette);
 		for (unsigned int i = 0, size = (unsigned int)mMeshes.size(); i < size; ++i) {
-			mMeshes[i].CPUSkin(mSkeleton, mCurrentPose);
+			mMeshes[i].CPUSkinSIMD(mSkinPalette);
 		}
 	}
 	else if (mSkinType == SkinningType::GPU) {
-		mCurrentPose.GetMatrixPalette(mPosePalette);
+		mCurrentPose.GetMatrixPalette(mPosePalette, mSkeleton.GetJointOrder());
 	}
 }
 
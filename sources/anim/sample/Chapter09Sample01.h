@@ -19,6 +19,7 @@ protected:
 	Shader* mSkinnedShader;
 	std::vector<Mesh> mMeshes;
 	std::vector<mat4> mPosePalette;
+	std::vector<mat4> mSkinPalette; // Shared by every mesh in CPU skinning
 	Skeleton mSkeleton;
 	Pose mCurrentPose;
 	std::vector<Clip> mClips;
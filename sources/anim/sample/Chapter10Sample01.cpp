@@ -4,19 +4,38 @@
 #include <imgui.h>
 
 #include "GLTFLoader.h"
+#include "MeshOptimizer.h"
 #include "Uniform.h"
 #include "mat4.h"
 
 void Chapter10Sample01::Initialize()
 {
+    // The skinning threads decode the file first. SetCompact uploads the meshes below
+    unsigned int numCores = std::thread::hardware_concurrency();
+    mSkinningPool.Start(numCores > 1 ? numCores - 1 : 0);
     cgltf_data* gltf = LoadGLTFFile("Assets/Woman.gltf");
-    mMeshes = LoadMeshes(gltf);
-    mSkeleton = LoadSkeleton(gltf);
-    mClips = LoadAnimationClips(gltf);
+    LoadGLTFParallel(gltf, mMeshes, mSkeleton, mClips, mSkinningPool);
     FreeGLTFFile(gltf);
+    for (unsigned int i = 0, size = (unsigned int)mClips.size(); i < size; ++i) {
+        mClips[i] = ReduceClip(mClips[i]);
+    }
+    // Rigid vertices skin with one matrix, on the CPU and with skinned1.vert. Each mesh
+    // is drawn once per influence group, so bind it through one cached vertex array of
+    // compact vertices, and write CPU skinned vertices straight into mapped buffers
+    for (unsigned int i = 0, size = (unsigned int)mMeshes.size(); i < size; ++i) {
+        mMeshes[i].SortByInfluenceCount();
+        OptimizeVertexCache(mMeshes[i]); // Sorting keeps the loaded order only inside each group
+        mMeshes[i].SetStreamingSkin(true);
+        if (!mMeshes[i].SetCompact(true)) {
+            mMeshes[i].SetInterleaved(true);
+        }
+    }
 
     mStaticShader = new Shader("Shaders/static.vert", "Shaders/lit.frag");
-    mSkinnedShader = new Shader("Shaders/skinned.vert", "Shaders/lit.frag");
+    mSkinnedShaders[0] = new Shader("Shaders/skinned1.vert", "Shaders/lit.frag");
+    mSkinnedShaders[1] = new Shader("Shaders/skinned2.vert", "Shaders/lit.frag");
+    mSkinnedShaders[2] = new Shader("Shaders/skinned3.vert", "Shaders/lit.frag");
+    mSkinnedShaders[3] = new Shader("Shaders/skinned.vert", "Shaders/lit.frag");
     mDiffuseTexture = new Texture("Assets/Woman.png");
 
     mRestPoseVisual = new DebugDraw();
@@ -29,6 +48,8 @@ void Chapter10Sample01::Initialize()
 
     mCurrentClip = 0;
     mCurrentPose = mSkeleton.GetRestPose();
+    // The debug lines and the palette share the same globals every frame
+    mCurrentPose.EnableGlobalCache(true);
 
     mCurrentPoseVisual = new DebugDraw();
     mCurrentPoseVisual->FromPose(mCurrentPose);
@@ -86,15 +107,14 @@ void Chapter10Sample01::Update(float deltaTime)
 {
     if (mCurrentClip >= mClips.size())
         return;
-    mPlaybackTime = mClips[mCurrentClip].Sample(mCurrentPose, mPlaybackTime + deltaTime);
+    mPlaybackTime = mClips[mCurrentClip].Sample(mCurrentPose, mPlaybackTime + deltaTime, mClipCursor);
     mCurrentPoseVisual->FromPose(mCurrentPose);
     if (mSkinType == SkinningType::CPU) {
-        for (unsigned int i = 0, size = (unsigned int)mMeshes.size(); i < size; ++i) {
-            mMeshes[i].CPUSkin(mSkeleton, mCurrentPose);
-        }
+        mSkeleton.GetSkinPalette(mCurrentPose, mSkinPalette);
+        CPUSkinParallel(mMeshes, mSkinPalette, mSkinningPool);
     }
     else if (mSkinType == SkinningType::GPU) {
-        mCurrentPose.GetMatrixPalette(mPosePalette);
+        mCurrentPose.GetMatrixPalette(mPosePalette, mSkeleton.GetJointOrder());
     }
 }
 
@@ -104,41 +124,47 @@ void Chapter10Sample01::Render(float inAspectRatio)
     mat4 view = lookAt(vec3(0, 5, 7), vec3(0, 3, 0), vec3(0, 1, 0));
     mat4 mvp = projection * view; // No model
 
-    Shader* shader = mStaticShader;
-    if (mSkinType == SkinningType::GPU) {
-        shader = mSkinnedShader;
-    }
+    // GPU skinning draws each influence group of the meshes with its own shader
+    unsigned int numPasses = mSkinType == SkinningType::GPU ? 4 : 1;
+    for (unsigned int pass = 0; pass < numPasses; ++pass) {
+        Shader* shader = mStaticShader;
+        if (mSkinType == SkinningType::GPU) {
+            shader = mSkinnedShaders[pass];
+        }
 
-    shader->Bind();
-    Uniform<mat4>::Set(shader->GetUniform("model"), mat4());
-    Uniform<mat4>::Set(shader->GetUniform("view"), view);
-    Uniform<mat4>::Set(shader->GetUniform("projection"), projection);
-    Uniform<vec3>::Set(shader->GetUniform("light"), vec3(1, 1, 1));
-    
-    // mPosePalette[0] = mat4();
-    // mPosePalette[3] = mat4();
-    // mPosePalette[2] = mat4();
+        shader->Bind();
+        Uniform<mat4>::Set(shader->GetUniform("model"), mat4());
+        Uniform<mat4>::Set(shader->GetUniform("view"), view);
+        Uniform<mat4>::Set(shader->GetUniform("projection"), projection);
+        Uniform<vec3>::Set(shader->GetUniform("light"), vec3(1, 1, 1));
 
-    if (mSkinType == SkinningType::GPU) {
-        Uniform<mat4>::Set(shader->GetUniform("pose"), mPosePalette);
-        Uniform<mat4>::Set(shader->GetUniform("invBindPose"), mSkeleton.GetInvBindPose());
-    }
-    
-    mDiffuseTexture->Set(shader->GetUniform("tex0"), 0);
-    for (unsigned int i = 0, size = (unsigned int)mMeshes.size(); i < size; ++i) {
-        int weights = -1;
-        int influences = -1;
         if (mSkinType == SkinningType::GPU) {
-            weights = shader->GetAttribute("weights");
-            influences = shader->GetAttribute("joints");
+            Uniform<mat4>::Set(shader->GetUniform("pose"), mPosePalette);
+            Uniform<mat4>::Set(shader->GetUniform("invBindPose"), mSkeleton.GetInvBindPose());
         }
 
-        mMeshes[i].Bind(shader->GetAttribute("position"), shader->GetAttribute("normal"), shader->GetAttribute("texCoord"), weights, influences);
-        mMeshes[i].Draw();
-        mMeshes[i].UnBind(shader->GetAttribute("position"), shader->GetAttribute("normal"), shader->GetAttribute("texCoord"), weights, influences);
+        mDiffuseTexture->Set(shader->GetUniform("tex0"), 0);
+        for (unsigned int i = 0, size = (unsigned int)mMeshes.size(); i < size; ++i) {
+            int weights = -1;
+            int influences = -1;
+            if (mSkinType == SkinningType::GPU) {
+                weights = pass > 0 ? shader->GetAttribute("weights") : -1; // skinned1.vert has no weights
+                influences = shader->GetAttribute("joints");
+            }
+
+            mMeshes[i].SetCompactUniforms(shader);
+            mMeshes[i].Bind(shader->GetAttribute("position"), shader->GetAttribute("normal"), shader->GetAttribute("texCoord"), weights, influences);
+            if (mSkinType == SkinningType::GPU) {
+                mMeshes[i].Draw(pass + 1);
+            }
+            else {
+                mMeshes[i].Draw();
+            }
+            mMeshes[i].UnBind(shader->GetAttribute("position"), shader->GetAttribute("normal"), shader->GetAttribute("texCoord"), weights, influences);
+        }
+        mDiffuseTexture->UnSet(0);
+        shader->UnBind();
     }
-    mDiffuseTexture->UnSet(0);
-    shader->UnBind();
 
     glDisable(GL_DEPTH_TEST);
     if (mShowRestPose) {
@@ -157,12 +183,15 @@ void Chapter10Sample01::Render(float inAspectRatio)
 }
 
 void Chapter10Sample01::Shutdown() {
+    mSkinningPool.Stop();
     delete mRestPoseVisual;
     delete mCurrentPoseVisual;
     delete mBindPoseVisual;
     delete mStaticShader;
     delete mDiffuseTexture;
-    delete mSkinnedShader;
+    for (unsigned int i = 0; i < 4; ++i) {
+        delete mSkinnedShaders[i];
+    }
     mClips.clear();
     mMeshes.clear();
 
@@ -183,6 +212,7 @@ void Chapter10Sample01::ImGui(nk_context* inContext)
     if ((unsigned int)selected != mCurrentClip) {
         mCurrentPose = mSkeleton.GetRestPose();
         mCurrentClip = (unsigned int)selected;
+        mClipCursor.Reset();
     }
 
     ImGui::Text("Playback:");
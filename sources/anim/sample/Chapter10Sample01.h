@@ -16,12 +16,15 @@ class Chapter10Sample01 : public Application {
 protected:
 	Texture* mDiffuseTexture;
 	Shader* mStaticShader;
-	Shader* mSkinnedShader;
+	Shader* mSkinnedShaders[4]; // For vertices with 1, 2, 3 and 4 influences
 	std::vector<Mesh> mMeshes;
 	std::vector<mat4> mPosePalette;
+	std::vector<mat4> mSkinPalette; // Shared by every mesh in CPU skinning
+	WorkerPool mSkinningPool; // CPU skinning threads besides the main one
 	Skeleton mSkeleton;
 	Pose mCurrentPose;
 	std::vector<Clip> mClips;
+	ClipCursor mClipCursor;
 	int mCurrentClip;
 	float mPlaybackTime;
 	DebugDraw* mBindPoseVisual;
@@ -1,21 +1,38 @@
 #include "Chapter10Sample02.h"
+#include <glad/glad.h>
+#include <imgui.h>
 #include "GLTFLoader.h"
 #include "Uniform.h"
 #include "mat4.h"
 
 void Chapter10Sample02::Initialize()
 {
+	// The meshes are only the source of the LOD chain, which uploads its own copies
 	cgltf_data* gltf = LoadGLTFFile("Assets/Woman.gltf");
-	mCPUMeshes = LoadMeshes(gltf);
-	mSkeleton = LoadSkeleton(gltf);
-	mClips = LoadAnimationClips(gltf);
+	std::vector<Mesh> meshes;
+	std::vector<Clip> clips;
+	WorkerPool pool;
+	unsigned int numCores = std::thread::hardware_concurrency();
+	pool.Start(numCores > 1 ? numCores - 1 : 0);
+	LoadGLTFParallel(gltf, meshes, mSkeleton, clips, pool);
 	FreeGLTFFile(gltf);
 
-	mGPUMeshes = mCPUMeshes;
-	for (unsigned int i = 0, size = (unsigned int)mGPUMeshes.size(); i < size; ++i) {
-		mGPUMeshes[i].UpdateOpenGLBuffers();
+	mClips.resize(clips.size());
+	for (unsigned int i = 0, size = (unsigned int)clips.size(); i < size; ++i) {
+		mClips[i] = OptimizeClip(clips[i]);
 	}
 
+	// Half, a quarter and a tenth of the triangles, switched to as the model gets
+	// smaller than 400, 200 and 100 pixels tall
+	std::vector<float> ratios = { 0.5f, 0.25f, 0.1f };
+	std::vector<float> screenSizes = { 400.0f, 200.0f, 100.0f };
+	BuildLODChain(mCPULODs, meshes, ratios, screenSizes);
+	mGPULODs = mCPULODs;
+	mCPULOD = 0;
+	mGPULOD = 0;
+	mBoundsRadius = GetBoundingRadius(meshes, mBoundsCenter);
+	mCameraDistance = len(vec3(0, 2, 7));
+
 	mStaticShader = new Shader("Shaders/static.vert", "Shaders/lit.frag");
 	mSkinnedShader = new Shader("Shaders/skinned.vert", "Shaders/lit.frag");
 	mDiffuseTexture = new Texture("Assets/Woman.png");
@@ -63,22 +80,44 @@ void Chapter10Sample02::Initialize()
 
 void Chapter10Sample02::Update(float deltaTime)
 {
-	mCPUAnimInfo.mPlayback = mClips[mCPUAnimInfo.mClip].Sample(mCPUAnimInfo.mAnimatedPose, mCPUAnimInfo.mPlayback + deltaTime);
-	mGPUAnimInfo.mPlayback = mClips[mGPUAnimInfo.mClip].Sample(mGPUAnimInfo.mAnimatedPose, mGPUAnimInfo.mPlayback + deltaTime);
+	mCPUAnimInfo.mPlayback = mClips[mCPUAnimInfo.mClip].Sample(mCPUAnimInfo.mAnimatedPose, mCPUAnimInfo.mPlayback + deltaTime, mCPUAnimInfo.mCursor);
+	mGPUAnimInfo.mPlayback = mClips[mGPUAnimInfo.mClip].Sample(mGPUAnimInfo.mAnimatedPose, mGPUAnimInfo.mPlayback + deltaTime, mGPUAnimInfo.mCursor);
 	
-	for (unsigned int i = 0, size = (unsigned int)mCPUMeshes.size(); i < size; ++i) {
-		mCPUMeshes[i].CPUSkin(mSkeleton, mCPUAnimInfo.mAnimatedPose);
+	mSkeleton.GetSkinPalette(mCPUAnimInfo.mAnimatedPose, mCPUAnimInfo.mSkinPalette);
+	std::vector<Mesh>& cpuMeshes = mCPULODs[mCPULOD].mMeshes;
+	for (unsigned int i = 0, size = (unsigned int)cpuMeshes.size(); i < size; ++i) {
+		cpuMeshes[i].CPUSkinSIMD(mCPUAnimInfo.mSkinPalette);
 	}
 
-	mGPUAnimInfo.mAnimatedPose.GetMatrixPalette(mGPUAnimInfo.mPosePalette);
+	mGPUAnimInfo.mAnimatedPose.GetMatrixPalette(mGPUAnimInfo.mPosePalette, mSkeleton.GetJointOrder());
 }
 
 void Chapter10Sample02::Render(float inAspectRatio)
 {
 	mat4 projection = perspective(60.0f, inAspectRatio, 0.01f, 1000.0f);
-	mat4 view = lookAt(vec3(0, 5, 7), vec3(0, 3, 0), vec3(0, 1, 0));
+	vec3 target(0, 3, 0);
+	vec3 eye = target + normalized(vec3(0, 2, 7)) * mCameraDistance;
+	mat4 view = lookAt(eye, target, vec3(0, 1, 0));
 	mat4 model;
 
+	// Detail from each model's projected size. Update skinned the level of the last
+	// frame, a CPU skinned level switched to is skinned here
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	float cpuDistance = len(transformPoint(mCPUAnimInfo.mModel, mBoundsCenter) - eye);
+	float gpuDistance = len(transformPoint(mGPUAnimInfo.mModel, mBoundsCenter) - eye);
+	unsigned int cpuLOD = SelectLOD(mCPULODs, GetScreenSize(mBoundsRadius, cpuDistance, 60.0f, (float)viewport[3]));
+	if (cpuLOD != mCPULOD) {
+		mCPULOD = cpuLOD;
+		std::vector<Mesh>& lodMeshes = mCPULODs[mCPULOD].mMeshes;
+		for (unsigned int i = 0, size = (unsigned int)lodMeshes.size(); i < size; ++i) {
+			lodMeshes[i].CPUSkinSIMD(mCPUAnimInfo.mSkinPalette);
+		}
+	}
+	mGPULOD = SelectLOD(mGPULODs, GetScreenSize(mBoundsRadius, gpuDistance, 60.0f, (float)viewport[3]));
+	std::vector<Mesh>& cpuMeshes = mCPULODs[mCPULOD].mMeshes;
+	std::vector<Mesh>& gpuMeshes = mGPULODs[mGPULOD].mMeshes;
+
 	// CPU Skinned Mesh
 	model = transformToMat4(mCPUAnimInfo.mModel);
 	mStaticShader->Bind();
@@ -88,10 +127,10 @@ void Chapter10Sample02::Render(float inAspectRatio)
 	Uniform<vec3>::Set(mStaticShader->GetUniform("light"), vec3(1, 1, 1));
 
 	mDiffuseTexture->Set(mStaticShader->GetUniform("tex0"), 0);
-	for (unsigned int i = 0, size = (unsigned int)mCPUMeshes.size(); i < size; ++i) {
-		mCPUMeshes[i].Bind(mStaticShader->GetAttribute("position"), mStaticShader->GetAttribute("normal"), mStaticShader->GetAttribute("texCoord"), -1, -1);
-		mCPUMeshes[i].Draw();
-		mCPUMeshes[i].UnBind(mStaticShader->GetAttribute("position"), mStaticShader->GetAttribute("normal"), mStaticShader->GetAttribute("texCoord"), -1, -1);
+	for (unsigned int i = 0, size = (unsigned int)cpuMeshes.size(); i < size; ++i) {
+		cpuMeshes[i].Bind(mStaticShader->GetAttribute("position"), mStaticShader->GetAttribute("normal"), mStaticShader->GetAttribute("texCoord"), -1, -1);
+		cpuMeshes[i].Draw();
+		cpuMeshes[i].UnBind(mStaticShader->GetAttribute("position"), mStaticShader->GetAttribute("normal"), mStaticShader->GetAttribute("texCoord"), -1, -1);
 	}
 	mDiffuseTexture->UnSet(0);
 	mStaticShader->UnBind();
@@ -108,10 +147,10 @@ void Chapter10Sample02::Render(float inAspectRatio)
 	Uniform<mat4>::Set(mSkinnedShader->GetUniform("invBindPose"), mSkeleton.GetInvBindPose());
 
 	mDiffuseTexture->Set(mSkinnedShader->GetUniform("tex0"), 0);
-	for (unsigned int i = 0, size = (unsigned int)mGPUMeshes.size(); i < size; ++i) {
-		mGPUMeshes[i].Bind(mSkinnedShader->GetAttribute("position"), mSkinnedShader->GetAttribute("normal"), mSkinnedShader->GetAttribute("texCoord"), mSkinnedShader->GetAttribute("weights"), mSkinnedShader->GetAttribute("joints"));
-		mGPUMeshes[i].Draw();
-		mGPUMeshes[i].UnBind(mSkinnedShader->GetAttribute("position"), mSkinnedShader->GetAttribute("normal"), mSkinnedShader->GetAttribute("texCoord"), mSkinnedShader->GetAttribute("weights"), mSkinnedShader->GetAttribute("joints"));
+	for (unsigned int i = 0, size = (unsigned int)gpuMeshes.size(); i < size; ++i) {
+		gpuMeshes[i].Bind(mSkinnedShader->GetAttribute("position"), mSkinnedShader->GetAttribute("normal"), mSkinnedShader->GetAttribute("texCoord"), mSkinnedShader->GetAttribute("weights"), mSkinnedShader->GetAttribute("joints"));
+		gpuMeshes[i].Draw();
+		gpuMeshes[i].UnBind(mSkinnedShader->GetAttribute("position"), mSkinnedShader->GetAttribute("normal"), mSkinnedShader->GetAttribute("texCoord"), mSkinnedShader->GetAttribute("weights"), mSkinnedShader->GetAttribute("joints"));
 	}
 	mDiffuseTexture->UnSet(0);
 	mSkinnedShader->UnBind();
@@ -122,10 +161,22 @@ void Chapter10Sample02::Shutdown() {
 	delete mDiffuseTexture;
 	delete mSkinnedShader;
 	mClips.clear();
-	mCPUMeshes.clear();
-	mGPUMeshes.clear();
+	mCPULODs.clear();
+	mGPULODs.clear();
 }
 
 void Chapter10Sample02::ImGui(nk_context* inContext)
 {
+	ImGui::Begin("Level of detail");
+	ImGui::SliderFloat("Camera distance", &mCameraDistance, 2.0f, 60.0f);
+	for (unsigned int pass = 0; pass < 2; ++pass) {
+		std::vector<MeshLOD>& lods = pass == 0 ? mCPULODs : mGPULODs;
+		unsigned int level = pass == 0 ? mCPULOD : mGPULOD;
+		unsigned int numTriangles = 0;
+		for (unsigned int i = 0, size = (unsigned int)lods[level].mMeshes.size(); i < size; ++i) {
+			numTriangles += (unsigned int)lods[level].mMeshes[i].GetIndices().size() / 3;
+		}
+		ImGui::Text("%s skinned: level %u, %u triangles", pass == 0 ? "CPU" : "GPU", level, numTriangles);
+	}
+	ImGui::End();
 }
@@ -7,6 +7,7 @@
 #include "Clip.h"
 #include "Skeleton.h"
 #include "Mesh.h"
+#include "MeshOptimizer.h"
 #include "Texture.h"
 #include "Shader.h"
 #include "DebugDraw.h"
@@ -15,6 +16,8 @@
 struct AnimationInstance {
 	Pose mAnimatedPose;
 	std::vector <mat4> mPosePalette;
+	std::vector <mat4> mSkinPalette; // CPU skinning, shared by every mesh
+	ClipCursor mCursor;
 	unsigned int mClip;
 	float mPlayback;
 	Transform mModel;
@@ -27,10 +30,15 @@ protected:
 	Texture* mDiffuseTexture;
 	Shader* mStaticShader;
 	Shader* mSkinnedShader;
-	std::vector<Mesh> mCPUMeshes;
-	std::vector<Mesh> mGPUMeshes;
+	std::vector<MeshLOD> mCPULODs;
+	std::vector<MeshLOD> mGPULODs;
+	unsigned int mCPULOD; // Picked by Render, Update only skins this level
+	unsigned int mGPULOD;
+	vec3 mBoundsCenter;
+	float mBoundsRadius;
+	float mCameraDistance;
 	Skeleton mSkeleton;
-	std::vector<Clip> mClips;
+	std::vector<FastClip> mClips;
 
 	AnimationInstance mGPUAnimInfo;
 	AnimationInstance mCPUAnimInfo;
@@ -1,15 +1,30 @@
 #include "Clip.h"
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 
-Clip::Clip() {
+template TClip<TransformTrack>;
+template TClip<FastTransformTrack>;
+template TClip<CompactTransformTrack>;
+template TClip<QuantizedTransformTrack>;
+template TClip<CubicTransformTrack>;
+
+template std::vector<JointError> MeasureClipError(Clip& reference, Clip& clip, Pose& restPose, float sampleRate);
+template std::vector<JointError> MeasureClipError(Clip& reference, FastClip& clip, Pose& restPose, float sampleRate);
+template std::vector<JointError> MeasureClipError(Clip& reference, CompactClip& clip, Pose& restPose, float sampleRate);
+template std::vector<JointError> MeasureClipError(Clip& reference, QuantizedClip& clip, Pose& restPose, float sampleRate);
+template std::vector<JointError> MeasureClipError(Clip& reference, CubicClip& clip, Pose& restPose, float sampleRate);
+
+template <typename TRACK>
+TClip<TRACK>::TClip() {
 	mName = "No name given";
 	mStartTime = 0.0f;
 	mEndTime = 0.0f;
 	mLooping = true;
 }
 
-float Clip::Sample(Pose& outPose, float time) {
+template <typename TRACK>
+float TClip<TRACK>::Sample(Pose& outPose, float time) {
 	if (GetDuration() == 0.0f) {
 		return 0.0f;
 	}
@@ -25,7 +40,28 @@ float Clip::Sample(Pose& outPose, float time) {
 	return time;
 }
 
-float Clip::AdjustTimeToFitRange(float inTime) 
+template <typename TRACK>
+float TClip<TRACK>::Sample(Pose& outPose, float time, ClipCursor& cursor) {
+	if (GetDuration() == 0.0f) {
+		return 0.0f;
+	}
+	time = AdjustTimeToFitRange(time);
+
+	unsigned int size = mTracks.size();
+	if (cursor.mTracks.size() != size) {
+		cursor.mTracks.resize(size);
+	}
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int joint = mTracks[i].GetId();
+		Transform local = outPose.GetLocalTransform(joint);
+		Transform animated = mTracks[i].Sample(local, time, mLooping, cursor.mTracks[i]);
+		outPose.SetLocalTransform(joint, animated);
+	}
+	return time;
+}
+
+template <typename TRACK>
+float TClip<TRACK>::AdjustTimeToFitRange(float inTime) 
 {
 	if (mLooping) {
 		float duration = mEndTime - mStartTime;
@@ -49,7 +85,8 @@ float Clip::AdjustTimeToFitRange(float inTime)
 	return inTime;
 }
 
-void Clip::RecalculateDuration() {
+template <typename TRACK>
+void TClip<TRACK>::RecalculateDuration() {
 	mStartTime = 0.0f;
 	mEndTime = 0.0f;
 	bool startSet = false;
@@ -73,7 +110,14 @@ void Clip::RecalculateDuration() {
 	}
 }
 
-TransformTrack& Clip::operator[](unsigned int joint) {
+template <typename TRACK>
+void TClip<TRACK>::SetTimeRange(float startTime, float endTime) {
+	mStartTime = startTime;
+	mEndTime = endTime;
+}
+
+template <typename TRACK>
+TRACK& TClip<TRACK>::operator[](unsigned int joint) {
 	for (unsigned int i = 0, size = (unsigned int)mTracks.size();
 		i < size; ++i) {
 		if (mTracks[i].GetId() == joint) {
@@ -81,47 +125,227 @@ TransformTrack& Clip::operator[](unsigned int joint) {
 		}
 	}
 
-	mTracks.push_back(TransformTrack());
+	mTracks.push_back(TRACK());
 	mTracks[mTracks.size() - 1].SetId(joint);
 	return mTracks[mTracks.size() - 1];
 }
 
-std::string& Clip::GetName() {
+template <typename TRACK>
+std::string& TClip<TRACK>::GetName() {
 	return mName;
 }
 
-void Clip::SetName(const std::string& inNewName) {
+template <typename TRACK>
+void TClip<TRACK>::SetName(const std::string& inNewName) {
 	mName = inNewName;
 }
 
-unsigned int Clip::GetIdAtIndex(unsigned int index) {
+template <typename TRACK>
+unsigned int TClip<TRACK>::GetIdAtIndex(unsigned int index) {
 	return mTracks[index].GetId();
 }
 
-void Clip::SetIdAtIndex(unsigned int index, unsigned int id) {
+template <typename TRACK>
+void TClip<TRACK>::SetIdAtIndex(unsigned int index, unsigned int id) {
 	return mTracks[index].SetId(id);
 }
 
-unsigned int Clip::Size() {
+template <typename TRACK>
+unsigned int TClip<TRACK>::Size() {
 	return (unsigned int)mTracks.size();
 }
 
-float Clip::GetDuration() {
+template <typename TRACK>
+unsigned int TClip<TRACK>::GetMemorySize() {
+	unsigned int result = 0;
+	for (unsigned int i = 0, size = (unsigned int)mTracks.size(); i < size; ++i) {
+		result += mTracks[i].GetMemorySize();
+	}
+	return result;
+}
+
+template <typename TRACK>
+float TClip<TRACK>::GetDuration() {
 	return mEndTime - mStartTime;
 }
 
-float Clip::GetStartTime() {
+template <typename TRACK>
+float TClip<TRACK>::GetStartTime() {
 	return mStartTime;
 }
 
-float Clip::GetEndTime() {
+template <typename TRACK>
+float TClip<TRACK>::GetEndTime() {
 	return mEndTime;
 }
 
-bool Clip::GetLooping() {
+template <typename TRACK>
+bool TClip<TRACK>::GetLooping() {
 	return mLooping;
 }
 
-void Clip::SetLooping(bool inLooping) {
+template <typename TRACK>
+void TClip<TRACK>::SetLooping(bool inLooping) {
 	mLooping = inLooping;
 }
+
+void ClipCursor::Reset() {
+	for (unsigned int i = 0, size = (unsigned int)mTracks.size(); i < size; ++i) {
+		mTracks[i].mPosition.Reset();
+		mTracks[i].mRotation.Reset();
+		mTracks[i].mScale.Reset();
+	}
+	for (unsigned int i = 0, size = (unsigned int)mChannels.size(); i < size; ++i) {
+		mChannels[i].Reset();
+	}
+}
+
+FastClip OptimizeClip(Clip& input, float sampleRate, float tolerance) {
+	FastClip result;
+
+	result.SetName(input.GetName());
+	result.SetLooping(input.GetLooping());
+	unsigned int size = input.Size();
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int joint = input.GetIdAtIndex(i);
+		FastTransformTrack& track = result[joint];
+		track = OptimizeTransformTrack(input[joint], sampleRate, tolerance);
+	}
+	result.RecalculateDuration();
+
+	return result;
+}
+
+CompactClip PackClip(Clip& input) {
+	CompactClip result;
+
+	result.SetName(input.GetName());
+	result.SetLooping(input.GetLooping());
+	unsigned int size = input.Size();
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int joint = input.GetIdAtIndex(i);
+		result[joint] = PackTransformTrack(input[joint]);
+	}
+	result.RecalculateDuration();
+
+	return result;
+}
+
+QuantizedClip QuantizeClip(Clip& input) {
+	QuantizedClip result;
+
+	result.SetName(input.GetName());
+	result.SetLooping(input.GetLooping());
+	unsigned int size = input.Size();
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int joint = input.GetIdAtIndex(i);
+		result[joint] = QuantizeTransformTrack(input[joint]);
+	}
+	result.SetTimeRange(input.GetStartTime(), input.GetEndTime());
+
+	return result;
+}
+
+CubicClip PrecomputeClip(Clip& input) {
+	CubicClip result;
+
+	result.SetName(input.GetName());
+	result.SetLooping(input.GetLooping());
+	unsigned int size = input.Size();
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int joint = input.GetIdAtIndex(i);
+		result[joint] = PrecomputeTransformTrack(input[joint]);
+	}
+	result.SetTimeRange(input.GetStartTime(), input.GetEndTime());
+
+	return result;
+}
+
+template <typename TRACK>
+std::vector<JointError> MeasureClipError(Clip& reference, TClip<TRACK>& clip, Pose& restPose, float sampleRate) {
+	unsigned int numTracks = reference.Size();
+	std::vector<JointError> result(numTracks);
+	for (unsigned int i = 0; i < numTracks; ++i) {
+		result[i].mJoint = reference.GetIdAtIndex(i);
+		result[i].mPosition = 0.0f;
+		result[i].mRotation = 0.0f;
+		result[i].mScale = 0.0f;
+	}
+
+	float startTime = reference.GetStartTime();
+	float duration = reference.GetDuration();
+	unsigned int numSamples = sampleRate > 0.0f ? (unsigned int)(duration * sampleRate) + 1 : 1;
+	Pose expected = restPose;
+	Pose actual = restPose;
+	for (unsigned int s = 0; s < numSamples; ++s) {
+		float time = startTime + std::min((float)s / sampleRate, duration);
+		reference.Sample(expected, time);
+		clip.Sample(actual, time);
+		for (unsigned int i = 0; i < numTracks; ++i) {
+			JointError& error = result[i];
+			Transform a = expected.GetLocalTransform(error.mJoint);
+			Transform b = actual.GetLocalTransform(error.mJoint);
+			quat delta = inverse(a.rotation) * b.rotation;
+			float angle = 2.0f * atan2f(sqrtf(lenSq(vec3(delta.x, delta.y, delta.z))), fabsf(delta.w));
+			error.mPosition = std::max(error.mPosition, sqrtf(lenSq(a.position - b.position)));
+			error.mRotation = std::max(error.mRotation, angle);
+			error.mScale = std::max(error.mScale, sqrtf(lenSq(a.scale - b.scale)));
+		}
+	}
+
+	return result;
+}
+
+Clip ReduceClip(Clip& input, float positionError, float angleError, float scaleError) {
+	Clip result;
+
+	result.SetName(input.GetName());
+	result.SetLooping(input.GetLooping());
+	unsigned int size = input.Size();
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int joint = input.GetIdAtIndex(i);
+		result[joint] = ReduceTransformTrack(input[joint], positionError, angleError, scaleError);
+	}
+	result.SetTimeRange(input.GetStartTime(), input.GetEndTime());
+
+	return result;
+}
+
+Clip MakeAdditiveClip(Clip& input, Pose& reference) {
+	Clip result;
+
+	result.SetName(input.GetName());
+	result.SetLooping(input.GetLooping());
+	unsigned int size = input.Size();
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int joint = input.GetIdAtIndex(i);
+		result[joint] = MakeAdditiveTransformTrack(input[joint], reference.GetLocalTransform(joint));
+	}
+	result.SetTimeRange(input.GetStartTime(), input.GetEndTime());
+
+	return result;
+}
+
+Clip MakeAdditiveClip(Clip& input, Clip& reference, Pose& restPose, float sampleRate) {
+	Clip result;
+	TransformTrack empty;
+
+	result.SetName(input.GetName());
+	result.SetLooping(input.GetLooping());
+	unsigned int size = input.Size();
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int joint = input.GetIdAtIndex(i);
+		TransformTrack* referenceTrack = &empty;
+		for (unsigned int j = 0, numReference = reference.Size(); j < numReference; ++j) {
+			if (reference.GetIdAtIndex(j) == joint) {
+				referenceTrack = &reference[joint];
+				break;
+			}
+		}
+		result[joint] = MakeAdditiveTransformTrack(input[joint], *referenceTrack,
+			restPose.GetLocalTransform(joint), reference.GetLooping(), sampleRate);
+	}
+	result.SetTimeRange(input.GetStartTime(), input.GetEndTime());
+
+	return result;
+}
@@ -6,9 +6,19 @@
 #include "TransformTrack.h"
 #include "Pose.h"
 
-class Clip {
+// Per playback sampling state, holds one cursor for every track of the clip being played
+class ClipCursor {
+public:
+	std::vector<TransformTrackCursor> mTracks;
+	std::vector<TrackCursor> mChannels; // Used by StaticClip, one per channel
+public:
+	void Reset();
+};
+
+template <typename TRACK>
+class TClip {
 protected:
-	std::vector<TransformTrack> mTracks;
+	std::vector<TRACK> mTracks;
 	std::string mName;
 	float mStartTime;
 	float mEndTime;
@@ -16,13 +26,15 @@ protected:
 protected:
 	float AdjustTimeToFitRange(float inTime);
 public:
-	Clip();
+	TClip();
 	unsigned int GetIdAtIndex(unsigned int index);
 	void SetIdAtIndex(unsigned int index, unsigned int id);
 	unsigned int Size();
 	float Sample(Pose& outPose, float inTime);
-	TransformTrack& operator[](unsigned int index);
+	float Sample(Pose& outPose, float inTime, ClipCursor& cursor);
+	TRACK& operator[](unsigned int index);
 	void RecalculateDuration();
+	void SetTimeRange(float startTime, float endTime);
 	std::string& GetName();
 	void SetName(const std::string& inNewName);
 	float GetDuration();
@@ -30,6 +42,45 @@ public:
 	float GetEndTime();
 	bool GetLooping();
 	void SetLooping(bool inLooping);
+	unsigned int GetMemorySize();
 };
 
+typedef TClip<TransformTrack> Clip;
+typedef TClip<FastTransformTrack> FastClip;
+typedef TClip<CompactTransformTrack> CompactClip;
+typedef TClip<QuantizedTransformTrack> QuantizedClip;
+typedef TClip<CubicTransformTrack> CubicClip;
+
+// Largest local space difference of one joint between two versions of a clip
+struct JointError {
+	unsigned int mJoint;
+	float mPosition;
+	float mRotation; // Radians
+	float mScale;
+};
+
+// Converts a loaded clip so every track samples through a time to frame lookup table,
+// see OptimizeTrack for how sampleRate and tolerance are used
+FastClip OptimizeClip(Clip& input, float sampleRate = 60.0f, float tolerance = 0.0001f);
+// Drops the tangents constant and linear tracks never read, see CompactTrack
+CompactClip PackClip(Clip& input);
+// Stores every key in 16 bit words, see QuantizedTrack
+QuantizedClip QuantizeClip(Clip& input);
+// Compiles every segment to a polynomial sampled with a Horner evaluation, see CubicTrack
+CubicClip PrecomputeClip(Clip& input);
+// Samples both clips on top of restPose at sampleRate and reports the worst error of
+// every joint the reference clip animates
+template <typename TRACK>
+std::vector<JointError> MeasureClipError(Clip& reference, TClip<TRACK>& clip, Pose& restPose, float sampleRate = 60.0f);
+// Removes keys that do not move any channel by more than the given error, see ReduceTrack.
+// The clip keeps its time range even if the tracks that defined it become constant.
+Clip ReduceClip(Clip& input, float positionError = 0.001f, float angleError = 0.0017f, float scaleError = 0.001f);
+// Converts a clip to deltas from a reference pose, usually the clip's own first frame,
+// see MakeAdditiveTransformTrack. Sample the result into a pose made by MakeDeltaPose,
+// then apply it with AddDelta. Nothing has to be sampled for the reference at runtime.
+Clip MakeAdditiveClip(Clip& input, Pose& reference);
+// As above, against a reference clip sampled on top of restPose, see the reference track
+// version of MakeAdditiveTransformTrack for how sampleRate is used
+Clip MakeAdditiveClip(Clip& input, Clip& reference, Pose& restPose, float sampleRate = 30.0f);
+
 #endif 
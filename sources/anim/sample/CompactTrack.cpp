@@ -0,0 +1,29 @@
+#include "CompactTrack.h"
+
+template CompactTrack<float, 1>;
+template CompactTrack<vec3, 3>;
+template CompactTrack<quat, 4>;
+
+template CompactTrack<float, 1> PackTrack(Track<float, 1>& input);
+template CompactTrack<vec3, 3> PackTrack(Track<vec3, 3>& input);
+template CompactTrack<quat, 4> PackTrack(Track<quat, 4>& input);
+
+template<> float CompactTrack<float, 1>::Cast(const float* value) {
+	return value[0];
+}
+
+template<> vec3 CompactTrack<vec3, 3>::Cast(const float* value) {
+	return vec3(value[0], value[1], value[2]);
+}
+
+template<> quat CompactTrack<quat, 4>::Cast(const float* value) {
+	quat r = quat(value[0], value[1], value[2], value[3]);
+	return normalized(r);
+}
+
+template<typename T, int N>
+CompactTrack<T, N> PackTrack(Track<T, N>& input) {
+	CompactTrack<T, N> result;
+	result.Set(input);
+	return result;
+}
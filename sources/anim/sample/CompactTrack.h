@@ -0,0 +1,233 @@
+#ifndef _H_COMPACTTRACK_
+#define _H_COMPACTTRACK_
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "Track.h"
+
+// A track that only stores what its interpolation reads. Key times live in their own
+// array so frame searches touch nothing else. Constant and linear tracks store N
+// floats per key, cubic tracks store in, value and out tangents (3 * N floats).
+template<typename T, int N>
+class CompactTrack {
+protected:
+	std::vector<float> mTimes;
+	std::vector<float> mValues;
+	Interpolation mInterpolation;
+protected:
+	int Stride();
+	int FrameIndex(float trackTime);
+	int FrameIndex(float trackTime, TrackCursor& cursor);
+	float AdjustTimeToFitTrack(float time, bool looping);
+	T SampleFrame(int frame, float trackTime);
+	T Cast(const float* value);
+public:
+	CompactTrack();
+	void Set(Track<T, N>& input);
+	unsigned int Size();
+	Interpolation GetInterpolation();
+	float GetStartTime() const;
+	float GetEndTime() const;
+	T Sample(float time, bool looping);
+	T Sample(float time, bool looping, TrackCursor& cursor);
+	T GetValue(unsigned int index);
+	unsigned int GetMemorySize();
+};
+
+typedef CompactTrack<float, 1> CompactScalarTrack;
+typedef CompactTrack<vec3, 3> CompactVectorTrack;
+typedef CompactTrack<quat, 4> CompactQuaternionTrack;
+
+template<typename T, int N>
+CompactTrack<T, N> PackTrack(Track<T, N>& input);
+
+template<typename T, int N>
+CompactTrack<T, N>::CompactTrack() {
+    mInterpolation = Interpolation::Linear;
+}
+
+template<typename T, int N>
+int CompactTrack<T, N>::Stride() {
+    return mInterpolation == Interpolation::Cubic ? N * 3 : N;
+}
+
+template<typename T, int N>
+void CompactTrack<T, N>::Set(Track<T, N>& input) {
+    mInterpolation = input.GetInterpolation();
+
+    unsigned int size = input.Size();
+    int stride = Stride();
+    mTimes.resize(size);
+    mValues.resize(size * stride);
+
+    for (unsigned int i = 0; i < size; ++i) {
+        Frame<N>& frame = input[i];
+        float* values = &mValues[i * stride];
+        mTimes[i] = frame.mTime;
+        if (mInterpolation == Interpolation::Cubic) {
+            memcpy(values, frame.mIn, N * sizeof(float));
+            memcpy(values + N, frame.mValue, N * sizeof(float));
+            memcpy(values + N * 2, frame.mOut, N * sizeof(float));
+        }
+        else {
+            memcpy(values, frame.mValue, N * sizeof(float));
+        }
+    }
+}
+
+template<typename T, int N>
+unsigned int CompactTrack<T, N>::Size() {
+    return (unsigned int)mTimes.size();
+}
+
+template<typename T, int N>
+Interpolation CompactTrack<T, N>::GetInterpolation() {
+    return mInterpolation;
+}
+
+template<typename T, int N>
+float CompactTrack<T, N>::GetStartTime() const {
+    return mTimes.front();
+}
+
+template<typename T, int N>
+float CompactTrack<T, N>::GetEndTime() const {
+    return mTimes.back();
+}
+
+template<typename T, int N>
+T CompactTrack<T, N>::GetValue(unsigned int index) {
+    int stride = Stride();
+    int offset = mInterpolation == Interpolation::Cubic ? N : 0;
+    return Cast(&mValues[index * stride + offset]);
+}
+
+template<typename T, int N>
+unsigned int CompactTrack<T, N>::GetMemorySize() {
+    return (unsigned int)(sizeof(float) * (mTimes.size() + mValues.size()));
+}
+
+namespace CompactTrackHelpers {
+    // Time lookups over a key time array, shared by the tracks that store times on their own
+    inline float AdjustTimeToFitTrack(const std::vector<float>& times, float time, bool looping) {
+        unsigned int size = (unsigned int)times.size();
+        if (size <= 1) { return 0.0f; }
+
+        float startTime = times[0];
+        float endTime = times[size - 1];
+        float duration = endTime - startTime;
+        if (duration <= 0.0f) { return 0.0f; }
+        if (looping) {
+            time = fmodf(time - startTime, duration);
+            if (time < 0.0f) {
+                time += duration;
+            }
+            time = time + startTime;
+        }
+        else {
+            if (time <= startTime) { time = startTime; }
+            if (time >= endTime) { time = endTime; }
+        }
+        return time;
+    }
+
+    inline int FrameIndex(const std::vector<float>& times, float trackTime) {
+        int last = (int)times.size() - 2;
+        if (last < 0) {
+            return -1;
+        }
+        std::vector<float>::const_iterator next = std::upper_bound(
+            times.begin() + 1, times.begin() + last + 1, trackTime);
+        return (int)(next - times.begin()) - 1;
+    }
+
+    inline int FrameIndex(const std::vector<float>& times, float trackTime, TrackCursor& cursor) {
+        int last = (int)times.size() - 2;
+        int frame = cursor.mFrame;
+        if (frame >= 0 && frame <= last) {
+            if (trackTime >= times[frame]) {
+                for (int step = 0; step < TRACK_CURSOR_MAX_STEPS; ++step) {
+                    if (frame == last || trackTime < times[frame + 1]) {
+                        cursor.mFrame = frame;
+                        return frame;
+                    }
+                    ++frame;
+                }
+            }
+            else {
+                for (int step = 0; step < TRACK_CURSOR_MAX_STEPS && frame > 0; ++step) {
+                    --frame;
+                    if (frame == 0 || trackTime >= times[frame]) {
+                        cursor.mFrame = frame;
+                        return frame;
+                    }
+                }
+            }
+        }
+
+        cursor.mFrame = FrameIndex(times, trackTime);
+        return cursor.mFrame;
+    }
+} // End CompactTrackHelpers namespace
+
+template<typename T, int N>
+float CompactTrack<T, N>::AdjustTimeToFitTrack(float time, bool looping) {
+    return CompactTrackHelpers::AdjustTimeToFitTrack(mTimes, time, looping);
+}
+
+template<typename T, int N>
+int CompactTrack<T, N>::FrameIndex(float trackTime) {
+    return CompactTrackHelpers::FrameIndex(mTimes, trackTime);
+}
+
+template<typename T, int N>
+int CompactTrack<T, N>::FrameIndex(float trackTime, TrackCursor& cursor) {
+    return CompactTrackHelpers::FrameIndex(mTimes, trackTime, cursor);
+}
+
+template<typename T, int N>
+T CompactTrack<T, N>::SampleFrame(int thisFrame, float trackTime) {
+    if (thisFrame < 0) {
+        return T();
+    }
+    int stride = Stride();
+    const float* values = &mValues[thisFrame * stride];
+    if (mInterpolation == Interpolation::Constant) {
+        return Cast(values);
+    }
+
+    int nextFrame = thisFrame + 1;
+    float frameDelta = mTimes[nextFrame] - mTimes[thisFrame];
+    if (frameDelta <= 0.0f) {
+        return T();
+    }
+    float t = (trackTime - mTimes[thisFrame]) / frameDelta;
+    const float* next = values + stride;
+
+    if (mInterpolation == Interpolation::Linear) {
+        return TrackHelpers::Interpolate(Cast(values), Cast(next), t);
+    }
+
+    T slope1;
+    memcpy(&slope1, values + N * 2, N * sizeof(float));
+    T slope2;
+    memcpy(&slope2, next, N * sizeof(float));
+
+    return TrackHelpers::Hermite(t, Cast(values + N), slope1 * frameDelta, Cast(next + N), slope2 * frameDelta);
+}
+
+template<typename T, int N>
+T CompactTrack<T, N>::Sample(float time, bool looping) {
+    float trackTime = AdjustTimeToFitTrack(time, looping);
+    return SampleFrame(FrameIndex(trackTime), trackTime);
+}
+
+template<typename T, int N>
+T CompactTrack<T, N>::Sample(float time, bool looping, TrackCursor& cursor) {
+    float trackTime = AdjustTimeToFitTrack(time, looping);
+    return SampleFrame(FrameIndex(trackTime, cursor), trackTime);
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include "CompactVertex.h"
+#include <cmath>
+#include <cstring>
+
+namespace CompactVertexHelpers {
+	inline float Clamp(float value, float min, float max) {
+		return value < min ? min : (value > max ? max : value);
+	}
+
+	inline float Sign(float value) {
+		return value >= 0.0f ? 1.0f : -1.0f;
+	}
+
+	// GL normalizes unsigned shorts by 65535 and signed shorts by 32767
+	inline unsigned short ToUnorm16(float value) {
+		return (unsigned short)(Clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+	}
+
+	inline short ToSnorm16(float value) {
+		return (short)floorf(Clamp(value, -1.0f, 1.0f) * 32767.0f + 0.5f);
+	}
+} // End CompactVertexHelpers namespace
+
+unsigned short floatToHalf(float value) {
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	unsigned int sign = (bits >> 16) & 0x8000;
+	int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+	unsigned int mantissa = bits & 0x7fffff;
+
+	if ((bits & 0x7fffffff) > 0x7f800000) { // NaN
+		return (unsigned short)(sign | 0x7e00);
+	}
+	if (exponent >= 31) { // Too big, infinity
+		return (unsigned short)(sign | 0x7c00);
+	}
+	if (exponent <= 0) { // Denormal, or zero when too small
+		if (exponent < -10) {
+			return (unsigned short)sign;
+		}
+		mantissa |= 0x800000;
+		unsigned int shift = (unsigned int)(14 - exponent);
+		unsigned int half = mantissa >> shift;
+		if ((mantissa >> (shift - 1)) & 1) {
+			++half;
+		}
+		return (unsigned short)(sign | half);
+	}
+
+	// Rounding up may carry into the exponent, which is still the right result
+	unsigned int half = sign | ((unsigned int)exponent << 10) | (mantissa >> 13);
+	if (mantissa & 0x1000) {
+		++half;
+	}
+	return (unsigned short)half;
+}
+
+float halfToFloat(unsigned short value) {
+	unsigned int sign = (unsigned int)(value & 0x8000) << 16;
+	unsigned int exponent = (value >> 10) & 0x1f;
+	unsigned int mantissa = value & 0x3ff;
+
+	if (exponent == 0) {
+		float result = ldexpf((float)mantissa, -24);
+		return sign != 0 ? -result : result;
+	}
+	unsigned int bits = sign | (mantissa << 13);
+	if (exponent == 31) {
+		bits |= 0x7f800000;
+	}
+	else {
+		bits |= (exponent - 15 + 127) << 23;
+	}
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+vec2 octahedralEncode(const vec3& n) {
+	float l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+	if (l1 == 0.0f) {
+		return vec2(0.0f, 0.0f);
+	}
+	float x = n.x / l1;
+	float y = n.y / l1;
+	if (n.z < 0.0f) { // Fold the lower half over the diagonals
+		float foldedX = (1.0f - fabsf(y)) * CompactVertexHelpers::Sign(x);
+		float foldedY = (1.0f - fabsf(x)) * CompactVertexHelpers::Sign(y);
+		x = foldedX;
+		y = foldedY;
+	}
+	return vec2(x, y);
+}
+
+vec3 octahedralDecode(const vec2& e) {
+	vec3 n(e.x, e.y, 1.0f - fabsf(e.x) - fabsf(e.y));
+	float t = n.z < 0.0f ? -n.z : 0.0f;
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	return normalized(n);
+}
+
+CompactVertex compactVertex(const vec3& position, const vec3& normal, const vec2& texCoord,
+	const vec4& weights, const ivec4& joints, const vec3& min, const vec3& extent) {
+	CompactVertex result;
+
+	for (unsigned int i = 0; i < 3; ++i) {
+		float t = extent.v[i] > 0.0f ? (position.v[i] - min.v[i]) / extent.v[i] : 0.0f;
+		result.position[i] = CompactVertexHelpers::ToUnorm16(t);
+	}
+	result.position[3] = 0;
+
+	vec2 octahedral = octahedralEncode(normal);
+	result.normal[0] = CompactVertexHelpers::ToSnorm16(octahedral.x);
+	result.normal[1] = CompactVertexHelpers::ToSnorm16(octahedral.y);
+
+	result.texCoord[0] = floatToHalf(texCoord.x);
+	result.texCoord[1] = floatToHalf(texCoord.y);
+
+	// Round each weight, then give the rounding error to the largest so they still
+	// sum to one. A weight of one stays exactly one, the rigid kernels rely on it
+	int quantized[4];
+	int total = 0;
+	int largest = 0;
+	for (unsigned int i = 0; i < 4; ++i) {
+		quantized[i] = (int)(CompactVertexHelpers::Clamp(weights.v[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+		total += quantized[i];
+		largest = quantized[i] > quantized[largest] ? (int)i : largest;
+	}
+	if (total > 0) {
+		quantized[largest] += 255 - total;
+	}
+	int ids[4] = { joints.x, joints.y, joints.z, joints.w };
+	for (unsigned int i = 0; i < 4; ++i) {
+		result.weights[i] = (unsigned char)quantized[i];
+		result.joints[i] = (unsigned char)ids[i];
+	}
+	return result;
+}
+
+vec3 decodePosition(const CompactVertex& v, const vec3& min, const vec3& extent) {
+	const float scale = 1.0f / 65535.0f;
+	return vec3(
+		min.x + (float)v.position[0] * scale * extent.x,
+		min.y + (float)v.position[1] * scale * extent.y,
+		min.z + (float)v.position[2] * scale * extent.z
+	);
+}
+
+vec3 decodeNormal(const CompactVertex& v) {
+	const float scale = 1.0f / 32767.0f;
+	vec2 e((float)v.normal[0] * scale, (float)v.normal[1] * scale);
+	return octahedralDecode(vec2(e.x < -1.0f ? -1.0f : e.x, e.y < -1.0f ? -1.0f : e.y));
+}
+
+vec2 decodeTexCoord(const CompactVertex& v) {
+	return vec2(halfToFloat(v.texCoord[0]), halfToFloat(v.texCoord[1]));
+}
+
+vec4 decodeWeights(const CompactVertex& v) {
+	const float scale = 1.0f / 255.0f;
+	return vec4((float)v.weights[0] * scale, (float)v.weights[1] * scale,
+		(float)v.weights[2] * scale, (float)v.weights[3] * scale);
+}
+
+ivec4 decodeJoints(const CompactVertex& v) {
+	return ivec4(v.joints[0], v.joints[1], v.joints[2], v.joints[3]);
+}
@@ -0,0 +1,36 @@
+#ifndef _H_COMPACTVERTEX_
+#define _H_COMPACTVERTEX_
+
+#include "vec2.h"
+#include "vec3.h"
+#include "vec4.h"
+
+// A skinned vertex in 24 bytes instead of the 64 of the float attributes. The position
+// is 16 bit unorm inside the mesh bounds (w is padding, keeps the normal aligned), the
+// normal is octahedral in two 16 bit snorms, the uv is half floats and the weights are
+// 8 bit unorm that sum to 255. The skinning shaders take at most 120 joints, 8 bit
+// joint indices are enough. An array of them is also the vertex buffer layout.
+struct CompactVertex {
+	unsigned short position[4];
+	short normal[2];
+	unsigned short texCoord[2];
+	unsigned char weights[4];
+	unsigned char joints[4];
+};
+
+unsigned short floatToHalf(float value);
+float halfToFloat(unsigned short value);
+// Maps a unit vector onto the [-1, 1] square, an octahedron unfolded around +z
+vec2 octahedralEncode(const vec3& n);
+vec3 octahedralDecode(const vec2& e);
+
+// min and extent are the mesh bounds, extent is max - min
+CompactVertex compactVertex(const vec3& position, const vec3& normal, const vec2& texCoord,
+	const vec4& weights, const ivec4& joints, const vec3& min, const vec3& extent);
+vec3 decodePosition(const CompactVertex& v, const vec3& min, const vec3& extent);
+vec3 decodeNormal(const CompactVertex& v);
+vec2 decodeTexCoord(const CompactVertex& v);
+vec4 decodeWeights(const CompactVertex& v);
+ivec4 decodeJoints(const CompactVertex& v);
+
+#endif
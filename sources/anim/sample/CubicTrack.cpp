@@ -0,0 +1,29 @@
+#include "CubicTrack.h"
+
+template CubicTrack<float, 1>;
+template CubicTrack<vec3, 3>;
+template CubicTrack<quat, 4>;
+
+template CubicTrack<float, 1> PrecomputeTrack(Track<float, 1>& input);
+template CubicTrack<vec3, 3> PrecomputeTrack(Track<vec3, 3>& input);
+template CubicTrack<quat, 4> PrecomputeTrack(Track<quat, 4>& input);
+
+template<> float CubicTrack<float, 1>::Cast(const float* value) {
+	return value[0];
+}
+
+template<> vec3 CubicTrack<vec3, 3>::Cast(const float* value) {
+	return vec3(value[0], value[1], value[2]);
+}
+
+// Not normalized here, Evaluate normalizes after the polynomial
+template<> quat CubicTrack<quat, 4>::Cast(const float* value) {
+	return quat(value[0], value[1], value[2], value[3]);
+}
+
+template<typename T, int N>
+CubicTrack<T, N> PrecomputeTrack(Track<T, N>& input) {
+	CubicTrack<T, N> result;
+	result.Set(input);
+	return result;
+}
@@ -0,0 +1,157 @@
+#ifndef _H_CUBICTRACK_
+#define _H_CUBICTRACK_
+
+#include <vector>
+#include <cmath>
+
+#include "Track.h"
+#include "CompactTrack.h"
+
+// A track compiled to one polynomial per segment, a + b * t + c * t^2 + d * t^3 with t
+// the time since the segment started. Sampling is a search and a Horner evaluation, the
+// slopes, the Hermite basis and the quaternion neighborhood are all folded into the
+// coefficients ahead of time. Constant and linear tracks compile to lower degree
+// polynomials, so every track samples through the same code.
+template<typename T, int N>
+class CubicTrack {
+protected:
+	std::vector<float> mTimes;
+	std::vector<float> mCoefficients; // a, b, c and d for every segment, N floats each
+protected:
+	T Evaluate(int segment, float t);
+	T Cast(const float* value);
+public:
+	CubicTrack();
+	void Set(Track<T, N>& input);
+	unsigned int Size();
+	float GetStartTime() const;
+	float GetEndTime() const;
+	T Sample(float time, bool looping);
+	T Sample(float time, bool looping, TrackCursor& cursor);
+	T GetValue(unsigned int index);
+	unsigned int GetMemorySize();
+};
+
+typedef CubicTrack<float, 1> CubicScalarTrack;
+typedef CubicTrack<vec3, 3> CubicVectorTrack;
+typedef CubicTrack<quat, 4> CubicQuaternionTrack;
+
+template<typename T, int N>
+CubicTrack<T, N> PrecomputeTrack(Track<T, N>& input);
+
+template<typename T, int N>
+CubicTrack<T, N>::CubicTrack() { }
+
+template<typename T, int N>
+void CubicTrack<T, N>::Set(Track<T, N>& input) {
+	unsigned int size = input.Size();
+	unsigned int numSegments = size > 1 ? size - 1 : size;
+	Interpolation interpolation = input.GetInterpolation();
+
+	mTimes.resize(size);
+	mCoefficients.assign(numSegments * N * 4, 0.0f);
+	for (unsigned int i = 0; i < size; ++i) {
+		mTimes[i] = input[i].mTime;
+	}
+	if (size == 1) {
+		T value = input.GetValue(0);
+		memcpy(&mCoefficients[0], &value, N * sizeof(float));
+		return;
+	}
+
+	for (unsigned int i = 0; i < numSegments; ++i) {
+		float* k = &mCoefficients[i * N * 4];
+		float frameDelta = mTimes[i + 1] - mTimes[i];
+		T p1 = input.GetValue(i);
+		T p2 = input.GetValue(i + 1);
+		TrackHelpers::Neighborhood(p1, p2);
+
+		T a = p1;
+		T b = p1 * 0.0f;
+		T c = b;
+		T d = b;
+		if (frameDelta > 0.0f && interpolation == Interpolation::Linear) {
+			b = (p2 - p1) * (1.0f / frameDelta);
+		}
+		else if (frameDelta > 0.0f && interpolation == Interpolation::Cubic) {
+			// Hermite basis expanded for the normalized time, then rescaled to seconds
+			T s1;
+			memcpy(&s1, input[i].mOut, N * sizeof(float));
+			s1 = s1 * frameDelta;
+			T s2;
+			memcpy(&s2, input[i + 1].mIn, N * sizeof(float));
+			s2 = s2 * frameDelta;
+
+			float invDelta = 1.0f / frameDelta;
+			b = s1 * invDelta;
+			c = (p1 * -3.0f + p2 * 3.0f - s1 * 2.0f - s2) * (invDelta * invDelta);
+			d = (p1 * 2.0f - p2 * 2.0f + s1 + s2) * (invDelta * invDelta * invDelta);
+		}
+
+		memcpy(k, &a, N * sizeof(float));
+		memcpy(k + N, &b, N * sizeof(float));
+		memcpy(k + N * 2, &c, N * sizeof(float));
+		memcpy(k + N * 3, &d, N * sizeof(float));
+	}
+}
+
+template<typename T, int N>
+unsigned int CubicTrack<T, N>::Size() {
+	return (unsigned int)mTimes.size();
+}
+
+template<typename T, int N>
+float CubicTrack<T, N>::GetStartTime() const {
+	return mTimes.front();
+}
+
+template<typename T, int N>
+float CubicTrack<T, N>::GetEndTime() const {
+	return mTimes.back();
+}
+
+template<typename T, int N>
+unsigned int CubicTrack<T, N>::GetMemorySize() {
+	return (unsigned int)(sizeof(float) * (mTimes.size() + mCoefficients.size()));
+}
+
+template<typename T, int N>
+T CubicTrack<T, N>::Evaluate(int segment, float t) {
+	const float* k = &mCoefficients[segment * N * 4];
+	float value[N];
+	for (int i = 0; i < N; ++i) {
+		value[i] = k[i] + t * (k[N + i] + t * (k[N * 2 + i] + t * k[N * 3 + i]));
+	}
+	return TrackHelpers::AdjustHermiteResult(Cast(value));
+}
+
+template<typename T, int N>
+T CubicTrack<T, N>::GetValue(unsigned int index) {
+	unsigned int numSegments = (unsigned int)mCoefficients.size() / (N * 4);
+	if (index < numSegments) {
+		return Cast(&mCoefficients[index * N * 4]);
+	}
+	return Evaluate((int)index - 1, mTimes[index] - mTimes[index - 1]);
+}
+
+template<typename T, int N>
+T CubicTrack<T, N>::Sample(float time, bool looping) {
+	float trackTime = CompactTrackHelpers::AdjustTimeToFitTrack(mTimes, time, looping);
+	int frame = CompactTrackHelpers::FrameIndex(mTimes, trackTime);
+	if (frame < 0) {
+		return T();
+	}
+	return Evaluate(frame, trackTime - mTimes[frame]);
+}
+
+template<typename T, int N>
+T CubicTrack<T, N>::Sample(float time, bool looping, TrackCursor& cursor) {
+	float trackTime = CompactTrackHelpers::AdjustTimeToFitTrack(mTimes, time, looping);
+	int frame = CompactTrackHelpers::FrameIndex(mTimes, trackTime, cursor);
+	if (frame < 0) {
+		return T();
+	}
+	return Evaluate(frame, trackTime - mTimes[frame]);
+}
+
+#endif
@@ -81,14 +81,23 @@ void DebugDraw::FromPose(Pose& pose) {
 		requiredVerts += 2;
 	}
 
+	// Every joint's global position once, instead of once per line end
+	if (mJointPositions.size() != numJoints) {
+		mJointPositions.resize(numJoints);
+	}
+	for (unsigned int i = 0; i < numJoints; ++i) {
+		mJointPositions[i] = pose.GetGlobalTransform(i).position;
+	}
+
 	mPoints.clear();
 	mPoints.reserve(requiredVerts);
 	for (unsigned int i = 0; i < numJoints; ++i) {
-		if (pose.GetParent(i) < 0) {
+		int parent = pose.GetParent(i);
+		if (parent < 0) {
 			continue;
 		}
-		mPoints.push_back(pose.GetGlobalTransform(i).position);
-		mPoints.push_back(pose.GetGlobalTransform(pose.GetParent(i)).position);
+		mPoints.push_back(mJointPositions[i]);
+		mPoints.push_back(mJointPositions[parent]);
 	}
 }
 
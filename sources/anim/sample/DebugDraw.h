@@ -15,6 +15,7 @@ enum class DebugDrawMode {
 class DebugDraw {
 protected:
 	std::vector<vec3> mPoints;
+	std::vector<vec3> mJointPositions; // FromPose scratch, kept so it does not allocate per frame
 	Attribute<vec3>* mAttribs;
 	Shader* mShader;
 private:
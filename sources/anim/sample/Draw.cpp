@@ -34,7 +34,15 @@ void Draw(IndexBuffer& inIndexBuffer, DrawMode mode) {
 	unsigned int numIndices = inIndexBuffer.Count();
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle);
-	glDrawElements(DrawModeToGLEnum(mode), numIndices, GL_UNSIGNED_INT, 0);
+	glDrawElements(DrawModeToGLEnum(mode), numIndices, GL_UNSIGNED_INT, (void*)(size_t)inIndexBuffer.GetOffset());
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void Draw(IndexBuffer& inIndexBuffer, DrawMode mode, unsigned int firstIndex, unsigned int numIndices) {
+	unsigned int handle = inIndexBuffer.GetHandle();
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle);
+	glDrawElements(DrawModeToGLEnum(mode), numIndices, GL_UNSIGNED_INT, (void*)(inIndexBuffer.GetOffset() + sizeof(unsigned int) * firstIndex));
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
@@ -47,7 +55,7 @@ void DrawInstanced(IndexBuffer& inIndexBuffer, DrawMode mode, unsigned int insta
 	unsigned int numIndices = inIndexBuffer.Count();
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle);
-	glDrawElementsInstanced(DrawModeToGLEnum(mode), numIndices, GL_UNSIGNED_INT, 0, instanceCount);
+	glDrawElementsInstanced(DrawModeToGLEnum(mode), numIndices, GL_UNSIGNED_INT, (void*)(size_t)inIndexBuffer.GetOffset(), instanceCount);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
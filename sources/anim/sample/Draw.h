@@ -14,6 +14,7 @@ enum class DrawMode {
 };
 
 void Draw(IndexBuffer& inIndexBuffer, DrawMode mode);
+void Draw(IndexBuffer& inIndexBuffer, DrawMode mode, unsigned int firstIndex, unsigned int numIndices);
 void Draw(unsigned int vertexCount, DrawMode mode);
 
 void DrawInstanced(IndexBuffer& inIndexBuffer, DrawMode mode, unsigned int instanceCount);
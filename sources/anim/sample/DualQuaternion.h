@@ -0,0 +1,34 @@
+#ifndef _H_DUALQUATERNION_
+#define _H_DUALQUATERNION_
+
+#include "quat.h"
+#include "Transform.h"
+
+// Rotation and translation in 8 floats, real is the rotation and dual is half the
+// translation times the rotation. Scale is not represented, converting a Transform
+// drops it. An array of them has the layout of the mat2x4 array the dual quaternion
+// shader takes.
+struct DualQuaternion {
+	quat real;
+	quat dual;
+	inline DualQuaternion() : real(0, 0, 0, 1), dual(0, 0, 0, 0) { }
+	inline DualQuaternion(const quat& r, const quat& d) : real(r), dual(d) { }
+};
+
+DualQuaternion operator+(const DualQuaternion& l, const DualQuaternion& r);
+DualQuaternion operator*(const DualQuaternion& dq, float f);
+// Same order as quaternions and combine: l is applied first, then r. Both are expected
+// to be unit length, normalize blended dual quaternions before combining them
+DualQuaternion operator*(const DualQuaternion& l, const DualQuaternion& r);
+bool operator==(const DualQuaternion& l, const DualQuaternion& r);
+bool operator!=(const DualQuaternion& l, const DualQuaternion& r);
+float dot(const DualQuaternion& l, const DualQuaternion& r);
+DualQuaternion conjugate(const DualQuaternion& dq);
+DualQuaternion normalized(const DualQuaternion& dq);
+void normalize(DualQuaternion& dq);
+DualQuaternion transformToDualQuat(const Transform& t);
+Transform dualQuatToTransform(const DualQuaternion& dq);
+vec3 transformVector(const DualQuaternion& dq, const vec3& v);
+vec3 transformPoint(const DualQuaternion& dq, const vec3& v);
+
+#endif
@@ -1,4 +1,5 @@
 #include "GLTFLoader.h"
+#include "MeshOptimizer.h"
 #include <el_debug.h>
 #include <string.h>
 
@@ -28,23 +29,93 @@ namespace GLTFHelpers {
         return result;
     }
 
+    // cgltf keeps every node in one array, a node's index is its offset into it
     int GetNodeIndex(cgltf_node* target, cgltf_node* allNodes, unsigned int numNodes)
     {
-        if (target == nullptr) {
+        if (target == nullptr || target < allNodes || target >= allNodes + numNodes) {
             return -1;
         }
-        for (unsigned int i = 0; i < numNodes; ++i) {
-            if (target == &allNodes[i]) {
-                return (int)i;
-            }
+        return (int)(target - allNodes);
+    }
+
+    // Node index of each of the skin's joints, so a vertex's skin relative joint
+    // indices are looked up instead of searched for
+    void GetJointNodes(std::vector<int>& outNodes, cgltf_skin* skin, cgltf_node* nodes, unsigned int numNodes)
+    {
+        unsigned int numJoints = skin == nullptr ? 0 : (unsigned int)skin->joints_count;
+        outNodes.resize(numJoints);
+        for (unsigned int i = 0; i < numJoints; ++i) {
+            outNodes[i] = std::max(0, GetNodeIndex(skin->joints[i], nodes, numNodes));
+        }
+    }
+
+    // First element of the accessor's data, 0 if it is sparse or has no loaded buffer
+    const unsigned char* GetAccessorData(const cgltf_accessor& accessor)
+    {
+        if (accessor.is_sparse || accessor.buffer_view == nullptr || accessor.buffer_view->buffer->data == nullptr) {
+            return 0;
+        }
+        return (const unsigned char*)accessor.buffer_view->buffer->data + accessor.buffer_view->offset + accessor.offset;
+    }
+
+    // Reads every element of the accessor as inComponentCount floats into outValues.
+    // Float data with no gaps between elements is copied in one go, anything else is
+    // converted element by element
+    void ReadFloats(float* outValues, unsigned int inComponentCount, const cgltf_accessor& inAccessor)
+    {
+        const unsigned char* data = GetAccessorData(inAccessor);
+        cgltf_size elementSize = inComponentCount * sizeof(float);
+        if (data != 0 && inAccessor.component_type == cgltf_component_type_r_32f &&
+            cgltf_num_components(inAccessor.type) == inComponentCount && inAccessor.stride == elementSize) {
+            memcpy(outValues, data, inAccessor.count * elementSize);
+            return;
+        }
+        for (cgltf_size i = 0; i < inAccessor.count; ++i) {
+            cgltf_accessor_read_float(&inAccessor, i, &outValues[i * inComponentCount], inComponentCount);
         }
-        return -1;
     }
 
     void GetScalarValues(std::vector<float>& outScalars, unsigned int inComponentCount, const cgltf_accessor& inAccessor) {
         outScalars.resize(inAccessor.count * inComponentCount);
-        for (cgltf_size i = 0; i < inAccessor.count; ++i) {
-            cgltf_accessor_read_float(&inAccessor, i, &outScalars[i * inComponentCount], inComponentCount);
+        if (outScalars.size() > 0) {
+            ReadFloats(&outScalars[0], inComponentCount, inAccessor);
+        }
+    }
+
+    // Joint and index data is unsigned bytes, shorts or ints. Read straight from the
+    // buffer, cgltf_accessor_read_float would convert every component to float and back
+    void ReadUnsigned(unsigned int* outValues, unsigned int inComponentCount, const cgltf_accessor& inAccessor)
+    {
+        const unsigned char* data = GetAccessorData(inAccessor);
+        cgltf_component_type type = inAccessor.component_type;
+        unsigned int count = (unsigned int)inAccessor.count;
+        if (data == 0 || (type != cgltf_component_type_r_8u && type != cgltf_component_type_r_16u && type != cgltf_component_type_r_32u)) {
+            std::vector<float> values;
+            GetScalarValues(values, inComponentCount, inAccessor);
+            for (unsigned int i = 0, size = (unsigned int)values.size(); i < size; ++i) {
+                outValues[i] = (unsigned int)(values[i] + 0.5f); // Round, floats can't be trusted to be exact
+            }
+            return;
+        }
+        if (type == cgltf_component_type_r_32u && inAccessor.stride == inComponentCount * sizeof(unsigned int)) {
+            memcpy(outValues, data, count * inComponentCount * sizeof(unsigned int));
+            return;
+        }
+        for (unsigned int i = 0; i < count; ++i) {
+            const unsigned char* element = data + inAccessor.stride * i;
+            for (unsigned int c = 0; c < inComponentCount; ++c) {
+                if (type == cgltf_component_type_r_8u) {
+                    outValues[i * inComponentCount + c] = element[c];
+                }
+                else if (type == cgltf_component_type_r_16u) {
+                    unsigned short value;
+                    memcpy(&value, element + c * sizeof(unsigned short), sizeof(unsigned short));
+                    outValues[i * inComponentCount + c] = value;
+                }
+                else {
+                    memcpy(&outValues[i * inComponentCount + c], element + c * sizeof(unsigned int), sizeof(unsigned int));
+                }
+            }
         }
     }
 
@@ -92,76 +163,163 @@ namespace GLTFHelpers {
         }
     }
 
-    void MeshFromAttribute(Mesh& outMesh, cgltf_attribute& attribute, cgltf_skin* skin, cgltf_node* nodes, unsigned int nodeCount)
+    void MeshFromAttribute(Mesh& outMesh, cgltf_attribute& attribute, const std::vector<int>& jointNodes)
     {
         cgltf_attribute_type attribType = attribute.type;
         cgltf_accessor& accessor = *attribute.data;
+        unsigned int acessorCount = (unsigned int)accessor.count;
+        if (acessorCount == 0) {
+            return;
+        }
 
-        unsigned int componentCount = 0;
-        if (accessor.type == cgltf_type_vec2) {
-            componentCount = 2;
+        // Every attribute is read straight into its (resized) destination array
+        switch (attribType) {
+        case cgltf_attribute_type_position:
+        {
+            std::vector<vec3>& positions = outMesh.GetPosition();
+            positions.resize(acessorCount);
+            ReadFloats(positions[0].v, 3, accessor);
         }
-        else if (accessor.type == cgltf_type_vec3) {
-            componentCount = 3;
+        break;
+        case cgltf_attribute_type_texcoord:
+        {
+            std::vector<vec2>& texCoords = outMesh.GetTexCoord();
+            texCoords.resize(acessorCount);
+            ReadFloats(texCoords[0].v, 2, accessor);
         }
-        else if (accessor.type == cgltf_type_vec4) {
-            componentCount = 4;
+        break;
+        case cgltf_attribute_type_weights:
+        {
+            std::vector<vec4>& weights = outMesh.GetWeights();
+            weights.resize(acessorCount);
+            ReadFloats(weights[0].v, 4, accessor);
         }
-
-        std::vector<float> values;
-        GetScalarValues(values, componentCount, accessor);
-        unsigned int acessorCount = (unsigned int)accessor.count;
-
-        std::vector<vec3>& positions = outMesh.GetPosition();
-        std::vector<vec3>& normals = outMesh.GetNormal();
-        std::vector<vec2>& texCoords = outMesh.GetTexCoord();
-        std::vector<ivec4>& influences = outMesh.GetInfluences();
-        std::vector<vec4>& weights = outMesh.GetWeights();
-
-        for (unsigned int i = 0; i < acessorCount; ++i) {
-            int index = i * componentCount;
-            switch (attribType) {
-            case cgltf_attribute_type_position:
-                positions.push_back(vec3(values[index + 0], values[index + 1], values[index + 2]));
-                break;
-            case cgltf_attribute_type_texcoord:
-                texCoords.push_back(vec2(values[index + 0], values[index + 1]));
-                break;
-            case cgltf_attribute_type_weights:
-                weights.push_back(vec4(values[index + 0], values[index + 1], values[index + 2], values[index + 3]));
-                break;
-            case cgltf_attribute_type_normal:
-            {
-                vec3 normal = vec3(values[index + 0], values[index + 1], values[index + 2]);
+        break;
+        case cgltf_attribute_type_normal:
+        {
+            std::vector<vec3>& normals = outMesh.GetNormal();
+            normals.resize(acessorCount);
+            ReadFloats(normals[0].v, 3, accessor);
+            for (unsigned int i = 0; i < acessorCount; ++i) {
+                vec3 normal = normals[i];
                 if (lenSq(normal) < 0.000001f) {
                     normal = vec3(0, 1, 0);
                 }
-                normals.push_back(normalized(normal));
+                normals[i] = normalized(normal);
             }
-            break;
-            case cgltf_attribute_type_joints:
-            {
-                // These indices are skin relative. This function has no information about the
-                // skin that is being parsed. Add +0.5f to round, since we can't read ints
-                ivec4 joints(
-                    (int)(values[index + 0] + 0.5f),
-                    (int)(values[index + 1] + 0.5f),
-                    (int)(values[index + 2] + 0.5f),
-                    (int)(values[index + 3] + 0.5f)
-                );
-
-                joints.x = std::max(0, GetNodeIndex(skin->joints[joints.x], nodes, nodeCount));
-                joints.y = std::max(0, GetNodeIndex(skin->joints[joints.y], nodes, nodeCount));
-                joints.z = std::max(0, GetNodeIndex(skin->joints[joints.z], nodes, nodeCount));
-                joints.w = std::max(0, GetNodeIndex(skin->joints[joints.w], nodes, nodeCount));
-
-                influences.push_back(joints);
+        }
+        break;
+        case cgltf_attribute_type_joints:
+        {
+            // These indices are skin relative, jointNodes maps them to node indices
+            std::vector<ivec4>& influences = outMesh.GetInfluences();
+            influences.resize(acessorCount);
+            ReadUnsigned((unsigned int*)influences[0].v, 4, accessor);
+            unsigned int numJoints = (unsigned int)jointNodes.size();
+            for (unsigned int i = 0; i < acessorCount; ++i) {
+                ivec4& joints = influences[i];
+                for (unsigned int c = 0; c < 4; ++c) {
+                    joints.v[c] = (unsigned int)joints.v[c] < numJoints ? jointNodes[joints.v[c]] : 0;
+                }
             }
-            break;
-            } // End switch statement
         }
+        break;
+        default:
+            break;
+        } // End switch statement
     }// End of MeshFromAttribute function
 
+    // Decodes and vertex cache optimizes one primitive. Fills the mesh's arrays without
+    // touching its GL objects, so any thread can run it
+    void MeshFromPrimitive(Mesh& outMesh, cgltf_primitive& primitive, cgltf_skin* skin, cgltf_node* nodes, unsigned int nodeCount)
+    {
+        std::vector<int> jointNodes;
+        GetJointNodes(jointNodes, skin, nodes, nodeCount);
+
+        unsigned int numAttributes = (unsigned int)primitive.attributes_count;
+        for (unsigned int k = 0; k < numAttributes; ++k) {
+            MeshFromAttribute(outMesh, primitive.attributes[k], jointNodes);
+        }
+        if (primitive.indices != 0 && primitive.indices->count > 0) {
+            std::vector<unsigned int>& indices = outMesh.GetIndices();
+            indices.resize(primitive.indices->count);
+            ReadUnsigned(&indices[0], 1, *primitive.indices);
+        }
+        OptimizeVertexCache(outMesh, "LoadMeshes");
+    }
+
+    // Every primitive of every skinned node, in the order LoadMeshes returns them
+    void GetSkinnedPrimitives(std::vector<cgltf_node*>& outNodes, std::vector<cgltf_primitive*>& outPrimitives, cgltf_data* data)
+    {
+        outNodes.clear();
+        outPrimitives.clear();
+        for (unsigned int i = 0, nodeCount = (unsigned int)data->nodes_count; i < nodeCount; ++i) {
+            cgltf_node* node = &data->nodes[i];
+            if (node->mesh == nullptr || node->skin == nullptr) {
+                continue;
+            }
+            for (unsigned int j = 0, numPrims = (unsigned int)node->mesh->primitives_count; j < numPrims; ++j) {
+                outNodes.push_back(node);
+                outPrimitives.push_back(&node->mesh->primitives[j]);
+            }
+        }
+    }
+
+    void ClipFromAnimation(Clip& outClip, cgltf_animation& animation, cgltf_data* data)
+    {
+        unsigned int numNodes = (unsigned int)data->nodes_count;
+        outClip.SetName(animation.name);
+
+        unsigned int numChannels = (unsigned int)animation.channels_count;
+        for (unsigned int j = 0; j < numChannels; ++j) {
+            cgltf_animation_channel& channel = animation.channels[j];
+            cgltf_node* target = channel.target_node;
+            int nodeId = GetNodeIndex(target, data->nodes, numNodes);
+            if (channel.target_path == cgltf_animation_path_type_translation) {
+                VectorTrack& track = outClip[nodeId].GetPositionTrack();
+                TrackFromChannel<vec3, 3>(track, channel);
+            }
+            else if (channel.target_path == cgltf_animation_path_type_scale) {
+                VectorTrack& track = outClip[nodeId].GetScaleTrack();
+                TrackFromChannel<vec3, 3>(track, channel);
+            }
+            else if (channel.target_path == cgltf_animation_path_type_rotation) {
+                QuaternionTrack& track = outClip[nodeId].GetRotationTrack();
+                TrackFromChannel<quat, 4>(track, channel);
+            }
+        }
+        outClip.RecalculateDuration();
+    }
+
+    // LoadGLTFParallel's jobs: one per mesh, then the skeleton, then one per clip.
+    // Every job writes only its own output
+    struct ImportJobs {
+        cgltf_data* mData;
+        cgltf_node** mNodes;
+        cgltf_primitive** mPrimitives;
+        Mesh* mMeshes;
+        unsigned int mNumMeshes;
+        Skeleton* mSkeleton;
+        Clip* mClips;
+    };
+
+    void ImportJob(void* context, unsigned int index)
+    {
+        ImportJobs& jobs = *(ImportJobs*)context;
+        cgltf_data* data = jobs.mData;
+        if (index < jobs.mNumMeshes) {
+            MeshFromPrimitive(jobs.mMeshes[index], *jobs.mPrimitives[index], jobs.mNodes[index]->skin,
+                data->nodes, (unsigned int)data->nodes_count);
+        }
+        else if (index == jobs.mNumMeshes) {
+            *jobs.mSkeleton = LoadSkeleton(data);
+        }
+        else {
+            unsigned int clip = index - jobs.mNumMeshes - 1;
+            ClipFromAnimation(jobs.mClips[clip], data->animations[clip], data);
+        }
+    }
+
 } // End of GLTFHelpers
 
 cgltf_data* LoadGLTFFile(const char* path)
@@ -299,33 +457,12 @@ std::vector<std::string> LoadJointNames(cgltf_data* data)
 std::vector<Clip> LoadAnimationClips(cgltf_data* data) 
 {
     unsigned int numClips = (unsigned int)data->animations_count;
-    unsigned int numNodes = (unsigned int)data->nodes_count;
 
     std::vector<Clip> result;
     result.resize(numClips);
 
     for (unsigned int i = 0; i < numClips; ++i) {
-        result[i].SetName(data->animations[i].name);
-
-        unsigned int numChannels = (unsigned int)data->animations[i].channels_count;
-        for (unsigned int j = 0; j < numChannels; ++j) {
-            cgltf_animation_channel& channel = data->animations[i].channels[j];
-            cgltf_node* target = channel.target_node;
-            int nodeId = GLTFHelpers::GetNodeIndex(target, data->nodes, numNodes);
-            if (channel.target_path == cgltf_animation_path_type_translation) {
-                VectorTrack& track = result[i][nodeId].GetPositionTrack();
-                GLTFHelpers::TrackFromChannel<vec3, 3>(track, channel);
-            }
-            else if (channel.target_path == cgltf_animation_path_type_scale) {
-                VectorTrack& track = result[i][nodeId].GetScaleTrack();
-                GLTFHelpers::TrackFromChannel<vec3, 3>(track, channel);
-            }
-            else if (channel.target_path == cgltf_animation_path_type_rotation) {
-                QuaternionTrack& track = result[i][nodeId].GetRotationTrack();
-                GLTFHelpers::TrackFromChannel<quat, 4>(track, channel);
-            }
-        }
-        result[i].RecalculateDuration();
+        GLTFHelpers::ClipFromAnimation(result[i], data->animations[i], data);
     } 
 
     return result;
@@ -333,38 +470,42 @@ std::vector<Clip> LoadAnimationClips(cgltf_data* data)
 
 std::vector<Mesh> LoadMeshes(cgltf_data* data) 
 {
-    std::vector<Mesh> result;
-    cgltf_node* nodes = data->nodes;
-    unsigned int nodeCount = (unsigned int)data->nodes_count;
+    std::vector<cgltf_node*> nodes;
+    std::vector<cgltf_primitive*> primitives;
+    GLTFHelpers::GetSkinnedPrimitives(nodes, primitives, data);
 
-    for (unsigned int i = 0; i < nodeCount; ++i) {
-        cgltf_node* node = &nodes[i];
-        if (node->mesh == nullptr || node->skin == nullptr) {
-            continue;
-        }
-        unsigned int numPrims = (unsigned int)node->mesh->primitives_count;
-        for (unsigned int j = 0; j < numPrims; ++j) {
-            result.push_back(Mesh());
-            Mesh& mesh = result[result.size() - 1];
+    std::vector<Mesh> result;
+    result.resize(primitives.size());
+    for (unsigned int i = 0, size = (unsigned int)primitives.size(); i < size; ++i) {
+        GLTFHelpers::MeshFromPrimitive(result[i], *primitives[i], nodes[i]->skin, data->nodes, (unsigned int)data->nodes_count);
+        result[i].UpdateOpenGLBuffers();
+    }
+    return result;
+} // End of the LoadMeshes function
 
-            cgltf_primitive* primitive = &node->mesh->primitives[j];
+void LoadGLTFParallel(cgltf_data* data, std::vector<Mesh>& outMeshes, Skeleton& outSkeleton,
+    std::vector<Clip>& outClips, WorkerPool& pool)
+{
+    std::vector<cgltf_node*> nodes;
+    std::vector<cgltf_primitive*> primitives;
+    GLTFHelpers::GetSkinnedPrimitives(nodes, primitives, data);
 
-            unsigned int numAttributes = (unsigned int)primitive->attributes_count;
-            for (unsigned int k = 0; k < numAttributes; ++k) {
-                cgltf_attribute* attribute = &primitive->attributes[k];
-                GLTFHelpers::MeshFromAttribute(mesh, *attribute, node->skin, nodes, nodeCount);
-            }
-            if (primitive->indices != 0) {
-                unsigned int indexCount = (unsigned int)primitive->indices->count;
-                std::vector<unsigned int>& indices = mesh.GetIndices();
-                indices.resize(indexCount);
+    // Created here, on the calling thread, since a mesh's constructor makes its buffers
+    unsigned int numMeshes = (unsigned int)primitives.size();
+    unsigned int numClips = (unsigned int)data->animations_count;
+    outMeshes.clear();
+    outMeshes.resize(numMeshes);
+    outClips.clear();
+    outClips.resize(numClips);
+
+    GLTFHelpers::ImportJobs jobs = { data, nodes.data(), primitives.data(), outMeshes.data(),
+        numMeshes, &outSkeleton, outClips.data() };
+    pool.Run(GLTFHelpers::ImportJob, &jobs, numMeshes + 1 + numClips);
+}
 
-                for (unsigned int k = 0; k < indexCount; ++k) {
-                    indices[k] = (unsigned int)cgltf_accessor_read_index(primitive->indices, k);
-                }
-            }
-            mesh.UpdateOpenGLBuffers();
-        }
+void UploadMeshes(std::vector<Mesh>& meshes)
+{
+    for (unsigned int i = 0, size = (unsigned int)meshes.size(); i < size; ++i) {
+        meshes[i].UpdateOpenGLBuffers();
     }
-    return result;
-} // End of the LoadMeshes function
+}
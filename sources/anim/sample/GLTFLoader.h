@@ -9,6 +9,7 @@
 #include "Clip.h"
 #include "Skeleton.h"
 #include "Mesh.h"
+#include "WorkerPool.h"
 
 cgltf_data* LoadGLTFFile(const char* path);
 void FreeGLTFFile(cgltf_data* handle);
@@ -21,4 +22,14 @@ std::vector<Clip> LoadAnimationClips(cgltf_data* data);
 std::vector<Mesh> LoadMeshes(cgltf_data* data);
 std::vector<Mesh> LoadStaticMeshes(cgltf_data* data);
 
+// The skinned meshes, skeleton and clips of data decoded at once, each mesh primitive
+// and each animation a job on pool (the calling thread works too). Call it from the
+// thread that owns the GL context, it creates the meshes and the workers only fill in
+// their arrays. The meshes come back vertex cache optimized but not uploaded, call
+// UploadMeshes after any further CPU side processing.
+void LoadGLTFParallel(cgltf_data* data, std::vector<Mesh>& outMeshes, Skeleton& outSkeleton,
+    std::vector<Clip>& outClips, WorkerPool& pool);
+// Creates the GL buffers of meshes, on the GL thread
+void UploadMeshes(std::vector<Mesh>& meshes);
+
 #endif // _H_GLTFLOADER_
@@ -1,16 +1,49 @@
 #include "IndexBuffer.h"
 #include <glad/glad.h>
+#include <cstring>
 
 IndexBuffer::IndexBuffer() {
 	glGenBuffers(1, &mHandle);
 	mCount = 0;
+	mStream = 0;
 }
 
 IndexBuffer::~IndexBuffer() {
+	delete mStream;
 	glDeleteBuffers(1, &mHandle);
 }
 
+void IndexBuffer::SetStreaming(bool streaming) {
+	if (streaming && mStream == 0) {
+		mStream = new StreamRing(GL_ELEMENT_ARRAY_BUFFER);
+	}
+	else if (!streaming && mStream != 0) {
+		delete mStream;
+		mStream = 0;
+		mCount = 0;
+	}
+}
+
+bool IndexBuffer::IsStreaming() {
+	return mStream != 0;
+}
+
+unsigned int* IndexBuffer::Map(unsigned int arrayLength) {
+	mCount = arrayLength;
+	return (unsigned int*)mStream->Map(sizeof(unsigned int) * arrayLength);
+}
+
+void IndexBuffer::Unmap() {
+	mStream->Unmap();
+}
+
 void IndexBuffer::Set(unsigned int* inputArray, unsigned int arrayLengt) {
+	if (mStream != 0) {
+		memcpy(Map(arrayLengt), inputArray, sizeof(unsigned int) * arrayLengt);
+		Unmap();
+		return;
+	}
+
 	mCount = arrayLengt;
 	unsigned int size = sizeof(unsigned int);
 
@@ -28,5 +61,9 @@ unsigned int IndexBuffer::Count() {
 }
 
 unsigned int IndexBuffer::GetHandle() {
-	return mHandle;
+	return mStream != 0 ? mStream->GetHandle() : mHandle;
+}
+
+unsigned int IndexBuffer::GetOffset() {
+	return mStream != 0 ? mStream->GetOffset() : 0;
 }
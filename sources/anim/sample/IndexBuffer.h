@@ -2,11 +2,13 @@
 #define _H_INDEXBUFFER_
 
 #include <vector>
+#include "StreamRing.h"
 
 class IndexBuffer {
 public:
 	unsigned int mHandle;
 	unsigned int mCount;
+	StreamRing* mStream; // Set when streaming, see Attribute::SetStreaming
 private:
 	IndexBuffer(const IndexBuffer& other);
 	IndexBuffer& operator=(const IndexBuffer& other);
@@ -17,8 +19,16 @@ public:
 	void Set(unsigned int* inputArray, unsigned int arrayLengt);
 	void Set(std::vector<unsigned int>& input);
 
+	void SetStreaming(bool streaming);
+	bool IsStreaming();
+	// Streaming only, room for arrayLength indices. Write only, Unmap before drawing.
+	unsigned int* Map(unsigned int arrayLength);
+	void Unmap();
+
 	unsigned int Count();
 	unsigned int GetHandle();
+	// Byte offset of the indices in GetHandle's buffer
+	unsigned int GetOffset();
 };
 
 #endif
\ No newline at end of file
@@ -1,6 +1,197 @@
 #include "Mesh.h"
 #include "Draw.h"
 #include "Transform.h"
+#include "SIMD.h"
+#include "Uniform.h"
+#include <cstring>
+#include <cstddef>
+
+namespace MeshHelpers {
+	// Skin matrix of a vertex with N influences. The weights of a rigid vertex are
+	// normalized by SortByInfluenceCount, so its matrix is used as is
+	template<unsigned int N>
+	inline mat4 SkinMatrix(const std::vector<mat4>& skinPalette, const ivec4& j, const vec4& w) {
+		if (N == 1) {
+			return skinPalette[j.x];
+		}
+		mat4 skin = skinPalette[j.x] * w.x + skinPalette[j.y] * w.y;
+		if (N > 2) {
+			skin = skin + skinPalette[j.z] * w.z;
+		}
+		if (N > 3) {
+			skin = skin + skinPalette[j.w] * w.w;
+		}
+		return skin;
+	}
+
+	template<unsigned int N>
+	inline void SkinVertices(const std::vector<mat4>& skinPalette, const vec3* position, const vec3* normal,
+		const vec4* weights, const ivec4* influences, vec3* outPosition, vec3* outNormal, unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			mat4 skin = SkinMatrix<N>(skinPalette, influences[i], weights[i]);
+			outPosition[i] = transformPoint(skin, position[i]);
+			outNormal[i] = transformVector(skin, normal[i]);
+		}
+	}
+
+	// Blends N dual quaternions, flipping the ones facing away from the first so the
+	// blend takes the short way around
+	template<unsigned int N>
+	inline DualQuaternion SkinDualQuaternion(const std::vector<DualQuaternion>& skinPalette, const ivec4& j, const vec4& w) {
+		const DualQuaternion& first = skinPalette[j.x];
+		if (N == 1) {
+			return first;
+		}
+		int joints[4] = { j.x, j.y, j.z, j.w };
+		float weights[4] = { w.x, w.y, w.z, w.w };
+		DualQuaternion result = first * weights[0];
+		for (unsigned int k = 1; k < N; ++k) {
+			const DualQuaternion& dq = skinPalette[joints[k]];
+			result = result + dq * (dot(first, dq) < 0.0f ? -weights[k] : weights[k]);
+		}
+		return normalized(result);
+	}
+
+	template<unsigned int N>
+	inline void SkinVertices(const std::vector<DualQuaternion>& skinPalette, const vec3* position, const vec3* normal,
+		const vec4* weights, const ivec4* influences, vec3* outPosition, vec3* outNormal, unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			DualQuaternion skin = SkinDualQuaternion<N>(skinPalette, influences[i], weights[i]);
+			outPosition[i] = transformPoint(skin, position[i]);
+			outNormal[i] = transformVector(skin, normal[i]);
+		}
+	}
+
+	template<unsigned int N>
+	inline mat4 SkinBlend(const std::vector<mat4>& skinPalette, const ivec4& j, const vec4& w) {
+		return SkinMatrix<N>(skinPalette, j, w);
+	}
+
+	template<unsigned int N>
+	inline DualQuaternion SkinBlend(const std::vector<DualQuaternion>& skinPalette, const ivec4& j, const vec4& w) {
+		return SkinDualQuaternion<N>(skinPalette, j, w);
+	}
+
+	// Decodes each compact vertex as it is skinned, the float vertex data is not read
+	template<unsigned int N, typename T>
+	inline void SkinCompactVertices(const std::vector<T>& skinPalette, const CompactVertex* vertices, const vec3& min,
+		const vec3& extent, vec3* outPosition, vec3* outNormal, unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			const CompactVertex& vertex = vertices[i];
+			T skin = SkinBlend<N>(skinPalette, decodeJoints(vertex), decodeWeights(vertex));
+			outPosition[i] = transformPoint(skin, decodePosition(vertex, min, extent));
+			outNormal[i] = transformVector(skin, decodeNormal(vertex));
+		}
+	}
+
+	template<typename T>
+	inline void SkinCompactGroups(const std::vector<T>& skinPalette, const CompactVertex* vertices, const vec3& min,
+		const vec3& extent, vec3* outPosition, vec3* outNormal, const unsigned int* groups) {
+		SkinCompactVertices<1>(skinPalette, vertices, min, extent, outPosition, outNormal, groups[0], groups[1]);
+		SkinCompactVertices<2>(skinPalette, vertices, min, extent, outPosition, outNormal, groups[1], groups[2]);
+		SkinCompactVertices<3>(skinPalette, vertices, min, extent, outPosition, outNormal, groups[2], groups[3]);
+		SkinCompactVertices<4>(skinPalette, vertices, min, extent, outPosition, outNormal, groups[3], groups[4]);
+	}
+
+	// Blended real and dual parts of SIMD_WIDTH vertices, not normalized. The joint
+	// streams hold mat4 offsets, a dual quaternion is half as far into its palette
+	template<unsigned int N>
+	inline void SkinDualQuaternionSIMD(const float* palette, const float* weights, const int* joints, unsigned int padded, simdf* real, simdf* dual) {
+		simdf first[4];
+		for (unsigned int k = 0; k < N; ++k) {
+			int offsets[SIMD_WIDTH];
+			for (unsigned int lane = 0; lane < SIMD_WIDTH; ++lane) {
+				offsets[lane] = joints[k * padded + lane] >> 1;
+			}
+			simdf r[4];
+			simdf d[4];
+			simdLoadTransposed(palette, offsets, r);
+			simdLoadTransposed(palette + 4, offsets, d);
+			if (N == 1) {
+				for (unsigned int c = 0; c < 4; ++c) {
+					real[c] = r[c];
+					dual[c] = d[c];
+				}
+				return;
+			}
+
+			simdf w = simdLoad(weights + k * padded);
+			if (k == 0) {
+				for (unsigned int c = 0; c < 4; ++c) {
+					first[c] = r[c];
+					real[c] = simdMul(r[c], w);
+					dual[c] = simdMul(d[c], w);
+				}
+			}
+			else {
+				w = simdFlipSign(w, simdDot4(first, r));
+				for (unsigned int c = 0; c < 4; ++c) {
+					real[c] = simdMadd(r[c], w, real[c]);
+					dual[c] = simdMadd(d[c], w, dual[c]);
+				}
+			}
+		}
+	}
+
+	// Attributes a mesh does not have are empty and stay that way
+	template<typename T>
+	inline void Reorder(std::vector<T>& values, const std::vector<unsigned int>& order) {
+		if (values.size() != order.size()) {
+			return;
+		}
+		std::vector<T> result(values.size());
+		for (unsigned int i = 0, size = (unsigned int)order.size(); i < size; ++i) {
+			result[i] = values[order[i]];
+		}
+		values = result;
+	}
+
+	// The 12 affine components of SIMD_WIDTH skin matrices with N influences each,
+	// weights and joints point at the block in the first weight and joint streams
+	template<unsigned int N>
+	inline void SkinMatrixSIMD(const float* palette, const float* weights, const int* joints, unsigned int padded, simdf* m) {
+		for (unsigned int k = 0; k < N; ++k) {
+			simdf w = simdLoad(weights + k * padded);
+			for (unsigned int column = 0; column < 4; ++column) {
+				simdf rows[4];
+				simdLoadTransposed(palette + column * 4, joints + k * padded, rows);
+				for (unsigned int row = 0; row < 3; ++row) {
+					simdf& out = m[column * 3 + row];
+					out = N == 1 ? rows[row] : (k == 0 ? simdMul(rows[row], w) : simdMadd(rows[row], w, out));
+				}
+			}
+		}
+	}
+
+	struct SkinJobs {
+		Mesh* mMeshes;
+		unsigned int mNumMeshes;
+		const std::vector<mat4>* mSkinPalette;
+	};
+
+	inline unsigned int NumChunks(unsigned int numVerts) {
+		return (numVerts + SKIN_CHUNK_SIZE - 1) / SKIN_CHUNK_SIZE;
+	}
+
+	// A handful of meshes per character, walking them is cheaper than a job table
+	// and keeps the batch free of allocations
+	void SkinChunk(void* context, unsigned int index) {
+		SkinJobs* jobs = (SkinJobs*)context;
+		for (unsigned int i = 0; i < jobs->mNumMeshes; ++i) {
+			Mesh& mesh = jobs->mMeshes[i];
+			unsigned int numVerts = (unsigned int)mesh.GetPosition().size();
+			unsigned int numChunks = NumChunks(numVerts);
+			if (index < numChunks) {
+				unsigned int begin = index * SKIN_CHUNK_SIZE;
+				mesh.CPUSkinRange(*jobs->mSkinPalette, begin, begin + SKIN_CHUNK_SIZE);
+				return;
+			}
+			index -= numChunks;
+		}
+	}
+} // End MeshHelpers namespace
+
+unsigned int Mesh::sDefaultVertexArray = 0;
 
 Mesh::Mesh() {
 	mPosAttrib = new Attribute<vec3>();
@@ -9,6 +200,15 @@ Mesh::Mesh() {
 	mWeightAttrib = new Attribute<vec4>();
 	mInfluenceAttrib = new Attribute<ivec4>();
 	mIndexBuffer = new IndexBuffer();
+	mSkinStreamSize = 0;
+	ResetInfluenceGroups();
+	mSkinPositionOut = 0;
+	mSkinNormalOut = 0;
+	mSkinnedOnCPU = false;
+	mInterleaved = false;
+	mVertexBuffer = 0;
+	mVertexStride = 0;
+	mCompact = false;
 }
 
 Mesh::Mesh(const Mesh& other) {
@@ -18,6 +218,15 @@ Mesh::Mesh(const Mesh& other) {
 	mWeightAttrib = new Attribute<vec4>();
 	mInfluenceAttrib = new Attribute<ivec4>();
 	mIndexBuffer = new IndexBuffer();
+	mSkinStreamSize = 0;
+	ResetInfluenceGroups();
+	mSkinPositionOut = 0;
+	mSkinNormalOut = 0;
+	mSkinnedOnCPU = false;
+	mInterleaved = false;
+	mVertexBuffer = 0;
+	mVertexStride = 0;
+	mCompact = false;
 	*this = other;
 }
 
@@ -31,11 +240,22 @@ Mesh& Mesh::operator=(const Mesh& other) {
 	mWeights = other.mWeights;
 	mInfluences = other.mInfluences;
 	mIndices = other.mIndices;
+	for (unsigned int i = 0; i < 5; ++i) {
+		mInfluenceVertices[i] = other.mInfluenceVertices[i];
+		mInfluenceIndices[i] = other.mInfluenceIndices[i];
+	}
+	SetStreamingSkin(other.mPosAttrib->IsStreaming());
+	mInterleaved = other.mInterleaved;
+	mCompact = other.mCompact;
 	UpdateOpenGLBuffers();
 	return *this;
 }
 
 Mesh::~Mesh() {
+	ClearVertexArrays();
+	if (mVertexBuffer != 0) {
+		glDeleteBuffers(1, &mVertexBuffer);
+	}
 	delete mPosAttrib;
 	delete mNormAttrib;
 	delete mUvAttrib;
@@ -68,7 +288,361 @@ std::vector<unsigned int>& Mesh::GetIndices() {
 	return mIndices;
 }
 
+std::vector<vec3>& Mesh::GetSkinnedPosition() {
+	return mSkinnedPosition;
+}
+
+std::vector<vec3>& Mesh::GetSkinnedNormal() {
+	return mSkinnedNormal;
+}
+
+void Mesh::ResetInfluenceGroups() {
+	for (unsigned int i = 0; i < 4; ++i) {
+		mInfluenceVertices[i] = 0;
+		mInfluenceIndices[i] = 0;
+	}
+	mInfluenceVertices[4] = (unsigned int)mPosition.size();
+	mInfluenceIndices[4] = (unsigned int)mIndices.size();
+}
+
+unsigned int Mesh::GetInfluenceVertexOffset(unsigned int numInfluences) {
+	return numInfluences >= 1 && numInfluences <= 4 ? mInfluenceVertices[numInfluences - 1] : 0;
+}
+
+unsigned int Mesh::GetInfluenceVertexCount(unsigned int numInfluences) {
+	return numInfluences >= 1 && numInfluences <= 4 ?
+		mInfluenceVertices[numInfluences] - mInfluenceVertices[numInfluences - 1] : 0;
+}
+
+unsigned int Mesh::GetInfluenceIndexOffset(unsigned int numInfluences) {
+	return numInfluences >= 1 && numInfluences <= 4 ? mInfluenceIndices[numInfluences - 1] : 0;
+}
+
+unsigned int Mesh::GetInfluenceIndexCount(unsigned int numInfluences) {
+	return numInfluences >= 1 && numInfluences <= 4 ?
+		mInfluenceIndices[numInfluences] - mInfluenceIndices[numInfluences - 1] : 0;
+}
+
+void Mesh::SortByInfluenceCount() {
+	unsigned int numVerts = (unsigned int)mPosition.size();
+	unsigned int numIndices = (unsigned int)mIndices.size();
+	if (numVerts == 0 || numIndices == 0 || mWeights.size() != numVerts || mInfluences.size() != numVerts) {
+		ResetInfluenceGroups();
+		return;
+	}
+
+	// Move the non zero weights to the front, a vertex without any is bound rigidly
+	std::vector<unsigned int> counts(numVerts);
+	unsigned int groupSize[5] = { 0, 0, 0, 0, 0 };
+	for (unsigned int i = 0; i < numVerts; ++i) {
+		vec4 weights = mWeights[i];
+		ivec4 joints = mInfluences[i];
+		float inWeights[4] = { weights.x, weights.y, weights.z, weights.w };
+		int inJoints[4] = { joints.x, joints.y, joints.z, joints.w };
+		float outWeights[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		int outJoints[4] = { 0, 0, 0, 0 };
+		unsigned int count = 0;
+		for (unsigned int k = 0; k < 4; ++k) {
+			if (inWeights[k] > 0.0f) {
+				outWeights[count] = inWeights[k];
+				outJoints[count] = inJoints[k];
+				count += 1;
+			}
+		}
+		if (count <= 1) {
+			outWeights[0] = 1.0f;
+			count = 1;
+		}
+		mWeights[i] = vec4(outWeights[0], outWeights[1], outWeights[2], outWeights[3]);
+		mInfluences[i] = ivec4(outJoints[0], outJoints[1], outJoints[2], outJoints[3]);
+		counts[i] = count;
+		groupSize[count] += 1;
+	}
+
+	// Stable counting sort of the vertices, order keeps their relative order in a group
+	unsigned int next[5] = { 0, 0, 0, 0, 0 };
+	mInfluenceVertices[0] = 0;
+	for (unsigned int n = 1; n <= 4; ++n) {
+		next[n] = mInfluenceVertices[n - 1];
+		mInfluenceVertices[n] = mInfluenceVertices[n - 1] + groupSize[n];
+	}
+	std::vector<unsigned int> remap(numVerts);
+	std::vector<unsigned int> order(numVerts);
+	for (unsigned int i = 0; i < numVerts; ++i) {
+		remap[i] = next[counts[i]]++;
+		order[remap[i]] = i;
+	}
+	MeshHelpers::Reorder(mPosition, order);
+	MeshHelpers::Reorder(mNormal, order);
+	MeshHelpers::Reorder(mTexCoord, order);
+	MeshHelpers::Reorder(mWeights, order);
+	MeshHelpers::Reorder(mInfluences, order);
+
+	// Triangles go to the group of their most influenced vertex, again stable
+	unsigned int numTriangles = numIndices / 3;
+	std::vector<unsigned int> triangleCounts(numTriangles);
+	unsigned int triangleGroupSize[5] = { 0, 0, 0, 0, 0 };
+	for (unsigned int t = 0; t < numTriangles; ++t) {
+		unsigned int count = 1;
+		for (unsigned int v = 0; v < 3; ++v) {
+			unsigned int c = counts[mIndices[t * 3 + v]];
+			count = c > count ? c : count;
+		}
+		triangleCounts[t] = count;
+		triangleGroupSize[count] += 1;
+	}
+	mInfluenceIndices[0] = 0;
+	for (unsigned int n = 1; n <= 4; ++n) {
+		next[n] = mInfluenceIndices[n - 1];
+		mInfluenceIndices[n] = mInfluenceIndices[n - 1] + triangleGroupSize[n] * 3;
+	}
+	mInfluenceIndices[4] = numIndices; // Keeps a trailing partial triangle, as Draw does
+	std::vector<unsigned int> indices(numIndices);
+	for (unsigned int t = 0; t < numTriangles; ++t) {
+		unsigned int first = next[triangleCounts[t]];
+		next[triangleCounts[t]] += 3;
+		for (unsigned int v = 0; v < 3; ++v) {
+			indices[first + v] = remap[mIndices[t * 3 + v]];
+		}
+	}
+	for (unsigned int i = numTriangles * 3; i < numIndices; ++i) {
+		indices[i] = remap[mIndices[i]];
+	}
+	mIndices = indices;
+	UpdateOpenGLBuffers();
+}
+
+void Mesh::SetInterleaved(bool interleaved) {
+	mInterleaved = interleaved;
+	if (!interleaved) {
+		mCompact = false;
+		mCompactVertices.clear();
+		ClearVertexArrays();
+		if (mVertexBuffer != 0) {
+			glDeleteBuffers(1, &mVertexBuffer);
+			mVertexBuffer = 0;
+		}
+	}
+	UpdateOpenGLBuffers();
+}
+
+bool Mesh::IsInterleaved() {
+	return mInterleaved;
+}
+
+void Mesh::SetDefaultVertexArray(unsigned int vertexArray) {
+	sDefaultVertexArray = vertexArray;
+}
+
+bool Mesh::SetCompact(bool compact) {
+	if (!compact) {
+		mCompact = false;
+		mCompactVertices.clear();
+		UpdateOpenGLBuffers();
+		return true;
+	}
+	for (unsigned int i = 0, size = (unsigned int)mInfluences.size(); i < size; ++i) {
+		const ivec4& j = mInfluences[i];
+		if (j.x > 255 || j.y > 255 || j.z > 255 || j.w > 255) {
+			return false;
+		}
+	}
+	mCompact = true;
+	mInterleaved = true;
+	UpdateOpenGLBuffers();
+	return true;
+}
+
+bool Mesh::IsCompact() {
+	return mCompact;
+}
+
+std::vector<CompactVertex>& Mesh::GetCompactVertices() {
+	return mCompactVertices;
+}
+
+vec3 Mesh::GetPositionMin() {
+	return mPositionMin;
+}
+
+vec3 Mesh::GetPositionExtent() {
+	return mPositionExtent;
+}
+
+void Mesh::SetCompactUniforms(Shader* shader) {
+	bool decode = mCompact && !mSkinnedOnCPU;
+	Uniform<int>::Set(shader->GetUniform("compact"), decode ? 1 : 0);
+	if (decode) {
+		Uniform<vec3>::Set(shader->GetUniform("positionMin"), mPositionMin);
+		Uniform<vec3>::Set(shader->GetUniform("positionExtent"), mPositionExtent);
+	}
+}
+
+void Mesh::ClearVertexArrays() {
+	for (unsigned int i = 0, size = (unsigned int)mVertexArrays.size(); i < size; ++i) {
+		glDeleteVertexArrays(1, &mVertexArrays[i].mHandle);
+	}
+	mVertexArrays.clear();
+}
+
+void Mesh::UpdateCompactVertices() {
+	unsigned int numVerts = (unsigned int)mPosition.size();
+	mPositionMin = vec3();
+	mPositionExtent = vec3();
+	mCompactVertices.resize(numVerts);
+	if (numVerts == 0) {
+		return;
+	}
+
+	vec3 max = mPosition[0];
+	mPositionMin = mPosition[0];
+	for (unsigned int i = 1; i < numVerts; ++i) {
+		for (unsigned int c = 0; c < 3; ++c) {
+			float value = mPosition[i].v[c];
+			mPositionMin.v[c] = value < mPositionMin.v[c] ? value : mPositionMin.v[c];
+			max.v[c] = value > max.v[c] ? value : max.v[c];
+		}
+	}
+	mPositionExtent = max - mPositionMin;
+
+	for (unsigned int i = 0; i < numVerts; ++i) {
+		vec3 normal = i < mNormal.size() ? mNormal[i] : vec3(0, 0, 1);
+		vec2 texCoord = i < mTexCoord.size() ? mTexCoord[i] : vec2();
+		vec4 weights = i < mWeights.size() ? mWeights[i] : vec4(0, 0, 0, 0);
+		ivec4 joints = i < mInfluences.size() ? mInfluences[i] : ivec4(0, 0, 0, 0);
+		mCompactVertices[i] = compactVertex(mPosition[i], normal, texCoord, weights, joints, mPositionMin, mPositionExtent);
+	}
+}
+
+void Mesh::UpdateInterleavedBuffer() {
+	ClearVertexArrays();
+
+	// Only the attributes this mesh has, in Bind argument order
+	unsigned int numVerts = (unsigned int)mPosition.size();
+	unsigned int sizes[5] = { (unsigned int)mPosition.size(), (unsigned int)mNormal.size(),
+		(unsigned int)mTexCoord.size(), (unsigned int)mWeights.size(), (unsigned int)mInfluences.size() };
+	MeshVertexElement floats[5] = {
+		{ GL_FLOAT, 3, false, false, 0 }, { GL_FLOAT, 3, false, false, 0 }, { GL_FLOAT, 2, false, false, 0 },
+		{ GL_FLOAT, 4, false, false, 0 }, { GL_INT, 4, false, true, 0 }
+	};
+	unsigned int floatSizes[5] = { sizeof(vec3), sizeof(vec3), sizeof(vec2), sizeof(vec4), sizeof(ivec4) };
+	MeshVertexElement compact[5] = {
+		{ GL_UNSIGNED_SHORT, 3, true, false, offsetof(CompactVertex, position) },
+		{ GL_SHORT, 2, true, false, offsetof(CompactVertex, normal) },
+		{ GL_HALF_FLOAT, 2, false, false, offsetof(CompactVertex, texCoord) },
+		{ GL_UNSIGNED_BYTE, 4, true, false, offsetof(CompactVertex, weights) },
+		{ GL_UNSIGNED_BYTE, 4, false, true, offsetof(CompactVertex, joints) }
+	};
+	mVertexStride = 0;
+	for (unsigned int i = 0; i < 5; ++i) {
+		mElements[i] = mCompact ? compact[i] : floats[i];
+		if (numVerts == 0 || sizes[i] != numVerts) {
+			mElements[i].mType = 0;
+		}
+		else if (!mCompact) {
+			mElements[i].mOffset = mVertexStride;
+			mVertexStride += floatSizes[i];
+		}
+	}
+	if (numVerts == 0) {
+		mCompactVertices.clear();
+		return;
+	}
+
+	std::vector<char> vertices;
+	if (mCompact) {
+		UpdateCompactVertices();
+		mVertexStride = sizeof(CompactVertex);
+		vertices.resize(mVertexStride * numVerts);
+		memcpy(&vertices[0], &mCompactVertices[0], vertices.size());
+	}
+	else {
+		const void* sources[5] = { mPosition.data(), mNormal.data(), mTexCoord.data(), mWeights.data(), mInfluences.data() };
+		vertices.resize(mVertexStride * numVerts);
+		for (unsigned int i = 0; i < 5; ++i) {
+			if (mElements[i].mType == 0) {
+				continue;
+			}
+			const char* source = (const char*)sources[i];
+			unsigned int size = floatSizes[i];
+			for (unsigned int v = 0; v < numVerts; ++v) {
+				memcpy(&vertices[v * mVertexStride + mElements[i].mOffset], source + v * size, size);
+			}
+		}
+	}
+
+	if (mVertexBuffer == 0) {
+		glGenBuffers(1, &mVertexBuffer);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size(), &vertices[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::BindSkinnedAttributes(const int* slots) {
+	if (slots[0] >= 0) {
+		mPosAttrib->BindTo(slots[0]);
+	}
+	if (slots[1] >= 0) {
+		mNormAttrib->BindTo(slots[1]);
+	}
+}
+
+void Mesh::BindVertexArray(const int* slots) {
+	for (unsigned int i = 0, size = (unsigned int)mVertexArrays.size(); i < size; ++i) {
+		MeshVertexArray& vertexArray = mVertexArrays[i];
+		if (vertexArray.mSkinnedOnCPU == mSkinnedOnCPU && memcmp(vertexArray.mSlots, slots, sizeof(vertexArray.mSlots)) == 0) {
+			glBindVertexArray(vertexArray.mHandle);
+			// Streamed skinning output moves around the ring every frame
+			if (mSkinnedOnCPU && mPosAttrib->IsStreaming()) {
+				BindSkinnedAttributes(slots);
+			}
+			return;
+		}
+	}
+
+	MeshVertexArray vertexArray;
+	memcpy(vertexArray.mSlots, slots, sizeof(vertexArray.mSlots));
+	vertexArray.mSkinnedOnCPU = mSkinnedOnCPU;
+	glGenVertexArrays(1, &vertexArray.mHandle);
+	glBindVertexArray(vertexArray.mHandle);
+
+	GLsizei stride = (GLsizei)mVertexStride;
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+	for (unsigned int i = 0; i < 5; ++i) {
+		const MeshVertexElement& element = mElements[i];
+		if (slots[i] < 0 || element.mType == 0 || (mSkinnedOnCPU && i < 2)) {
+			continue;
+		}
+		void* offset = (void*)(size_t)element.mOffset;
+		glEnableVertexAttribArray(slots[i]);
+		if (element.mInteger) {
+			glVertexAttribIPointer(slots[i], element.mCount, element.mType, stride, offset);
+		}
+		else {
+			glVertexAttribPointer(slots[i], element.mCount, element.mType, element.mNormalized ? GL_TRUE : GL_FALSE, stride, offset);
+		}
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	if (mSkinnedOnCPU) {
+		BindSkinnedAttributes(slots);
+	}
+	mVertexArrays.push_back(vertexArray);
+}
+
 void Mesh::UpdateOpenGLBuffers() {
+	mSkinStreamSize = 0; // Vertex data may have changed, rebuild the SIMD streams on use
+	mSkinnedOnCPU = false;
+	if (mInfluenceVertices[4] != mPosition.size() || mInfluenceIndices[4] != mIndices.size()) {
+		ResetInfluenceGroups();
+	}
+	if (mInterleaved) {
+		UpdateInterleavedBuffer();
+		if (mIndices.size() > 0) {
+			mIndexBuffer->Set(mIndices);
+		}
+		return;
+	}
 	if (mPosition.size() > 0) {
 		mPosAttrib->Set(mPosition);
 	}
@@ -90,6 +664,11 @@ void Mesh::UpdateOpenGLBuffers() {
 }
 
 void Mesh::Bind(int position, int normal, int texCoord, int weight, int influcence) {
+	if (mInterleaved) {
+		int slots[5] = { position, normal, texCoord, weight, influcence };
+		BindVertexArray(slots);
+		return;
+	}
 	if (position >= 0) {
 		mPosAttrib->BindTo(position);
 	}
@@ -116,6 +695,13 @@ void Mesh::Draw() {
 	}
 }
 
+void Mesh::Draw(unsigned int numInfluences) {
+	unsigned int numIndices = GetInfluenceIndexCount(numInfluences);
+	if (numIndices > 0) {
+		::Draw(*mIndexBuffer, DrawMode::Triangles, GetInfluenceIndexOffset(numInfluences), numIndices);
+	}
+}
+
 void Mesh::DrawInstanced(unsigned int numInstances) {
 	if (mIndices.size() > 0) {
 		::DrawInstanced(*mIndexBuffer, DrawMode::Triangles, numInstances);
@@ -126,6 +712,10 @@ void Mesh::DrawInstanced(unsigned int numInstances) {
 }
 
 void Mesh::UnBind(int position, int normal, int texCoord, int weight, int influcence) {
+	if (mInterleaved) {
+		glBindVertexArray(sDefaultVertexArray); // The attribute arrays stay enabled in the vertex array
+		return;
+	}
 	if (position >= 0) {
 		mPosAttrib->UnBindFrom(position);
 	}
@@ -145,32 +735,35 @@ void Mesh::UnBind(int position, int normal, int texCoord, int weight, int influc
 
 #if 1
 void Mesh::CPUSkin(Skeleton& skeleton, Pose& pose) {
-	unsigned int numVerts = (unsigned int)mPosition.size();
-	if (numVerts == 0) { return; }
+	if (mPosition.size() == 0) { return; }
 
-	mSkinnedPosition.resize(numVerts);
-	mSkinnedNormal.resize(numVerts);
-
-	pose.GetMatrixPalette(mPosePalette);
-	std::vector<mat4> invPosePalette = skeleton.GetInvBindPose();
-
-	for (unsigned int i = 0; i < numVerts; ++i) {
-		ivec4& j = mInfluences[i];
-		vec4& w = mWeights[i];
-
-		mat4 m0 = (mPosePalette[j.x] * invPosePalette[j.x]) * w.x;
-		mat4 m1 = (mPosePalette[j.y] * invPosePalette[j.y]) * w.y;
-		mat4 m2 = (mPosePalette[j.z] * invPosePalette[j.z]) * w.z;
-		mat4 m3 = (mPosePalette[j.w] * invPosePalette[j.w]) * w.w;
-
-		mat4 skin = m0 + m1 + m2 + m3;
+	skeleton.GetSkinPalette(pose, mSkinPalette);
+	CPUSkin(mSkinPalette);
+}
 
-		mSkinnedPosition[i] = transformPoint(skin, mPosition[i]);
-		mSkinnedNormal[i] = transformVector(skin, mNormal[i]);
+void Mesh::CPUSkin(const std::vector<mat4>& skinPalette) {
+	unsigned int numVerts = BeginCPUSkin();
+	if (numVerts == 0) { return; }
+	if (mCompact && mCompactVertices.size() == numVerts) {
+		MeshHelpers::SkinCompactGroups(skinPalette, &mCompactVertices[0], mPositionMin, mPositionExtent,
+			mSkinPositionOut, mSkinNormalOut, mInfluenceVertices);
+		EndCPUSkin();
+		return;
 	}
 
-	mPosAttrib->Set(mSkinnedPosition);
-	mNormAttrib->Set(mSkinnedNormal);
+	const vec3* position = &mPosition[0];
+	const vec3* normal = &mNormal[0];
+	const vec4* weights = &mWeights[0];
+	const ivec4* influences = &mInfluences[0];
+	vec3* outPosition = mSkinPositionOut;
+	vec3* outNormal = mSkinNormalOut;
+	unsigned int* groups = mInfluenceVertices;
+	MeshHelpers::SkinVertices<1>(skinPalette, position, normal, weights, influences, outPosition, outNormal, groups[0], groups[1]);
+	MeshHelpers::SkinVertices<2>(skinPalette, position, normal, weights, influences, outPosition, outNormal, groups[1], groups[2]);
+	MeshHelpers::SkinVertices<3>(skinPalette, position, normal, weights, influences, outPosition, outNormal, groups[2], groups[3]);
+	MeshHelpers::SkinVertices<4>(skinPalette, position, normal, weights, influences, outPosition, outNormal, groups[3], groups[4]);
+
+	EndCPUSkin();
 }
 #else
 void Mesh::CPUSkin(Skeleton& skeleton, Pose& pose) {
@@ -208,3 +801,266 @@ void Mesh::CPUSkin(Skeleton& skeleton, Pose& pose) {
 	mNormAttrib->Set(mSkinnedNormal);
 }
 #endif
+
+void Mesh::UpdateSkinStreams() {
+	unsigned int numVerts = (unsigned int)mPosition.size();
+	unsigned int padded = simdPadded(numVerts);
+	mSkinStreams.assign(padded * 10, 0.0f);
+	mSkinJoints.assign(padded * 4, 0);
+	mSkinBlockInfluences.assign(padded / SIMD_WIDTH, 0);
+	// Compact meshes stream their decoded vertices, so SIMD skinning matches the GPU
+	bool compact = mCompact && mCompactVertices.size() == numVerts;
+	for (unsigned int i = 0; i < numVerts; ++i) {
+		vec3 p = compact ? decodePosition(mCompactVertices[i], mPositionMin, mPositionExtent) : mPosition[i];
+		vec3 n = compact ? decodeNormal(mCompactVertices[i]) : (i < mNormal.size() ? mNormal[i] : vec3());
+		vec4 w = compact ? decodeWeights(mCompactVertices[i]) : mWeights[i];
+		ivec4 j = compact ? decodeJoints(mCompactVertices[i]) : mInfluences[i];
+		float values[10] = { p.x, p.y, p.z, n.x, n.y, n.z, w.x, w.y, w.z, w.w };
+		int joints[4] = { j.x, j.y, j.z, j.w };
+		for (unsigned int c = 0; c < 10; ++c) {
+			mSkinStreams[c * padded + i] = values[c];
+		}
+		// Blocks take the kernel for their highest used weight, the rigid kernel skips
+		// the weight so it only serves single weights of one
+		unsigned char count = 0;
+		for (unsigned int c = 0; c < 4; ++c) {
+			mSkinJoints[c * padded + i] = joints[c] * 16;
+			count = values[6 + c] != 0.0f ? (unsigned char)(c + 1) : count;
+		}
+		count = count == 1 && w.x != 1.0f ? 2 : count;
+		unsigned char& block = mSkinBlockInfluences[i / SIMD_WIDTH];
+		block = count > block ? count : block;
+	}
+	mSkinStreamSize = numVerts;
+}
+
+// begin must be a multiple of SIMD_WIDTH, end is clamped to the vertex count
+void Mesh::SkinRangeSIMD(const std::vector<mat4>& skinPalette, unsigned int begin, unsigned int end) {
+	unsigned int numVerts = mSkinStreamSize;
+	unsigned int padded = simdPadded(numVerts);
+	const float* streams = &mSkinStreams[0];
+	const int* joints = &mSkinJoints[0];
+	const float* palette = skinPalette[0].v;
+	end = end < numVerts ? end : numVerts;
+
+	for (unsigned int i = begin; i < end; i += SIMD_WIDTH) {
+		// Weighted sum of the affine skin matrices, 12 components each. Sorted meshes
+		// have few blocks that mix influence counts
+		simdf m[12];
+		const float* weights = streams + 6 * padded + i;
+		switch (mSkinBlockInfluences[i / SIMD_WIDTH]) {
+		case 0:
+			for (unsigned int c = 0; c < 12; ++c) {
+				m[c] = simdZero();
+			}
+			break;
+		case 1: MeshHelpers::SkinMatrixSIMD<1>(palette, weights, joints + i, padded, m); break;
+		case 2: MeshHelpers::SkinMatrixSIMD<2>(palette, weights, joints + i, padded, m); break;
+		case 3: MeshHelpers::SkinMatrixSIMD<3>(palette, weights, joints + i, padded, m); break;
+		default: MeshHelpers::SkinMatrixSIMD<4>(palette, weights, joints + i, padded, m); break;
+		}
+
+		simdf px = simdLoad(streams + i);
+		simdf py = simdLoad(streams + padded + i);
+		simdf pz = simdLoad(streams + padded * 2 + i);
+		simdf nx = simdLoad(streams + padded * 3 + i);
+		simdf ny = simdLoad(streams + padded * 4 + i);
+		simdf nz = simdLoad(streams + padded * 5 + i);
+
+		float out[6][SIMD_WIDTH];
+		for (unsigned int r = 0; r < 3; ++r) {
+			simdf p = simdMadd(m[r], px, simdMadd(m[3 + r], py, simdMadd(m[6 + r], pz, m[9 + r])));
+			simdf n = simdMadd(m[r], nx, simdMadd(m[3 + r], ny, simdMul(m[6 + r], nz)));
+			simdStore(out[r], p);
+			simdStore(out[3 + r], n);
+		}
+
+		unsigned int count = end - i < SIMD_WIDTH ? end - i : SIMD_WIDTH;
+		for (unsigned int v = 0; v < count; ++v) {
+			mSkinPositionOut[i + v] = vec3(out[0][v], out[1][v], out[2][v]);
+			mSkinNormalOut[i + v] = vec3(out[3][v], out[4][v], out[5][v]);
+		}
+	}
+}
+
+void Mesh::SkinRangeSIMD(const std::vector<DualQuaternion>& skinPalette, unsigned int begin, unsigned int end) {
+	unsigned int numVerts = mSkinStreamSize;
+	unsigned int padded = simdPadded(numVerts);
+	const float* streams = &mSkinStreams[0];
+	const int* joints = &mSkinJoints[0];
+	const float* palette = (const float*)&skinPalette[0];
+	end = end < numVerts ? end : numVerts;
+	simdf one = simdSet(1.0f);
+	simdf two = simdSet(2.0f);
+
+	for (unsigned int i = begin; i < end; i += SIMD_WIDTH) {
+		simdf r[4];
+		simdf d[4];
+		const float* weights = streams + 6 * padded + i;
+		switch (mSkinBlockInfluences[i / SIMD_WIDTH]) {
+		case 0:
+			for (unsigned int c = 0; c < 4; ++c) {
+				r[c] = c == 3 ? one : simdZero();
+				d[c] = simdZero();
+			}
+			break;
+		case 1: MeshHelpers::SkinDualQuaternionSIMD<1>(palette, weights, joints + i, padded, r, d); break;
+		case 2: MeshHelpers::SkinDualQuaternionSIMD<2>(palette, weights, joints + i, padded, r, d); break;
+		case 3: MeshHelpers::SkinDualQuaternionSIMD<3>(palette, weights, joints + i, padded, r, d); break;
+		default: MeshHelpers::SkinDualQuaternionSIMD<4>(palette, weights, joints + i, padded, r, d); break;
+		}
+
+		// Rather than normalizing the blend, both terms below are quadratic in it and get
+		// divided by its squared length once
+		simdf invLenSq = simdDiv(one, simdMax(simdDot4(r, r), simdSet(0.000001f)));
+		simdf vv = simdMadd(r[0], r[0], simdMadd(r[1], r[1], simdMul(r[2], r[2])));
+		simdf ww = simdSub(simdMul(r[3], r[3]), vv);
+		simdf w2 = simdMul(r[3], two);
+
+		// Translation, twice the dual part times the conjugate of the real part
+		simdf t[3];
+		t[0] = simdAdd(simdSub(simdMul(r[3], d[0]), simdMul(d[3], r[0])), simdSub(simdMul(r[1], d[2]), simdMul(r[2], d[1])));
+		t[1] = simdAdd(simdSub(simdMul(r[3], d[1]), simdMul(d[3], r[1])), simdSub(simdMul(r[2], d[0]), simdMul(r[0], d[2])));
+		t[2] = simdAdd(simdSub(simdMul(r[3], d[2]), simdMul(d[3], r[2])), simdSub(simdMul(r[0], d[1]), simdMul(r[1], d[0])));
+
+		float out[6][SIMD_WIDTH];
+		for (unsigned int attribute = 0; attribute < 2; ++attribute) {
+			simdf x = simdLoad(streams + (attribute * 3) * padded + i);
+			simdf y = simdLoad(streams + (attribute * 3 + 1) * padded + i);
+			simdf z = simdLoad(streams + (attribute * 3 + 2) * padded + i);
+			simdf rv = simdMul(two, simdMadd(r[0], x, simdMadd(r[1], y, simdMul(r[2], z))));
+			simdf cx = simdSub(simdMul(r[1], z), simdMul(r[2], y));
+			simdf cy = simdSub(simdMul(r[2], x), simdMul(r[0], z));
+			simdf cz = simdSub(simdMul(r[0], y), simdMul(r[1], x));
+			simdf result[3];
+			result[0] = simdMadd(x, ww, simdMadd(r[0], rv, simdMul(cx, w2)));
+			result[1] = simdMadd(y, ww, simdMadd(r[1], rv, simdMul(cy, w2)));
+			result[2] = simdMadd(z, ww, simdMadd(r[2], rv, simdMul(cz, w2)));
+			for (unsigned int c = 0; c < 3; ++c) {
+				if (attribute == 0) {
+					result[c] = simdMadd(t[c], two, result[c]);
+				}
+				simdStore(out[attribute * 3 + c], simdMul(result[c], invLenSq));
+			}
+		}
+
+		unsigned int count = end - i < SIMD_WIDTH ? end - i : SIMD_WIDTH;
+		for (unsigned int v = 0; v < count; ++v) {
+			mSkinPositionOut[i + v] = vec3(out[0][v], out[1][v], out[2][v]);
+			mSkinNormalOut[i + v] = vec3(out[3][v], out[4][v], out[5][v]);
+		}
+	}
+}
+
+unsigned int Mesh::BeginCPUSkin() {
+	unsigned int numVerts = (unsigned int)mPosition.size();
+	if (numVerts == 0) {
+		return 0;
+	}
+	if (mSkinStreamSize != numVerts) {
+		UpdateSkinStreams();
+	}
+	if (mPosAttrib->IsStreaming()) {
+		mSkinnedPosition.clear();
+		mSkinnedNormal.clear();
+		mSkinPositionOut = mPosAttrib->Map(numVerts);
+		mSkinNormalOut = mNormAttrib->Map(numVerts);
+	}
+	else {
+		mSkinnedPosition.resize(numVerts);
+		mSkinnedNormal.resize(numVerts);
+		mSkinPositionOut = &mSkinnedPosition[0];
+		mSkinNormalOut = &mSkinnedNormal[0];
+	}
+	return numVerts;
+}
+
+void Mesh::CPUSkinRange(const std::vector<mat4>& skinPalette, unsigned int begin, unsigned int end) {
+	SkinRangeSIMD(skinPalette, begin, end);
+}
+
+void Mesh::EndCPUSkin() {
+	if (mPosition.size() == 0) { return; }
+	if (mPosAttrib->IsStreaming()) {
+		mPosAttrib->Unmap();
+		mNormAttrib->Unmap();
+	}
+	else {
+		mPosAttrib->Set(mSkinnedPosition);
+		mNormAttrib->Set(mSkinnedNormal);
+	}
+	mSkinnedOnCPU = true;
+}
+
+void Mesh::SetStreamingSkin(bool streaming) {
+	mPosAttrib->SetStreaming(streaming);
+	mNormAttrib->SetStreaming(streaming);
+}
+
+bool Mesh::IsStreamingSkin() {
+	return mPosAttrib->IsStreaming();
+}
+
+void Mesh::CPUSkinSIMD(const std::vector<mat4>& skinPalette) {
+	if (skinPalette.size() == 0) { return; }
+	unsigned int numVerts = BeginCPUSkin();
+	if (numVerts == 0) { return; }
+	SkinRangeSIMD(skinPalette, 0, numVerts);
+	EndCPUSkin();
+}
+
+void Mesh::CPUSkin(const std::vector<DualQuaternion>& skinPalette) {
+	unsigned int numVerts = BeginCPUSkin();
+	if (numVerts == 0) { return; }
+	if (mCompact && mCompactVertices.size() == numVerts) {
+		MeshHelpers::SkinCompactGroups(skinPalette, &mCompactVertices[0], mPositionMin, mPositionExtent,
+			mSkinPositionOut, mSkinNormalOut, mInfluenceVertices);
+		EndCPUSkin();
+		return;
+	}
+
+	const vec3* position = &mPosition[0];
+	const vec3* normal = &mNormal[0];
+	const vec4* weights = &mWeights[0];
+	const ivec4* influences = &mInfluences[0];
+	vec3* outPosition = mSkinPositionOut;
+	vec3* outNormal = mSkinNormalOut;
+	unsigned int* groups = mInfluenceVertices;
+	MeshHelpers::SkinVertices<1>(skinPalette, position, normal, weights, influences, outPosition, outNormal, groups[0], groups[1]);
+	MeshHelpers::SkinVertices<2>(skinPalette, position, normal, weights, influences, outPosition, outNormal, groups[1], groups[2]);
+	MeshHelpers::SkinVertices<3>(skinPalette, position, normal, weights, influences, outPosition, outNormal, groups[2], groups[3]);
+	MeshHelpers::SkinVertices<4>(skinPalette, position, normal, weights, influences, outPosition, outNormal, groups[3], groups[4]);
+
+	EndCPUSkin();
+}
+
+void Mesh::CPUSkinSIMD(const std::vector<DualQuaternion>& skinPalette) {
+	if (skinPalette.size() == 0) { return; }
+	unsigned int numVerts = BeginCPUSkin();
+	if (numVerts == 0) { return; }
+	SkinRangeSIMD(skinPalette, 0, numVerts);
+	EndCPUSkin();
+}
+
+void Mesh::CPUSkinParallel(const std::vector<mat4>& skinPalette, WorkerPool& pool) {
+	if (mPosition.size() == 0 || skinPalette.size() == 0) { return; }
+	MeshHelpers::SkinJobs jobs = { this, 1, &skinPalette };
+	pool.Run(MeshHelpers::SkinChunk, &jobs, MeshHelpers::NumChunks(BeginCPUSkin()));
+	EndCPUSkin();
+}
+
+void CPUSkinParallel(std::vector<Mesh>& meshes, const std::vector<mat4>& skinPalette, WorkerPool& pool) {
+	if (meshes.size() == 0 || skinPalette.size() == 0) { return; }
+	unsigned int numMeshes = (unsigned int)meshes.size();
+	unsigned int numChunks = 0;
+	for (unsigned int i = 0; i < numMeshes; ++i) {
+		numChunks += MeshHelpers::NumChunks(meshes[i].BeginCPUSkin());
+	}
+	MeshHelpers::SkinJobs jobs = { &meshes[0], numMeshes, &skinPalette };
+	pool.Run(MeshHelpers::SkinChunk, &jobs, numChunks);
+	// Run returned, every chunk is written
+	for (unsigned int i = 0; i < numMeshes; ++i) {
+		meshes[i].EndCPUSkin();
+	}
+}
+
@@ -10,6 +10,30 @@
 #include "IndexBuffer.h"
 #include "Skeleton.h"
 #include "Pose.h"
+#include "DualQuaternion.h"
+#include "WorkerPool.h"
+#include "CompactVertex.h"
+#include "Shader.h"
+
+// Vertices per parallel skinning job. The SoA input and skinned output of a chunk come
+// to about 80KB, so a chunk stays in a core's L2 while it is skinned.
+#define SKIN_CHUNK_SIZE 1024
+
+// A vertex array object baked for one set of shader attribute slots
+struct MeshVertexArray {
+	int mSlots[5];      // Position, normal, texCoord, weights and joints, as passed to Bind
+	bool mSkinnedOnCPU; // Position and normal come from the CPU skinned attributes
+	unsigned int mHandle;
+};
+
+// Where the attribute of one Bind argument sits in the interleaved vertex buffer
+struct MeshVertexElement {
+	unsigned int mType; // GL component type, 0 if the mesh does not have the attribute
+	int mCount;
+	bool mNormalized;
+	bool mInteger;      // Read as an ivec4 by the shader
+	unsigned int mOffset;
+};
 
 class Mesh {
 protected:
@@ -29,7 +53,47 @@ protected:
 protected:
 	std::vector<vec3> mSkinnedPosition;
 	std::vector<vec3> mSkinnedNormal;
-	std::vector<mat4> mPosePalette;
+	std::vector<mat4> mSkinPalette;
+	// SIMD skinning input, built from the vertex data on first use. Position xyz, normal
+	// xyz and the four weights are float streams, the four joints are int streams holding
+	// the joint's offset into a mat4 array. Every stream is padded to SIMD_WIDTH.
+	std::vector<float> mSkinStreams;
+	std::vector<int> mSkinJoints;
+	std::vector<unsigned char> mSkinBlockInfluences; // Most influences any vertex of the block uses
+	unsigned int mSkinStreamSize;
+	// Vertices mInfluenceVertices[n - 1] up to mInfluenceVertices[n] have n influences,
+	// mInfluenceIndices groups the triangles the same way by the most influences of their
+	// three vertices. Until SortByInfluenceCount runs everything is in the four group.
+	unsigned int mInfluenceVertices[5];
+	unsigned int mInfluenceIndices[5];
+	// Where the CPU skinning kernels write, mSkinnedPosition or mapped GL memory
+	vec3* mSkinPositionOut;
+	vec3* mSkinNormalOut;
+	bool mSkinnedOnCPU;
+	// Interleaved mode keeps every vertex attribute in one buffer laid out by mElements,
+	// and Bind binds a vertex array baked for the slots instead of each attribute
+	bool mInterleaved;
+	unsigned int mVertexBuffer;
+	MeshVertexElement mElements[5]; // Position, normal, texCoord, weights and joints
+	unsigned int mVertexStride;
+	std::vector<MeshVertexArray> mVertexArrays;
+	static unsigned int sDefaultVertexArray;
+	// Compact mode, interleaved CompactVertex data quantized against the mesh bounds.
+	// The GPU draws from it and CPU skinning decodes it, so both see the same vertices
+	bool mCompact;
+	std::vector<CompactVertex> mCompactVertices;
+	vec3 mPositionMin;
+	vec3 mPositionExtent;
+protected:
+	void UpdateInterleavedBuffer();
+	void UpdateCompactVertices();
+	void ClearVertexArrays();
+	void BindVertexArray(const int* slots);
+	void BindSkinnedAttributes(const int* slots);
+	void ResetInfluenceGroups();
+	void UpdateSkinStreams();
+	void SkinRangeSIMD(const std::vector<mat4>& skinPalette, unsigned int begin, unsigned int end);
+	void SkinRangeSIMD(const std::vector<DualQuaternion>& skinPalette, unsigned int begin, unsigned int end);
 public:
 	Mesh();
 	Mesh(const Mesh&);
@@ -41,13 +105,75 @@ public:
 	std::vector<vec4>& GetWeights();
 	std::vector<ivec4>& GetInfluences();
 	std::vector<unsigned int>& GetIndices();
+	// Builds its own skin palette, prefer the overload below when skinning several meshes
 	void CPUSkin(Skeleton& skeleton, Pose& pose);
+	// skinPalette comes from Skeleton::GetSkinPalette
+	void CPUSkin(const std::vector<mat4>& skinPalette);
+	// Same result as CPUSkin, SIMD_WIDTH vertices at a time from SoA vertex streams
+	void CPUSkinSIMD(const std::vector<mat4>& skinPalette);
+	// Dual quaternion skinning, skinPalette comes from Skeleton::GetDualQuaternionSkinPalette.
+	// Blending rotations instead of matrices keeps the volume of twisting joints, but
+	// joint scale is ignored
+	void CPUSkin(const std::vector<DualQuaternion>& skinPalette);
+	void CPUSkinSIMD(const std::vector<DualQuaternion>& skinPalette);
+	// CPUSkinSIMD split into SKIN_CHUNK_SIZE vertex chunks on the pool, uploads once all
+	// chunks are done. Use the free CPUSkinParallel below for several meshes
+	void CPUSkinParallel(const std::vector<mat4>& skinPalette, WorkerPool& pool);
+	// The three steps of CPUSkinSIMD. SkinRange may run on several threads at once as
+	// long as the ranges do not overlap, begin must be a multiple of SIMD_WIDTH.
+	// BeginCPUSkin returns the number of vertices and EndCPUSkin uploads the result
+	unsigned int BeginCPUSkin();
+	void CPUSkinRange(const std::vector<mat4>& skinPalette, unsigned int begin, unsigned int end);
+	void EndCPUSkin();
+	// Skinned output of the last CPUSkin call, what the position and normal attributes hold.
+	// Empty when streaming, the output only exists in GL memory then
+	std::vector<vec3>& GetSkinnedPosition();
+	std::vector<vec3>& GetSkinnedNormal();
+	// Drops zero weights and reorders the vertices so they are grouped by how many
+	// joints they use, remapping the indices. Each group is then skinned by a kernel
+	// for that many influences, a rigid vertex costs one matrix transform. Only indexed
+	// meshes are sorted, call it again after editing the vertex data.
+	void SortByInfluenceCount();
+	// Vertices (or triangles, as index ranges) skinned with numInfluences joints
+	unsigned int GetInfluenceVertexOffset(unsigned int numInfluences);
+	unsigned int GetInfluenceVertexCount(unsigned int numInfluences);
+	unsigned int GetInfluenceIndexOffset(unsigned int numInfluences);
+	unsigned int GetInfluenceIndexCount(unsigned int numInfluences);
+	// CPU skinning writes straight into triple buffered, mapped position and normal
+	// buffers (Attribute::SetStreaming), no copy or reallocation per frame
+	void SetStreamingSkin(bool streaming);
+	bool IsStreamingSkin();
+	// One interleaved vertex buffer and a cached vertex array per shader, for meshes
+	// drawn many times where per attribute binding dominates
+	void SetInterleaved(bool interleaved);
+	bool IsInterleaved();
+	// The vertex array UnBind goes back to after an interleaved draw, the one the host
+	// binds for loose attributes. Tracked here so drawing never queries GL state
+	static void SetDefaultVertexArray(unsigned int vertexArray);
+	// Interleaved in the 24 byte CompactVertex format instead of 64 bytes of floats.
+	// Positions and normals are decoded by static.vert and the skinned shaders once
+	// SetCompactUniforms has run. False, and the mesh stays as it was, if a joint index
+	// does not fit in 8 bits
+	bool SetCompact(bool compact);
+	bool IsCompact();
+	std::vector<CompactVertex>& GetCompactVertices();
+	vec3 GetPositionMin();
+	vec3 GetPositionExtent();
+	// Sets the decode uniforms of shader for this mesh, the float path when not compact
+	// or when the positions and normals were skinned on the CPU
+	void SetCompactUniforms(Shader* shader);
 	void UpdateOpenGLBuffers();
 	void Bind(int position, int normal, int texCoord, int weight, int influcence);
 	void Draw();
+	// Only the triangles whose vertices use at most numInfluences joints, and at least
+	// one uses exactly that many. Draw with the matching skinned vertex shader variant
+	void Draw(unsigned int numInfluences);
 	void DrawInstanced(unsigned int numInstances);
 	void UnBind(int position, int normal, int texCoord, int weight, int influcence);
 };
 
+// Skins every mesh with one batch of jobs, chunks from all meshes share the pool so a
+// few small meshes and one dense mesh both keep every thread busy
+void CPUSkinParallel(std::vector<Mesh>& meshes, const std::vector<mat4>& skinPalette, WorkerPool& pool);
 
 #endif // !_H_MESH_
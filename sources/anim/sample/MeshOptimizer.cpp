@@ -0,0 +1,813 @@
+#include "MeshOptimizer.h"
+#include <el_debug.h>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+namespace MeshOptimizerHelpers {
+	// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+	const float CacheDecayPower = 1.5f;
+	const float LastTriangleScore = 0.75f;
+	const float ValenceBoostScale = 2.0f;
+	const float ValenceBoostPower = 0.5f;
+
+	inline float VertexScore(int cachePosition, unsigned int remaining) {
+		if (remaining == 0) {
+			return -1.0f; // Not used by any triangle left to emit
+		}
+		float score = 0.0f;
+		if (cachePosition >= 0) {
+			if (cachePosition < 3) {
+				// The last triangle's vertices, a fixed score so there is no reward for
+				// emitting a triangle that shares all three
+				score = LastTriangleScore;
+			}
+			else {
+				const float scale = 1.0f / (VERTEX_CACHE_OPTIMIZE_SIZE - 3);
+				score = powf(1.0f - (cachePosition - 3) * scale, CacheDecayPower);
+			}
+		}
+		// Vertices with few triangles left get them out of the way first
+		return score + ValenceBoostScale * powf((float)remaining, -ValenceBoostPower);
+	}
+
+	// Attributes a mesh does not have are empty and stay that way
+	template<typename T>
+	inline void Gather(std::vector<T>& values, const std::vector<unsigned int>& order, unsigned int numVerts) {
+		if (values.size() != numVerts) {
+			return;
+		}
+		std::vector<T> result(order.size());
+		for (unsigned int i = 0, size = (unsigned int)order.size(); i < size; ++i) {
+			result[i] = values[order[i]];
+		}
+		values = result;
+	}
+
+	template<typename T>
+	inline void Reorder(std::vector<T>& values, const std::vector<unsigned int>& order) {
+		if (values.size() != order.size()) {
+			return;
+		}
+		std::vector<T> result(values.size());
+		for (unsigned int i = 0, size = (unsigned int)order.size(); i < size; ++i) {
+			result[i] = values[order[i]];
+		}
+		values = result;
+	}
+	// Numbers the count records of size bytes by their first bit identical record.
+	// outOrder[id] is the first record of id. Open addressing on an FNV-1a hash, at
+	// most half full
+	inline void FindUnique(const unsigned char* records, unsigned int size, unsigned int count,
+		std::vector<unsigned int>& outRemap, std::vector<unsigned int>& outOrder) {
+		unsigned int tableSize = 1;
+		while (tableSize < count * 2) {
+			tableSize *= 2;
+		}
+		std::vector<unsigned int> table(tableSize, count);
+		outRemap.resize(count);
+		outOrder.clear();
+		for (unsigned int i = 0; i < count; ++i) {
+			const unsigned char* record = records + i * size;
+			unsigned int hash = 2166136261u;
+			for (unsigned int b = 0; b < size; ++b) {
+				hash = (hash ^ record[b]) * 16777619u;
+			}
+			unsigned int slot = hash & (tableSize - 1);
+			while (table[slot] != count && memcmp(records + table[slot] * size, record, size) != 0) {
+				slot = (slot + 1) & (tableSize - 1);
+			}
+			if (table[slot] == count) {
+				table[slot] = i;
+				outRemap[i] = (unsigned int)outOrder.size();
+				outOrder.push_back(i);
+			}
+			else {
+				outRemap[i] = outRemap[table[slot]];
+			}
+		}
+	}
+	// Open edges count this much more than the faces around them, or the silhouette of
+	// a cut (the neck of a separate head mesh) would shrink first
+	const double BoundaryWeight = 10.0;
+
+	// Symmetric 4x4 plane quadric, the upper triangle. Doubles, a vertex sums the
+	// squared distances to many planes
+	struct Quadric {
+		double m[10];
+	};
+
+	inline void ClearQuadric(Quadric& q) {
+		for (unsigned int i = 0; i < 10; ++i) {
+			q.m[i] = 0.0;
+		}
+	}
+
+	// The plane dot(n, p) + d = 0, n unit length
+	inline void AddPlane(Quadric& q, const vec3& n, double d, double weight) {
+		double a = n.x, b = n.y, c = n.z;
+		q.m[0] += a * a * weight; q.m[1] += a * b * weight; q.m[2] += a * c * weight; q.m[3] += a * d * weight;
+		q.m[4] += b * b * weight; q.m[5] += b * c * weight; q.m[6] += b * d * weight;
+		q.m[7] += c * c * weight; q.m[8] += c * d * weight;
+		q.m[9] += d * d * weight;
+	}
+
+	inline void AddQuadric(Quadric& q, const Quadric& other) {
+		for (unsigned int i = 0; i < 10; ++i) {
+			q.m[i] += other.m[i];
+		}
+	}
+
+	inline double QuadricError(const Quadric& q, const vec3& p) {
+		double x = p.x, y = p.y, z = p.z;
+		return q.m[0] * x * x + 2.0 * q.m[1] * x * y + 2.0 * q.m[2] * x * z + 2.0 * q.m[3] * x +
+			q.m[4] * y * y + 2.0 * q.m[5] * y * z + 2.0 * q.m[6] * y +
+			q.m[7] * z * z + 2.0 * q.m[8] * z + q.m[9];
+	}
+
+	// Moves point mFrom onto point mTo
+	struct Collapse {
+		float mCost;
+		unsigned int mFrom;
+		unsigned int mTo;
+	};
+
+	// std::priority_queue puts the largest first, this makes it the cheapest
+	struct CollapseGreater {
+		bool operator()(const Collapse& a, const Collapse& b) const {
+			return a.mCost > b.mCost;
+		}
+	};
+
+	// Like Gather, but into another mesh's attribute
+	template<typename T>
+	inline void Select(std::vector<T>& out, const std::vector<T>& values, const std::vector<unsigned int>& order, unsigned int numVerts) {
+		out.clear();
+		if (values.size() != numVerts) {
+			return;
+		}
+		out.resize(order.size());
+		for (unsigned int i = 0, size = (unsigned int)order.size(); i < size; ++i) {
+			out[i] = values[order[i]];
+		}
+	}
+
+	inline void AddUnique(std::vector<unsigned int>& values, unsigned int value) {
+		for (unsigned int i = 0, size = (unsigned int)values.size(); i < size; ++i) {
+			if (values[i] == value) {
+				return;
+			}
+		}
+		values.push_back(value);
+	}
+} // End MeshOptimizerHelpers namespace
+
+VertexCacheStats GetVertexCacheStats(const std::vector<unsigned int>& indices, unsigned int numVerts, unsigned int cacheSize) {
+	VertexCacheStats result = { 0.0f, 0.0f };
+	unsigned int numIndices = (unsigned int)indices.size();
+	if (numIndices < 3 || numVerts == 0) {
+		return result;
+	}
+
+	// FIFO: a vertex is still cached while fewer than cacheSize misses came after it
+	std::vector<unsigned int> cachedAt(numVerts, 0);
+	std::vector<bool> used(numVerts, false);
+	unsigned int misses = 0;
+	unsigned int numUsed = 0;
+	for (unsigned int i = 0; i < numIndices; ++i) {
+		unsigned int v = indices[i];
+		if (!used[v]) {
+			used[v] = true;
+			numUsed += 1;
+		}
+		else if (misses - cachedAt[v] < cacheSize) {
+			continue;
+		}
+		cachedAt[v] = misses;
+		misses += 1;
+	}
+	result.mACMR = (float)misses / (float)(numIndices / 3);
+	result.mATVR = (float)misses / (float)numUsed;
+	return result;
+}
+
+void OptimizeTriangleOrder(std::vector<unsigned int>& indices, unsigned int numVerts, unsigned int first, unsigned int count) {
+	if (count < 2 || numVerts == 0) {
+		return;
+	}
+	const unsigned int* triangles = &indices[first];
+
+	// Triangles of each vertex, the list shrinks as they are emitted
+	std::vector<unsigned int> remaining(numVerts, 0);
+	for (unsigned int i = 0; i < count * 3; ++i) {
+		remaining[triangles[i]] += 1;
+	}
+	std::vector<unsigned int> offsets(numVerts, 0);
+	for (unsigned int v = 0, offset = 0; v < numVerts; ++v) {
+		offsets[v] = offset;
+		offset += remaining[v];
+	}
+	std::vector<unsigned int> adjacency(count * 3);
+	std::vector<unsigned int> fill(offsets);
+	for (unsigned int t = 0; t < count; ++t) {
+		for (unsigned int k = 0; k < 3; ++k) {
+			adjacency[fill[triangles[t * 3 + k]]++] = t;
+		}
+	}
+
+	std::vector<int> cachePosition(numVerts, -1);
+	std::vector<float> vertexScores(numVerts);
+	for (unsigned int v = 0; v < numVerts; ++v) {
+		vertexScores[v] = MeshOptimizerHelpers::VertexScore(-1, remaining[v]);
+	}
+	std::vector<bool> emitted(count, false);
+
+	std::vector<unsigned int> result(count * 3);
+	unsigned int cache[VERTEX_CACHE_OPTIMIZE_SIZE + 3];
+	unsigned int cacheSize = 0;
+	unsigned int cursor = 0; // Every triangle before it was emitted
+	int best = -1;
+
+	for (unsigned int emit = 0; emit < count; ++emit) {
+		// Nothing in the cache has triangles left, take the next one in input order.
+		// Scanning all of them here would make the whole pass quadratic
+		if (best < 0) {
+			while (emitted[cursor]) {
+				++cursor;
+			}
+			best = (int)cursor;
+		}
+		const unsigned int* tri = &triangles[best * 3];
+		for (unsigned int k = 0; k < 3; ++k) {
+			result[emit * 3 + k] = tri[k];
+		}
+		emitted[best] = true;
+
+		// Drop the triangle from its vertices' lists
+		for (unsigned int k = 0; k < 3; ++k) {
+			unsigned int v = tri[k];
+			unsigned int* list = &adjacency[offsets[v]];
+			unsigned int size = remaining[v];
+			for (unsigned int i = 0; i < size; ++i) {
+				if (list[i] == (unsigned int)best) {
+					list[i] = list[size - 1];
+					break;
+				}
+			}
+			remaining[v] = size - 1;
+		}
+
+		// The triangle's vertices move to the front of the LRU cache
+		unsigned int newCache[VERTEX_CACHE_OPTIMIZE_SIZE + 3];
+		unsigned int newSize = 0;
+		for (unsigned int k = 0; k < 3; ++k) {
+			newCache[newSize++] = tri[k];
+		}
+		for (unsigned int i = 0; i < cacheSize; ++i) {
+			unsigned int v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2]) {
+				newCache[newSize++] = v;
+			}
+		}
+		for (unsigned int i = 0; i < newSize; ++i) {
+			cache[i] = newCache[i];
+			cachePosition[cache[i]] = i < VERTEX_CACHE_OPTIMIZE_SIZE ? (int)i : -1;
+		}
+		cacheSize = newSize < VERTEX_CACHE_OPTIMIZE_SIZE ? newSize : VERTEX_CACHE_OPTIMIZE_SIZE;
+
+		// Only vertices that were or are in the cache changed score, rescore their
+		// triangles and pick the best of them
+		for (unsigned int i = 0; i < newSize; ++i) {
+			unsigned int v = cache[i];
+			vertexScores[v] = MeshOptimizerHelpers::VertexScore(cachePosition[v], remaining[v]);
+		}
+		best = -1;
+		float bestScore = -1.0f;
+		for (unsigned int i = 0; i < newSize; ++i) {
+			unsigned int v = cache[i];
+			const unsigned int* list = &adjacency[offsets[v]];
+			for (unsigned int j = 0, size = remaining[v]; j < size; ++j) {
+				unsigned int t = list[j];
+				const unsigned int* other = &triangles[t * 3];
+				float score = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+				if (score > bestScore) {
+					bestScore = score;
+					best = (int)t;
+				}
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < count * 3; ++i) {
+		indices[first + i] = result[i];
+	}
+}
+
+void OptimizeVertexOrder(std::vector<unsigned int>& indices, unsigned int numVerts,
+	const unsigned int* groups, unsigned int numGroups, std::vector<unsigned int>& outOrder) {
+	std::vector<unsigned int> next(groups, groups + numGroups);
+	std::vector<unsigned int> remap(numVerts, numVerts);
+	unsigned int numIndices = (unsigned int)indices.size();
+
+	// Groups are ordered, the last one that starts at or before v holds it
+	for (unsigned int pass = 0; pass < 2; ++pass) {
+		unsigned int size = pass == 0 ? numIndices : numVerts;
+		for (unsigned int i = 0; i < size; ++i) {
+			unsigned int v = pass == 0 ? indices[i] : i;
+			if (remap[v] != numVerts) {
+				continue;
+			}
+			unsigned int group = 0;
+			while (group + 1 < numGroups && groups[group + 1] <= v) {
+				++group;
+			}
+			remap[v] = next[group]++;
+		}
+	}
+
+	outOrder.resize(numVerts);
+	for (unsigned int v = 0; v < numVerts; ++v) {
+		outOrder[remap[v]] = v;
+	}
+	for (unsigned int i = 0; i < numIndices; ++i) {
+		indices[i] = remap[indices[i]];
+	}
+}
+
+unsigned int WeldVertices(Mesh& mesh) {
+	std::vector<vec3>& position = mesh.GetPosition();
+	std::vector<vec3>& normal = mesh.GetNormal();
+	std::vector<vec2>& texCoord = mesh.GetTexCoord();
+	std::vector<vec4>& weights = mesh.GetWeights();
+	std::vector<ivec4>& influences = mesh.GetInfluences();
+	std::vector<unsigned int>& indices = mesh.GetIndices();
+	unsigned int numVerts = (unsigned int)position.size();
+	if (numVerts == 0) {
+		return 0;
+	}
+
+	// Every attribute the mesh has, packed into one record per vertex to compare
+	const char* sources[5] = { (const char*)position.data(), (const char*)normal.data(),
+		(const char*)texCoord.data(), (const char*)weights.data(), (const char*)influences.data() };
+	unsigned int sizes[5] = { sizeof(vec3), sizeof(vec3), sizeof(vec2), sizeof(vec4), sizeof(ivec4) };
+	unsigned int counts[5] = { numVerts, (unsigned int)normal.size(), (unsigned int)texCoord.size(),
+		(unsigned int)weights.size(), (unsigned int)influences.size() };
+	unsigned int recordSize = 0;
+	for (unsigned int i = 0; i < 5; ++i) {
+		recordSize += counts[i] == numVerts ? sizes[i] : 0;
+	}
+	std::vector<unsigned char> records(recordSize * numVerts);
+	for (unsigned int v = 0; v < numVerts; ++v) {
+		unsigned char* record = &records[v * recordSize];
+		for (unsigned int i = 0; i < 5; ++i) {
+			if (counts[i] == numVerts) {
+				memcpy(record, sources[i] + v * sizes[i], sizes[i]);
+				record += sizes[i];
+			}
+		}
+	}
+
+	std::vector<unsigned int> remap;
+	std::vector<unsigned int> order;
+	MeshOptimizerHelpers::FindUnique(&records[0], recordSize, numVerts, remap, order);
+
+	unsigned int numUnique = (unsigned int)order.size();
+	if (numUnique != numVerts) {
+		for (unsigned int i = 0, size = (unsigned int)indices.size(); i < size; ++i) {
+			indices[i] = remap[indices[i]];
+		}
+		MeshOptimizerHelpers::Gather(position, order, numVerts);
+		MeshOptimizerHelpers::Gather(normal, order, numVerts);
+		MeshOptimizerHelpers::Gather(texCoord, order, numVerts);
+		MeshOptimizerHelpers::Gather(weights, order, numVerts);
+		MeshOptimizerHelpers::Gather(influences, order, numVerts);
+	}
+	return numUnique;
+}
+
+void OptimizeVertexCache(Mesh& mesh, const char* name, bool reorderVertices) {
+	std::vector<unsigned int>& indices = mesh.GetIndices();
+	unsigned int numVerts = (unsigned int)mesh.GetPosition().size();
+	unsigned int numIndices = (unsigned int)indices.size();
+	if (numIndices < 3 || numVerts == 0) {
+		return;
+	}
+	VertexCacheStats before = GetVertexCacheStats(indices, numVerts);
+	unsigned int numBefore = numVerts;
+
+	// The influence groups only describe the mesh once it was sorted or uploaded,
+	// until then it is one group
+	bool grouped = mesh.GetInfluenceVertexOffset(4) + mesh.GetInfluenceVertexCount(4) == numVerts &&
+		mesh.GetInfluenceIndexOffset(4) + mesh.GetInfluenceIndexCount(4) == numIndices &&
+		mesh.GetInfluenceVertexCount(4) != numVerts;
+	if (reorderVertices && !grouped) {
+		numVerts = WeldVertices(mesh);
+	}
+
+	unsigned int groups[5] = { 0, 0, 0, 0, numVerts };
+	if (grouped) {
+		for (unsigned int n = 1; n <= 4; ++n) {
+			groups[n - 1] = mesh.GetInfluenceVertexOffset(n);
+			OptimizeTriangleOrder(indices, numVerts, mesh.GetInfluenceIndexOffset(n), mesh.GetInfluenceIndexCount(n) / 3);
+		}
+	}
+	else {
+		OptimizeTriangleOrder(indices, numVerts, 0, numIndices / 3);
+	}
+
+	if (reorderVertices) {
+		std::vector<unsigned int> order;
+		OptimizeVertexOrder(indices, numVerts, groups, 4, order);
+		MeshOptimizerHelpers::Reorder(mesh.GetPosition(), order);
+		MeshOptimizerHelpers::Reorder(mesh.GetNormal(), order);
+		MeshOptimizerHelpers::Reorder(mesh.GetTexCoord(), order);
+		MeshOptimizerHelpers::Reorder(mesh.GetWeights(), order);
+		MeshOptimizerHelpers::Reorder(mesh.GetInfluences(), order);
+	}
+
+	if (name != 0) {
+		VertexCacheStats after = GetVertexCacheStats(indices, numVerts);
+		el::trace("%s: %u triangles, %u -> %u vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", name, numIndices / 3,
+			numBefore, numVerts, before.mACMR, after.mACMR, before.mATVR, after.mATVR);
+	}
+}
+
+void SimplifyMesh(Mesh& outMesh, Mesh& mesh, unsigned int targetTriangles) {
+	std::vector<vec3>& position = mesh.GetPosition();
+	std::vector<vec3>& normal = mesh.GetNormal();
+	std::vector<vec2>& texCoord = mesh.GetTexCoord();
+	std::vector<unsigned int>& indices = mesh.GetIndices();
+	unsigned int numVerts = (unsigned int)position.size();
+	unsigned int numTriangles = (unsigned int)indices.size() / 3;
+	if (numVerts == 0 || numTriangles == 0) {
+		outMesh.GetPosition().clear();
+		outMesh.GetNormal().clear();
+		outMesh.GetTexCoord().clear();
+		outMesh.GetWeights().clear();
+		outMesh.GetInfluences().clear();
+		outMesh.GetIndices().clear();
+		return;
+	}
+
+	// Surface points, with the vertices (the seams) at each
+	std::vector<unsigned int> pointOf;
+	std::vector<unsigned int> pointOrder;
+	MeshOptimizerHelpers::FindUnique((const unsigned char*)&position[0], sizeof(vec3), numVerts, pointOf, pointOrder);
+	unsigned int numPoints = (unsigned int)pointOrder.size();
+	std::vector<unsigned int> pointVertexOffsets(numPoints + 1, 0);
+	for (unsigned int v = 0; v < numVerts; ++v) {
+		pointVertexOffsets[pointOf[v] + 1] += 1;
+	}
+	for (unsigned int p = 0; p < numPoints; ++p) {
+		pointVertexOffsets[p + 1] += pointVertexOffsets[p];
+	}
+	std::vector<unsigned int> pointVertices(numVerts);
+	std::vector<unsigned int> fill(pointVertexOffsets.begin(), pointVertexOffsets.end() - 1);
+	for (unsigned int v = 0; v < numVerts; ++v) {
+		pointVertices[fill[pointOf[v]]++] = v;
+	}
+
+	// Corners stay vertices so the attributes follow, the point is pointOf[corner]
+	std::vector<unsigned int> corners(indices.begin(), indices.begin() + numTriangles * 3);
+	std::vector<bool> alive(numTriangles, false);
+	std::vector<bool> pointAlive(numPoints, true);
+	std::vector<std::vector<unsigned int> > pointTriangles(numPoints);
+	std::vector<MeshOptimizerHelpers::Quadric> quadrics(numPoints);
+	for (unsigned int p = 0; p < numPoints; ++p) {
+		MeshOptimizerHelpers::ClearQuadric(quadrics[p]);
+	}
+
+	unsigned int numAlive = 0;
+	std::unordered_map<unsigned long long, unsigned int> edgeUses;
+	for (unsigned int t = 0; t < numTriangles; ++t) {
+		unsigned int p[3] = { pointOf[corners[t * 3]], pointOf[corners[t * 3 + 1]], pointOf[corners[t * 3 + 2]] };
+		if (p[0] == p[1] || p[1] == p[2] || p[0] == p[2]) {
+			continue; // Degenerate, dropped
+		}
+		alive[t] = true;
+		numAlive += 1;
+		vec3 n = cross(position[pointOrder[p[1]]] - position[pointOrder[p[0]]], position[pointOrder[p[2]]] - position[pointOrder[p[0]]]);
+		float doubleArea = sqrtf(lenSq(n));
+		for (unsigned int k = 0; k < 3; ++k) {
+			pointTriangles[p[k]].push_back(t);
+			if (doubleArea > 0.0f) {
+				vec3 unit = n * (1.0f / doubleArea);
+				MeshOptimizerHelpers::AddPlane(quadrics[p[k]], unit, -dot(unit, position[pointOrder[p[0]]]), doubleArea * 0.5);
+			}
+			unsigned int a = p[k];
+			unsigned int b = p[(k + 1) % 3];
+			edgeUses[a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a] += 1;
+		}
+	}
+
+	// A plane through each open edge, perpendicular to its triangle
+	for (unsigned int t = 0; t < numTriangles; ++t) {
+		if (!alive[t]) {
+			continue;
+		}
+		unsigned int p[3] = { pointOf[corners[t * 3]], pointOf[corners[t * 3 + 1]], pointOf[corners[t * 3 + 2]] };
+		vec3 faceNormal = cross(position[pointOrder[p[1]]] - position[pointOrder[p[0]]], position[pointOrder[p[2]]] - position[pointOrder[p[0]]]);
+		for (unsigned int k = 0; k < 3; ++k) {
+			unsigned int a = p[k];
+			unsigned int b = p[(k + 1) % 3];
+			if (edgeUses[a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a] != 1) {
+				continue;
+			}
+			vec3 edge = position[pointOrder[b]] - position[pointOrder[a]];
+			vec3 n = cross(edge, faceNormal);
+			float length = sqrtf(lenSq(n));
+			if (length == 0.0f) {
+				continue;
+			}
+			n = n * (1.0f / length);
+			double d = -dot(n, position[pointOrder[a]]);
+			double weight = MeshOptimizerHelpers::BoundaryWeight * lenSq(edge);
+			MeshOptimizerHelpers::AddPlane(quadrics[a], n, d, weight);
+			MeshOptimizerHelpers::AddPlane(quadrics[b], n, d, weight);
+		}
+	}
+
+	std::priority_queue<MeshOptimizerHelpers::Collapse, std::vector<MeshOptimizerHelpers::Collapse>,
+		MeshOptimizerHelpers::CollapseGreater> queue;
+	MeshOptimizerHelpers::Collapse collapse;
+	for (unsigned int t = 0; t < numTriangles; ++t) {
+		if (!alive[t]) {
+			continue;
+		}
+		for (unsigned int k = 0; k < 3; ++k) {
+			unsigned int a = pointOf[corners[t * 3 + k]];
+			unsigned int b = pointOf[corners[t * 3 + (k + 1) % 3]];
+			const vec3& pa = position[pointOrder[a]];
+			const vec3& pb = position[pointOrder[b]];
+			collapse.mFrom = a;
+			collapse.mTo = b;
+			collapse.mCost = (float)(MeshOptimizerHelpers::QuadricError(quadrics[a], pb) + MeshOptimizerHelpers::QuadricError(quadrics[b], pb));
+			queue.push(collapse);
+			collapse.mFrom = b;
+			collapse.mTo = a;
+			collapse.mCost = (float)(MeshOptimizerHelpers::QuadricError(quadrics[a], pa) + MeshOptimizerHelpers::QuadricError(quadrics[b], pa));
+			queue.push(collapse);
+		}
+	}
+
+	std::vector<unsigned int> fromNeighbours;
+	std::vector<unsigned int> toNeighbours;
+	while (numAlive > targetTriangles && !queue.empty()) {
+		collapse = queue.top();
+		queue.pop();
+		unsigned int from = collapse.mFrom;
+		unsigned int to = collapse.mTo;
+		if (!pointAlive[from] || !pointAlive[to]) {
+			continue;
+		}
+		// Quadrics only grow, a cost that went up since the push goes back in the queue
+		const vec3& target = position[pointOrder[to]];
+		float cost = (float)(MeshOptimizerHelpers::QuadricError(quadrics[from], target) + MeshOptimizerHelpers::QuadricError(quadrics[to], target));
+		if (cost > collapse.mCost) {
+			collapse.mCost = cost;
+			queue.push(collapse);
+			continue;
+		}
+
+		// Still an edge, and only the one or two triangles on it share both ends. More
+		// shared neighbours would pinch the surface into a non manifold edge
+		fromNeighbours.clear();
+		toNeighbours.clear();
+		for (unsigned int pass = 0; pass < 2; ++pass) {
+			unsigned int point = pass == 0 ? from : to;
+			std::vector<unsigned int>& neighbours = pass == 0 ? fromNeighbours : toNeighbours;
+			std::vector<unsigned int>& triangles = pointTriangles[point];
+			for (unsigned int i = 0, size = (unsigned int)triangles.size(); i < size; ++i) {
+				unsigned int t = triangles[i];
+				if (!alive[t]) {
+					continue;
+				}
+				for (unsigned int k = 0; k < 3; ++k) {
+					unsigned int other = pointOf[corners[t * 3 + k]];
+					if (other != point) {
+						MeshOptimizerHelpers::AddUnique(neighbours, other);
+					}
+				}
+			}
+		}
+		bool adjacent = false;
+		unsigned int shared = 0;
+		for (unsigned int i = 0, size = (unsigned int)fromNeighbours.size(); i < size; ++i) {
+			if (fromNeighbours[i] == to) {
+				adjacent = true;
+				continue;
+			}
+			for (unsigned int j = 0, count = (unsigned int)toNeighbours.size(); j < count; ++j) {
+				shared += toNeighbours[j] == fromNeighbours[i] ? 1 : 0;
+			}
+		}
+		if (!adjacent || shared > 2) {
+			continue;
+		}
+
+		// No triangle that survives may turn over
+		bool flips = false;
+		std::vector<unsigned int>& fromTriangles = pointTriangles[from];
+		for (unsigned int i = 0, size = (unsigned int)fromTriangles.size(); i < size && !flips; ++i) {
+			unsigned int t = fromTriangles[i];
+			if (!alive[t]) {
+				continue;
+			}
+			vec3 before[3];
+			vec3 after[3];
+			bool hasTo = false;
+			for (unsigned int k = 0; k < 3; ++k) {
+				unsigned int point = pointOf[corners[t * 3 + k]];
+				hasTo = hasTo || point == to;
+				before[k] = position[pointOrder[point]];
+				after[k] = point == from ? target : before[k];
+			}
+			if (!hasTo) {
+				vec3 n0 = cross(before[1] - before[0], before[2] - before[0]);
+				vec3 n1 = cross(after[1] - after[0], after[2] - after[0]);
+				flips = dot(n0, n1) <= 0.0f;
+			}
+		}
+		if (flips) {
+			continue;
+		}
+
+		// Triangles on the edge go away, the rest take the vertex of to whose normal
+		// and uv are closest to the corner they had
+		for (unsigned int i = 0, size = (unsigned int)fromTriangles.size(); i < size; ++i) {
+			unsigned int t = fromTriangles[i];
+			if (!alive[t]) {
+				continue;
+			}
+			unsigned int* corner = &corners[t * 3];
+			if (pointOf[corner[0]] == to || pointOf[corner[1]] == to || pointOf[corner[2]] == to) {
+				alive[t] = false;
+				numAlive -= 1;
+				continue;
+			}
+			for (unsigned int k = 0; k < 3; ++k) {
+				unsigned int v = corner[k];
+				if (pointOf[v] != from) {
+					continue;
+				}
+				unsigned int best = pointVertices[pointVertexOffsets[to]];
+				float bestDistance = -1.0f;
+				for (unsigned int j = pointVertexOffsets[to]; j < pointVertexOffsets[to + 1]; ++j) {
+					unsigned int w = pointVertices[j];
+					float distance = 0.0f;
+					if (normal.size() == numVerts) {
+						distance += lenSq(normal[w] - normal[v]);
+					}
+					if (texCoord.size() == numVerts) {
+						vec2 d(texCoord[w].x - texCoord[v].x, texCoord[w].y - texCoord[v].y);
+						distance += d.x * d.x + d.y * d.y;
+					}
+					if (bestDistance < 0.0f || distance < bestDistance) {
+						bestDistance = distance;
+						best = w;
+					}
+				}
+				corner[k] = best;
+			}
+			pointTriangles[to].push_back(t);
+		}
+		pointAlive[from] = false;
+		fromTriangles.clear();
+		MeshOptimizerHelpers::AddQuadric(quadrics[to], quadrics[from]);
+
+		// Every edge around to has a new cost
+		std::vector<unsigned int>& toTriangles = pointTriangles[to];
+		unsigned int numKept = 0;
+		for (unsigned int i = 0, size = (unsigned int)toTriangles.size(); i < size; ++i) {
+			if (alive[toTriangles[i]]) {
+				toTriangles[numKept++] = toTriangles[i];
+			}
+		}
+		toTriangles.resize(numKept);
+		toNeighbours.clear();
+		for (unsigned int i = 0; i < numKept; ++i) {
+			for (unsigned int k = 0; k < 3; ++k) {
+				unsigned int other = pointOf[corners[toTriangles[i] * 3 + k]];
+				if (other != to) {
+					MeshOptimizerHelpers::AddUnique(toNeighbours, other);
+				}
+			}
+		}
+		for (unsigned int i = 0, size = (unsigned int)toNeighbours.size(); i < size; ++i) {
+			unsigned int other = toNeighbours[i];
+			const vec3& pTo = position[pointOrder[to]];
+			const vec3& pOther = position[pointOrder[other]];
+			collapse.mFrom = to;
+			collapse.mTo = other;
+			collapse.mCost = (float)(MeshOptimizerHelpers::QuadricError(quadrics[to], pOther) + MeshOptimizerHelpers::QuadricError(quadrics[other], pOther));
+			queue.push(collapse);
+			collapse.mFrom = other;
+			collapse.mTo = to;
+			collapse.mCost = (float)(MeshOptimizerHelpers::QuadricError(quadrics[to], pTo) + MeshOptimizerHelpers::QuadricError(quadrics[other], pTo));
+			queue.push(collapse);
+		}
+	}
+
+	// Keep the vertices the surviving triangles use, in the order they use them
+	std::vector<unsigned int> remap(numVerts, numVerts);
+	std::vector<unsigned int> order;
+	std::vector<unsigned int>& outIndices = outMesh.GetIndices();
+	outIndices.resize(numAlive * 3);
+	for (unsigned int t = 0, i = 0; t < numTriangles; ++t) {
+		if (!alive[t]) {
+			continue;
+		}
+		for (unsigned int k = 0; k < 3; ++k) {
+			unsigned int v = corners[t * 3 + k];
+			if (remap[v] == numVerts) {
+				remap[v] = (unsigned int)order.size();
+				order.push_back(v);
+			}
+			outIndices[i++] = remap[v];
+		}
+	}
+	MeshOptimizerHelpers::Select(outMesh.GetPosition(), position, order, numVerts);
+	MeshOptimizerHelpers::Select(outMesh.GetNormal(), normal, order, numVerts);
+	MeshOptimizerHelpers::Select(outMesh.GetTexCoord(), texCoord, order, numVerts);
+	MeshOptimizerHelpers::Select(outMesh.GetWeights(), mesh.GetWeights(), order, numVerts);
+	MeshOptimizerHelpers::Select(outMesh.GetInfluences(), mesh.GetInfluences(), order, numVerts);
+}
+
+void BuildLODChain(std::vector<MeshLOD>& outLODs, std::vector<Mesh>& meshes,
+	const std::vector<float>& ratios, const std::vector<float>& screenSizes) {
+	unsigned int numLevels = (unsigned int)ratios.size() + 1;
+	outLODs.clear();
+	outLODs.resize(numLevels);
+	outLODs[0].mMeshes = meshes;
+	for (unsigned int level = 0; level < numLevels; ++level) {
+		outLODs[level].mMinScreenSize = level < screenSizes.size() && level + 1 < numLevels ? screenSizes[level] : 0.0f;
+	}
+
+	unsigned int numMeshes = (unsigned int)meshes.size();
+	for (unsigned int level = 1; level < numLevels; ++level) {
+		std::vector<Mesh>& lod = outLODs[level].mMeshes;
+		lod.resize(numMeshes);
+		for (unsigned int i = 0; i < numMeshes; ++i) {
+			Mesh& source = meshes[i];
+			Mesh& mesh = lod[i];
+			unsigned int numTriangles = (unsigned int)source.GetIndices().size() / 3;
+			unsigned int target = (unsigned int)((float)numTriangles * ratios[level - 1]);
+			SimplifyMesh(mesh, source, target > 0 ? target : 1);
+			OptimizeVertexCache(mesh);
+			if (source.GetInfluenceVertexCount(4) != (unsigned int)source.GetPosition().size()) {
+				mesh.SortByInfluenceCount();
+			}
+			mesh.SetStreamingSkin(source.IsStreamingSkin());
+			if (!(source.IsCompact() && mesh.SetCompact(true))) {
+				mesh.SetInterleaved(source.IsInterleaved()); // Uploads either way
+			}
+		}
+	}
+}
+
+unsigned int SelectLOD(const std::vector<MeshLOD>& lods, float screenSize) {
+	unsigned int size = (unsigned int)lods.size();
+	for (unsigned int i = 0; i < size; ++i) {
+		if (screenSize >= lods[i].mMinScreenSize) {
+			return i;
+		}
+	}
+	return size > 0 ? size - 1 : 0;
+}
+
+float GetScreenSize(float radius, float distance, float fovY, float viewportHeight) {
+	float halfHeight = distance * tanf(fovY * 3.14159265359f / 360.0f);
+	if (halfHeight <= 0.0f) {
+		return viewportHeight;
+	}
+	return radius / halfHeight * viewportHeight;
+}
+
+float GetBoundingRadius(std::vector<Mesh>& meshes, vec3& outCenter) {
+	vec3 min, max;
+	bool empty = true;
+	for (unsigned int i = 0, size = (unsigned int)meshes.size(); i < size; ++i) {
+		std::vector<vec3>& position = meshes[i].GetPosition();
+		for (unsigned int j = 0, count = (unsigned int)position.size(); j < count; ++j) {
+			const vec3& p = position[j];
+			if (empty) {
+				min = max = p;
+				empty = false;
+				continue;
+			}
+			min = vec3(fminf(min.x, p.x), fminf(min.y, p.y), fminf(min.z, p.z));
+			max = vec3(fmaxf(max.x, p.x), fmaxf(max.y, p.y), fmaxf(max.z, p.z));
+		}
+	}
+	outCenter = (min + max) * 0.5f;
+	float radius = 0.0f;
+	for (unsigned int i = 0, size = (unsigned int)meshes.size(); i < size; ++i) {
+		std::vector<vec3>& position = meshes[i].GetPosition();
+		for (unsigned int j = 0, count = (unsigned int)position.size(); j < count; ++j) {
+			float distance = lenSq(position[j] - outCenter);
+			radius = distance > radius ? distance : radius;
+		}
+	}
+	return sqrtf(radius);
+}
@@ -0,0 +1,74 @@
+#ifndef _H_MESHOPTIMIZER_
+#define _H_MESHOPTIMIZER_
+
+#include <vector>
+#include "Mesh.h"
+
+// Vertices the triangle order is optimized for, and the FIFO cache the statistics
+// simulate. Hardware caches are somewhere in between, an order good for one is good
+// for the other.
+#define VERTEX_CACHE_OPTIMIZE_SIZE 32
+#define VERTEX_CACHE_MEASURE_SIZE 16
+
+// ACMR is transformed vertices per triangle, 3 at worst and about 0.5 for a large
+// regular grid. ATVR is transformed vertices per referenced vertex, 1 at best.
+struct VertexCacheStats {
+	float mACMR;
+	float mATVR;
+};
+
+VertexCacheStats GetVertexCacheStats(const std::vector<unsigned int>& indices, unsigned int numVerts,
+	unsigned int cacheSize = VERTEX_CACHE_MEASURE_SIZE);
+
+// Reorders the count triangles starting at index first for the post transform vertex
+// cache, Tom Forsyth's linear speed greedy algorithm. Triangles outside the range stay
+// where they are, so the influence groups of a sorted mesh each get optimized alone.
+void OptimizeTriangleOrder(std::vector<unsigned int>& indices, unsigned int numVerts,
+	unsigned int first, unsigned int count);
+
+// Renumbers the vertices in the order the indices first use them and remaps the
+// indices. A vertex only moves inside its group, groups holds numGroups + 1 vertex
+// offsets. outOrder[new vertex] is the old vertex, unused vertices go last in their group.
+void OptimizeVertexOrder(std::vector<unsigned int>& indices, unsigned int numVerts,
+	const unsigned int* groups, unsigned int numGroups, std::vector<unsigned int>& outOrder);
+
+// Merges vertices whose attributes are all bit identical and remaps the indices,
+// exporters often write a vertex per triangle corner. Returns the new vertex count.
+// Influence groups are not kept, sort the mesh again after welding it.
+unsigned int WeldVertices(Mesh& mesh);
+
+// Both passes over every influence group of mesh, reordering all its attributes. An
+// unsorted mesh is welded first. Without reorderVertices only the triangles move, for
+// meshes whose vertices are referred to by index elsewhere. Does not upload, call
+// UpdateOpenGLBuffers after. Traces the cache statistics before and after as name if
+// it is not 0.
+void OptimizeVertexCache(Mesh& mesh, const char* name = 0, bool reorderVertices = true);
+
+// Quadric error edge collapse (Garland and Heckbert) down to at most targetTriangles.
+// Vertices sharing a position are one vertex of the surface, and a collapse moves one
+// onto a neighbour instead of a new point, so every output vertex is an input vertex
+// with its normal, uv, weights and joints unchanged and skinning stays exact. Open
+// edges are weighted to keep their shape. outMesh is not uploaded or optimized.
+void SimplifyMesh(Mesh& outMesh, Mesh& mesh, unsigned int targetTriangles);
+
+// One level of detail of a model made of several meshes. The level is drawn while the
+// model's projected size is at least mMinScreenSize pixels.
+struct MeshLOD {
+	std::vector<Mesh> mMeshes;
+	float mMinScreenSize;
+};
+
+// Level 0 is meshes and level i + 1 keeps about ratios[i] of their triangles. Level i
+// is drawn down to screenSizes[i] pixels and the last level below that, both vectors
+// are the same size. Every level is optimized, sorted by influence count if meshes
+// are, and uploaded like its source.
+void BuildLODChain(std::vector<MeshLOD>& outLODs, std::vector<Mesh>& meshes,
+	const std::vector<float>& ratios, const std::vector<float>& screenSizes);
+// The most detailed level whose minimum screen size fits, the last one if none does
+unsigned int SelectLOD(const std::vector<MeshLOD>& lods, float screenSize);
+// Height in pixels of a sphere distance away, fovY in degrees like perspective
+float GetScreenSize(float radius, float distance, float fovY, float viewportHeight);
+// Bounding sphere of the meshes' bind pose positions, centered on their bounds
+float GetBoundingRadius(std::vector<Mesh>& meshes, vec3& outCenter);
+
+#endif
@@ -2,10 +2,14 @@
 
 Pose::Pose()
 {
+    mCacheGlobals = false;
+    mChildrenValid = false;
 }
 
 Pose::Pose(const Pose& p)
 {
+    mCacheGlobals = p.mCacheGlobals;
+    mChildrenValid = false;
     *this = p;
 }
 
@@ -31,11 +35,24 @@ Pose& Pose::operator=(const Pose& p)
             sizeof(Transform) * mJoints.size());
     }
 
+    // The cache setting belongs to this pose, only its contents are copied
+    mChildrenValid = false;
+    if (mCacheGlobals && p.mCacheGlobals && p.mDirty.size() == mJoints.size()) {
+        mGlobals = p.mGlobals;
+        mGlobalMatrices = p.mGlobalMatrices;
+        mDirty = p.mDirty;
+    }
+    else {
+        InvalidateAll();
+    }
+
     return *this;
 }
 
 Pose::Pose(unsigned int numJoints)
 {
+    mCacheGlobals = false;
+    mChildrenValid = false;
     Resize(numJoints);
 }
 
@@ -43,6 +60,8 @@ void Pose::Resize(unsigned int size)
 {
     mParents.resize(size);
     mJoints.resize(size);
+    mChildrenValid = false;
+    InvalidateAll();
 }
 
 unsigned int Pose::Size()
@@ -58,9 +77,139 @@ Transform Pose::GetLocalTransform(unsigned int index)
 void Pose::SetLocalTransform(unsigned int index,
     const Transform& transform) {
     mJoints[index] = transform;
+    if (mCacheGlobals) {
+        InvalidateSubtree(index);
+    }
+}
+
+Transform* Pose::GetLocalTransforms() {
+    InvalidateAll();
+    return mJoints.size() == 0 ? 0 : &mJoints[0];
+}
+
+void Pose::EnableGlobalCache(bool enable) {
+    mCacheGlobals = enable;
+    mChildrenValid = false;
+    if (enable) {
+        InvalidateAll();
+    }
+    else {
+        mGlobals.clear();
+        mGlobalMatrices.clear();
+        mDirty.clear();
+        mFirstChild.clear();
+        mNextSibling.clear();
+    }
+}
+
+bool Pose::IsGlobalCacheEnabled() {
+    return mCacheGlobals;
+}
+
+void Pose::UpdateChildren() {
+    unsigned int size = Size();
+    mFirstChild.assign(size, -1);
+    mNextSibling.assign(size, -1);
+    for (unsigned int i = size; i > 0; --i) { // Backwards keeps siblings in index order
+        int parent = mParents[i - 1];
+        if (parent >= 0) {
+            mNextSibling[i - 1] = mFirstChild[parent];
+            mFirstChild[parent] = (int)(i - 1);
+        }
+    }
+    mChildrenValid = true;
+}
+
+void Pose::InvalidateAll() {
+    if (!mCacheGlobals) {
+        return;
+    }
+    unsigned int size = Size();
+    mGlobals.resize(size);
+    mGlobalMatrices.resize(size);
+    mDirty.assign(size, DirtyAll);
+}
+
+void Pose::InvalidateSubtree(unsigned int index) {
+    if (mDirty.size() != Size()) {
+        InvalidateAll();
+        return;
+    }
+    if (mDirty[index] == DirtyAll) {
+        return;
+    }
+    if (!mChildrenValid) {
+        UpdateChildren();
+    }
+
+    // Depth first, the first child and next sibling links double as the stack
+    mDirty[index] = DirtyAll;
+    int joint = mFirstChild[index];
+    while (joint >= 0) {
+        int next = -1;
+        if (mDirty[joint] != DirtyAll) {
+            mDirty[joint] = DirtyAll;
+            next = mFirstChild[joint];
+        }
+        while (next < 0 && joint >= 0 && joint != (int)index) {
+            next = mNextSibling[joint];
+            if (next < 0) {
+                joint = mParents[joint];
+            }
+        }
+        if (joint == (int)index) {
+            break;
+        }
+        joint = next;
+    }
+}
+
+const Transform& Pose::UpdateGlobalTransform(unsigned int index) {
+    if (!(mDirty[index] & DirtyTransform)) {
+        return mGlobals[index];
+    }
+
+    // Find the closest clean ancestor, then walk back down
+    unsigned int chain[64];
+    unsigned int depth = 0;
+    int joint = (int)index;
+    while (joint >= 0 && (mDirty[joint] & DirtyTransform)) {
+        if (depth == 64) { // Deeper than any rig, resolve the upper part first
+            UpdateGlobalTransform((unsigned int)joint);
+            break;
+        }
+        chain[depth++] = (unsigned int)joint;
+        joint = mParents[joint];
+    }
+    for (unsigned int i = depth; i > 0; --i) {
+        unsigned int current = chain[i - 1];
+        int parent = mParents[current];
+        mGlobals[current] = parent >= 0 ? combine(mGlobals[parent], mJoints[current]) : mJoints[current];
+        mDirty[current] &= ~DirtyTransform;
+    }
+    return mGlobals[index];
+}
+
+void Pose::UpdateGlobals() {
+    if (!mCacheGlobals) {
+        return;
+    }
+    if (mDirty.size() != Size()) {
+        InvalidateAll();
+    }
+    for (unsigned int i = 0, size = Size(); i < size; ++i) {
+        UpdateGlobalTransform(i);
+    }
 }
 
 Transform Pose::GetGlobalTransform(unsigned int index) {
+    if (mCacheGlobals) {
+        if (mDirty.size() != Size()) {
+            InvalidateAll();
+        }
+        return UpdateGlobalTransform(index);
+    }
+
     Transform result = mJoints[index];
     for (int parent = mParents[index]; parent >= 0;
         parent = mParents[parent]) {
@@ -86,12 +235,109 @@ void Pose::GetMatrixPalette(std::vector<mat4>& out) {
 	}
 }
 
+void Pose::GetMatrixPalette(std::vector<mat4>& out, const std::vector<unsigned int>& order) {
+	unsigned int size = Size();
+	if (order.size() != size) {
+		GetMatrixPalette(out);
+		return;
+	}
+	if (out.size() != size) {
+		out.resize(size);
+	}
+
+	if (mCacheGlobals) {
+		// Parents come first, a dirty joint's parent matrix is already up to date. Clean
+		// joints are a copy. Every matrix is clean after the pass, so the dirty matrices
+		// still form subtrees
+		if (mDirty.size() != size) {
+			InvalidateAll();
+		}
+		for (unsigned int i = 0; i < size; ++i) {
+			unsigned int joint = order[i];
+			if (mDirty[joint] & DirtyMatrix) {
+				mat4 local = transformToMat4(mJoints[joint]);
+				int parent = mParents[joint];
+				mGlobalMatrices[joint] = parent >= 0 ? mGlobalMatrices[parent] * local : local;
+				mDirty[joint] &= ~DirtyMatrix;
+			}
+			out[joint] = mGlobalMatrices[joint];
+		}
+		return;
+	}
+
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int joint = order[i];
+		mat4 local = transformToMat4(mJoints[joint]);
+		int parent = mParents[joint];
+		out[joint] = parent >= 0 ? out[parent] * local : local;
+	}
+}
+
+// Built from the global transform rather than by chaining joint dual quaternions, so
+// parent scale still moves the children. Only the joint's own global scale is lost,
+// and it cancels against the inverse bind pose as long as it does not animate.
+DualQuaternion Pose::GetGlobalDualQuaternion(unsigned int index) {
+	return transformToDualQuat(GetGlobalTransform(index));
+}
+
+void Pose::GetDualQuaternionPalette(std::vector<DualQuaternion>& out) {
+	unsigned int size = Size();
+	if (out.size() != size) {
+		out.resize(size);
+	}
+
+	for (unsigned int i = 0; i < size; ++i) {
+		out[i] = GetGlobalDualQuaternion(i);
+	}
+}
+
+void Pose::GetDualQuaternionPalette(std::vector<DualQuaternion>& out, const std::vector<unsigned int>& order,
+	std::vector<Transform>& globals) {
+	unsigned int size = Size();
+	if (order.size() != size) {
+		GetDualQuaternionPalette(out);
+		return;
+	}
+	if (out.size() != size) {
+		out.resize(size);
+	}
+
+	if (!mCacheGlobals) {
+		if (globals.size() != size) {
+			globals.resize(size);
+		}
+		for (unsigned int i = 0; i < size; ++i) {
+			unsigned int joint = order[i];
+			int parent = mParents[joint];
+			globals[joint] = parent >= 0 ? combine(globals[parent], mJoints[joint]) : mJoints[joint];
+			out[joint] = transformToDualQuat(globals[joint]);
+		}
+		return;
+	}
+
+	// Only the dirty joints are recomputed
+	if (mDirty.size() != size) {
+		InvalidateAll();
+	}
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int joint = order[i];
+		if (mDirty[joint] & DirtyTransform) {
+			int parent = mParents[joint];
+			mGlobals[joint] = parent >= 0 ? combine(mGlobals[parent], mJoints[joint]) : mJoints[joint];
+			mDirty[joint] &= ~DirtyTransform;
+		}
+		out[joint] = transformToDualQuat(mGlobals[joint]);
+	}
+}
+
 int Pose::GetParent(unsigned int index) {
     return mParents[index];
 }
 
 void Pose::SetParent(unsigned int index, int parent) {
     mParents[index] = parent;
+    mChildrenValid = false;
+    InvalidateAll();
 }
 
 
@@ -124,3 +370,41 @@ bool Pose::operator==(const Pose& other) {
 bool Pose::operator!=(const Pose& other) {
 	return !(*this == other);
 }
+
+void MakeDeltaPose(Pose& outPose, Pose& pose) {
+    unsigned int size = pose.Size();
+    if (outPose.Size() != size) {
+        outPose.Resize(size);
+    }
+    Transform identity(vec3(0, 0, 0), quat(0, 0, 0, 1), vec3(0, 0, 0));
+    for (unsigned int i = 0; i < size; ++i) {
+        outPose.SetParent(i, pose.GetParent(i));
+        outPose.SetLocalTransform(i, identity);
+    }
+}
+
+void AddDelta(Pose& output, Pose& base, Pose& delta, float weight) {
+    unsigned int size = base.Size();
+    if (output.Size() != size) {
+        output.Resize(size);
+        for (unsigned int i = 0; i < size; ++i) {
+            output.SetParent(i, base.GetParent(i));
+        }
+    }
+    Transform* out = output.GetLocalTransforms();
+    quat identity;
+    for (unsigned int i = 0; i < size; ++i) {
+        Transform in = base.GetLocalTransform(i);
+        Transform d = delta.GetLocalTransform(i);
+        quat rotation = d.rotation;
+        if (weight != 1.0f) {
+            if (rotation.w < 0.0f) {
+                rotation = -rotation;
+            }
+            rotation = nlerp(identity, rotation, weight);
+        }
+        out[i].position = in.position + d.position * weight;
+        out[i].rotation = normalized(in.rotation * rotation);
+        out[i].scale = in.scale + d.scale * weight;
+    }
+}
@@ -3,11 +3,28 @@
 
 #include <vector>
 #include "Transform.h"
+#include "DualQuaternion.h"
 
 class Pose {
 protected:
 	std::vector<Transform> mJoints;
 	std::vector<int> mParents;
+	// Optional global transform cache. A dirty joint's descendants are always dirty too,
+	// so invalidating a subtree can stop at the first joint that is already dirty. The
+	// ordered palette keeps its global matrices, dirty on their own bit.
+	enum { DirtyTransform = 1, DirtyMatrix = 2, DirtyAll = 3 };
+	std::vector<Transform> mGlobals;
+	std::vector<mat4> mGlobalMatrices;
+	std::vector<unsigned char> mDirty;
+	std::vector<int> mFirstChild;
+	std::vector<int> mNextSibling;
+	bool mCacheGlobals;
+	bool mChildrenValid;
+protected:
+	void UpdateChildren();
+	void InvalidateSubtree(unsigned int index);
+	void InvalidateAll();
+	const Transform& UpdateGlobalTransform(unsigned int index);
 public:
 	Pose();
 	Pose(const Pose& p);
@@ -18,9 +35,33 @@ public:
 
 	Transform GetLocalTransform(unsigned int index);
 	void SetLocalTransform(unsigned int index, const Transform& transform);
+	// All local transforms, for samplers that write channels in place. Invalidates every
+	// cached global transform.
+	Transform* GetLocalTransforms();
+	// With the cache on, global queries and palettes only recompute joints whose local
+	// transform, or an ancestor's, changed since the last query. Those queries write the
+	// cache, so a pose with the cache on must not be queried from several threads at
+	// once. After UpdateGlobals, GetGlobalTransform only reads until the next edit
+	void EnableGlobalCache(bool enable);
+	bool IsGlobalCacheEnabled();
+	// Recomputes every dirty cached global transform, does nothing with the cache off
+	void UpdateGlobals();
 	Transform GetGlobalTransform(unsigned int index);
 	Transform operator[](unsigned int index);
 	void GetMatrixPalette(std::vector<mat4>& out);
+	// One pass, each joint is its parent's matrix times its local matrix. order must list
+	// every joint after its parent (Skeleton::GetJointOrder). With the cache on only the
+	// dirty joints are recomputed, in the same pass.
+	void GetMatrixPalette(std::vector<mat4>& out, const std::vector<unsigned int>& order);
+	// The global transform without its scale, dual quaternions only hold rotation and
+	// translation
+	DualQuaternion GetGlobalDualQuaternion(unsigned int index);
+	void GetDualQuaternionPalette(std::vector<DualQuaternion>& out);
+	// One pass like the ordered GetMatrixPalette, 8 floats per joint instead of 16. With the
+	// cache off the pass keeps its global transforms in globals and only reads the pose,
+	// with it on globals is not touched
+	void GetDualQuaternionPalette(std::vector<DualQuaternion>& out, const std::vector<unsigned int>& order,
+		std::vector<Transform>& globals);
 	int GetParent(unsigned int index);
 	void SetParent(unsigned int index, int parent);
 
@@ -28,4 +69,11 @@ public:
 	bool operator!=(const Pose& other);
 };
 
+// A pose with the same hierarchy as pose whose joints are all the identity delta, zero
+// position and scale offsets and an identity rotation. Additive clips are sampled into it.
+void MakeDeltaPose(Pose& outPose, Pose& pose);
+// output = base with every joint's delta applied, scaled by weight. Positions and scales
+// add the delta, rotations multiply by it, nlerped from identity. output may be base.
+void AddDelta(Pose& output, Pose& base, Pose& delta, float weight);
+
 #endif
@@ -0,0 +1,85 @@
+#include "QuantizedTrack.h"
+
+template QuantizedTrack<float, 1>;
+template QuantizedTrack<vec3, 3>;
+template QuantizedTrack<quat, 4>;
+
+template QuantizedTrack<float, 1> QuantizeTrack(Track<float, 1>& input);
+template QuantizedTrack<vec3, 3> QuantizeTrack(Track<vec3, 3>& input);
+template QuantizedTrack<quat, 4> QuantizeTrack(Track<quat, 4>& input);
+
+template<> int QuantizedTrack<float, 1>::ValueWords() {
+	return 1;
+}
+
+template<> int QuantizedTrack<vec3, 3>::ValueWords() {
+	return 3;
+}
+
+template<> int QuantizedTrack<quat, 4>::ValueWords() {
+	return 3;
+}
+
+template<> void QuantizedTrack<float, 1>::Encode(const float& value, unsigned short* out) {
+	out[0] = QuantizedTrackHelpers::Quantize(value, mMin[0], mExtent[0]);
+}
+
+template<> void QuantizedTrack<vec3, 3>::Encode(const vec3& value, unsigned short* out) {
+	for (int i = 0; i < 3; ++i) {
+		out[i] = QuantizedTrackHelpers::Quantize(value.v[i], mMin[i], mExtent[i]);
+	}
+}
+
+template<> void QuantizedTrack<quat, 4>::Encode(const quat& value, unsigned short* out) {
+	int largest = 0;
+	for (int i = 1; i < 4; ++i) {
+		if (fabsf(value.v[i]) > fabsf(value.v[largest])) {
+			largest = i;
+		}
+	}
+	// q and -q are the same rotation, store the one with a positive largest component
+	float sign = value.v[largest] < 0.0f ? -1.0f : 1.0f;
+	for (int i = 0, j = 0; i < 4; ++i) {
+		if (i != largest) {
+			out[j++] = QuantizedTrackHelpers::QuantizeSmallest(value.v[i] * sign);
+		}
+	}
+	out[0] |= (unsigned short)((largest & 2) << 14);
+	out[1] |= (unsigned short)((largest & 1) << 15);
+}
+
+template<> float QuantizedTrack<float, 1>::Decode(const unsigned short* in) {
+	return QuantizedTrackHelpers::Dequantize(in[0], mMin[0], mExtent[0]);
+}
+
+template<> vec3 QuantizedTrack<vec3, 3>::Decode(const unsigned short* in) {
+	return vec3(
+		QuantizedTrackHelpers::Dequantize(in[0], mMin[0], mExtent[0]),
+		QuantizedTrackHelpers::Dequantize(in[1], mMin[1], mExtent[1]),
+		QuantizedTrackHelpers::Dequantize(in[2], mMin[2], mExtent[2])
+	);
+}
+
+template<> quat QuantizedTrack<quat, 4>::Decode(const unsigned short* in) {
+	int largest = ((in[0] >> 14) & 2) | (in[1] >> 15);
+	float a = QuantizedTrackHelpers::DequantizeSmallest(in[0]);
+	float b = QuantizedTrackHelpers::DequantizeSmallest(in[1]);
+	float c = QuantizedTrackHelpers::DequantizeSmallest(in[2]);
+	float d = 1.0f - a * a - b * b - c * c;
+	d = d > 0.0f ? sqrtf(d) : 0.0f;
+
+	// Unit length up to the quantization step, the sampler normalizes after blending
+	quat result;
+	float smallest[3] = { a, b, c };
+	for (int i = 0, j = 0; i < 4; ++i) {
+		result.v[i] = i == largest ? d : smallest[j++];
+	}
+	return result;
+}
+
+template<typename T, int N>
+QuantizedTrack<T, N> QuantizeTrack(Track<T, N>& input) {
+	QuantizedTrack<T, N> result;
+	result.Set(input);
+	return result;
+}
@@ -0,0 +1,244 @@
+#ifndef _H_QUANTIZEDTRACK_
+#define _H_QUANTIZEDTRACK_
+
+#include <vector>
+#include <cmath>
+
+#include "Track.h"
+#include "CompactTrack.h"
+
+// A track that stores its keys as 16 bit integers and decompresses them while sampling.
+// Scalar and vector values are normalized to the min / max range of the track, rotations
+// are stored smallest three, 15 bits for each of the three smallest components and the
+// index of the largest one in the two spare bits (48 bits per key). Cubic tangents are
+// normalized to their own range. Key times stay floats, in their own array.
+template<typename T, int N>
+class QuantizedTrack {
+protected:
+	std::vector<float> mTimes;
+	std::vector<unsigned short> mValues;
+	std::vector<unsigned short> mTangents; // Cubic only, in then out, N words each
+	float mMin[N];
+	float mExtent[N];
+	float mTangentMin[N];
+	float mTangentExtent[N];
+	Interpolation mInterpolation;
+protected:
+	int ValueWords();
+	void Encode(const T& value, unsigned short* out);
+	T Decode(const unsigned short* in);
+	T DecodeTangent(const unsigned short* in);
+	T SampleFrame(int frame, float trackTime);
+public:
+	QuantizedTrack();
+	void Set(Track<T, N>& input);
+	unsigned int Size();
+	Interpolation GetInterpolation();
+	float GetStartTime() const;
+	float GetEndTime() const;
+	T Sample(float time, bool looping);
+	T Sample(float time, bool looping, TrackCursor& cursor);
+	T GetValue(unsigned int index);
+	unsigned int GetMemorySize();
+};
+
+typedef QuantizedTrack<float, 1> QuantizedScalarTrack;
+typedef QuantizedTrack<vec3, 3> QuantizedVectorTrack;
+typedef QuantizedTrack<quat, 4> QuantizedQuaternionTrack;
+
+template<typename T, int N>
+QuantizedTrack<T, N> QuantizeTrack(Track<T, N>& input);
+
+namespace QuantizedTrackHelpers {
+	inline unsigned short Quantize(float value, float min, float extent) {
+		if (extent <= 0.0f) {
+			return 0;
+		}
+		float t = (value - min) / extent;
+		t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+		return (unsigned short)(t * 65535.0f + 0.5f);
+	}
+
+	inline float Dequantize(unsigned short value, float min, float extent) {
+		return min + extent * ((float)value * (1.0f / 65535.0f));
+	}
+
+	// Range a track uses for component c, values points at the first of count keys
+	inline void Range(const float* values, unsigned int count, unsigned int stride, float& outMin, float& outExtent) {
+		if (count == 0) {
+			outMin = 0.0f;
+			outExtent = 0.0f;
+			return;
+		}
+		float min = values[0];
+		float max = values[0];
+		for (unsigned int i = 1; i < count; ++i) {
+			float v = values[i * stride];
+			min = v < min ? v : min;
+			max = v > max ? v : max;
+		}
+		outMin = min;
+		outExtent = max - min;
+	}
+
+	// The three smallest components of a unit quaternion are within +/- sqrt(0.5)
+	inline unsigned short QuantizeSmallest(float value) {
+		const float range = 0.70710678f;
+		float t = (value + range) / (2.0f * range);
+		t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+		return (unsigned short)(t * 32767.0f + 0.5f);
+	}
+
+	inline float DequantizeSmallest(unsigned short value) {
+		const float range = 0.70710678f;
+		return ((float)(value & 0x7FFF) * (1.0f / 32767.0f)) * (2.0f * range) - range;
+	}
+
+	// Sign the quaternion is stored with, the largest component is always kept positive
+	inline float StoredSign(float) { return 1.0f; }
+	inline float StoredSign(const vec3&) { return 1.0f; }
+	inline float StoredSign(const quat& value) {
+		int largest = 0;
+		for (int i = 1; i < 4; ++i) {
+			if (fabsf(value.v[i]) > fabsf(value.v[largest])) {
+				largest = i;
+			}
+		}
+		return value.v[largest] < 0.0f ? -1.0f : 1.0f;
+	}
+} // End QuantizedTrackHelpers namespace
+
+template<typename T, int N>
+QuantizedTrack<T, N>::QuantizedTrack() {
+	mInterpolation = Interpolation::Linear;
+	for (int i = 0; i < N; ++i) {
+		mMin[i] = mExtent[i] = 0.0f;
+		mTangentMin[i] = mTangentExtent[i] = 0.0f;
+	}
+}
+
+template<typename T, int N>
+void QuantizedTrack<T, N>::Set(Track<T, N>& input) {
+	mInterpolation = input.GetInterpolation();
+	unsigned int size = input.Size();
+	int words = ValueWords();
+
+	mTimes.resize(size);
+	mValues.resize(size * words);
+	mTangents.clear();
+	for (unsigned int i = 0; i < size; ++i) {
+		mTimes[i] = input[i].mTime;
+	}
+	for (int c = 0; c < N; ++c) {
+		if (size > 0) {
+			QuantizedTrackHelpers::Range(&input[0].mValue[c], size, sizeof(Frame<N>) / sizeof(float), mMin[c], mExtent[c]);
+		}
+	}
+	for (unsigned int i = 0; i < size; ++i) {
+		Encode(input.GetValue(i), &mValues[i * words]);
+	}
+	if (mInterpolation != Interpolation::Cubic || size == 0) {
+		return;
+	}
+
+	// Tangents follow the sign the value was stored with
+	std::vector<float> tangents(size * N * 2);
+	for (unsigned int i = 0; i < size; ++i) {
+		float sign = QuantizedTrackHelpers::StoredSign(input.GetValue(i));
+		for (int c = 0; c < N; ++c) {
+			tangents[i * N * 2 + c] = input[i].mIn[c] * sign;
+			tangents[i * N * 2 + N + c] = input[i].mOut[c] * sign;
+		}
+	}
+	for (int c = 0; c < N; ++c) {
+		QuantizedTrackHelpers::Range(&tangents[c], size * 2, N, mTangentMin[c], mTangentExtent[c]);
+	}
+	mTangents.resize(tangents.size());
+	for (unsigned int i = 0, count = (unsigned int)tangents.size(); i < count; ++i) {
+		int c = i % N;
+		mTangents[i] = QuantizedTrackHelpers::Quantize(tangents[i], mTangentMin[c], mTangentExtent[c]);
+	}
+}
+
+template<typename T, int N>
+unsigned int QuantizedTrack<T, N>::Size() {
+	return (unsigned int)mTimes.size();
+}
+
+template<typename T, int N>
+Interpolation QuantizedTrack<T, N>::GetInterpolation() {
+	return mInterpolation;
+}
+
+template<typename T, int N>
+float QuantizedTrack<T, N>::GetStartTime() const {
+	return mTimes.front();
+}
+
+template<typename T, int N>
+float QuantizedTrack<T, N>::GetEndTime() const {
+	return mTimes.back();
+}
+
+template<typename T, int N>
+T QuantizedTrack<T, N>::GetValue(unsigned int index) {
+	return Decode(&mValues[index * ValueWords()]);
+}
+
+template<typename T, int N>
+unsigned int QuantizedTrack<T, N>::GetMemorySize() {
+	return (unsigned int)(sizeof(float) * mTimes.size() + sizeof(unsigned short) * (mValues.size() + mTangents.size()) +
+		sizeof(float) * N * 4);
+}
+
+template<typename T, int N>
+T QuantizedTrack<T, N>::DecodeTangent(const unsigned short* in) {
+	T result;
+	float* v = (float*)&result;
+	for (int c = 0; c < N; ++c) {
+		v[c] = QuantizedTrackHelpers::Dequantize(in[c], mTangentMin[c], mTangentExtent[c]);
+	}
+	return result;
+}
+
+template<typename T, int N>
+T QuantizedTrack<T, N>::SampleFrame(int thisFrame, float trackTime) {
+	if (thisFrame < 0) {
+		return T();
+	}
+	int words = ValueWords();
+	T value1 = Decode(&mValues[thisFrame * words]);
+	if (mInterpolation == Interpolation::Constant) {
+		return value1;
+	}
+
+	int nextFrame = thisFrame + 1;
+	float frameDelta = mTimes[nextFrame] - mTimes[thisFrame];
+	if (frameDelta <= 0.0f) {
+		return T();
+	}
+	float t = (trackTime - mTimes[thisFrame]) / frameDelta;
+	T value2 = Decode(&mValues[nextFrame * words]);
+
+	if (mInterpolation == Interpolation::Linear) {
+		return TrackHelpers::Interpolate(value1, value2, t);
+	}
+
+	T slope1 = DecodeTangent(&mTangents[thisFrame * N * 2 + N]); // out
+	T slope2 = DecodeTangent(&mTangents[nextFrame * N * 2]); // in
+	return TrackHelpers::Hermite(t, value1, slope1 * frameDelta, value2, slope2 * frameDelta);
+}
+
+template<typename T, int N>
+T QuantizedTrack<T, N>::Sample(float time, bool looping) {
+	float trackTime = CompactTrackHelpers::AdjustTimeToFitTrack(mTimes, time, looping);
+	return SampleFrame(CompactTrackHelpers::FrameIndex(mTimes, trackTime), trackTime);
+}
+
+template<typename T, int N>
+T QuantizedTrack<T, N>::Sample(float time, bool looping, TrackCursor& cursor) {
+	float trackTime = CompactTrackHelpers::AdjustTimeToFitTrack(mTimes, time, looping);
+	return SampleFrame(CompactTrackHelpers::FrameIndex(mTimes, trackTime, cursor), trackTime);
+}
+
+#endif
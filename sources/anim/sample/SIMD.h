@@ -0,0 +1,190 @@
+#ifndef _H_SIMD_
+#define _H_SIMD_
+
+#include <cmath>
+#include <el_platform.h>
+
+// Thin wrapper over the widest float vector the target is built for. AVX builds
+// process 8 lanes, other x86 builds use SSE2 (always present on x64), anything
+// else falls back to a 4 lane scalar loop with the same interface.
+// Loads and stores are unaligned, std::vector storage is only float aligned.
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SIMD_WIDTH 8
+
+typedef __m256 simdf;
+
+inline simdf simdLoad(const float* p) { return _mm256_loadu_ps(p); }
+inline void simdStore(float* p, const simdf& v) { _mm256_storeu_ps(p, v); }
+inline simdf simdLoadMask(const unsigned int* p) { return _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)p)); }
+// Lane i of out[r] reads base[indices[i] + r], four consecutive floats per lane
+inline void simdLoadTransposed(const float* base, const int* indices, simdf* out) {
+	__m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(base + indices[0])), _mm_loadu_ps(base + indices[4]), 1);
+	__m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(base + indices[1])), _mm_loadu_ps(base + indices[5]), 1);
+	__m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(base + indices[2])), _mm_loadu_ps(base + indices[6]), 1);
+	__m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(base + indices[3])), _mm_loadu_ps(base + indices[7]), 1);
+	__m256 a0 = _mm256_unpacklo_ps(r0, r1);
+	__m256 a1 = _mm256_unpackhi_ps(r0, r1);
+	__m256 a2 = _mm256_unpacklo_ps(r2, r3);
+	__m256 a3 = _mm256_unpackhi_ps(r2, r3);
+	out[0] = _mm256_shuffle_ps(a0, a2, _MM_SHUFFLE(1, 0, 1, 0));
+	out[1] = _mm256_shuffle_ps(a0, a2, _MM_SHUFFLE(3, 2, 3, 2));
+	out[2] = _mm256_shuffle_ps(a1, a3, _MM_SHUFFLE(1, 0, 1, 0));
+	out[3] = _mm256_shuffle_ps(a1, a3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+inline simdf simdSet(float f) { return _mm256_set1_ps(f); }
+inline simdf simdZero() { return _mm256_setzero_ps(); }
+inline simdf simdAdd(const simdf& a, const simdf& b) { return _mm256_add_ps(a, b); }
+inline simdf simdSub(const simdf& a, const simdf& b) { return _mm256_sub_ps(a, b); }
+inline simdf simdMul(const simdf& a, const simdf& b) { return _mm256_mul_ps(a, b); }
+inline simdf simdDiv(const simdf& a, const simdf& b) { return _mm256_div_ps(a, b); }
+inline simdf simdSqrt(const simdf& a) { return _mm256_sqrt_ps(a); }
+inline simdf simdMin(const simdf& a, const simdf& b) { return _mm256_min_ps(a, b); }
+inline simdf simdMax(const simdf& a, const simdf& b) { return _mm256_max_ps(a, b); }
+inline simdf simdAnd(const simdf& a, const simdf& b) { return _mm256_and_ps(a, b); }
+inline simdf simdXor(const simdf& a, const simdf& b) { return _mm256_xor_ps(a, b); }
+inline simdf simdLess(const simdf& a, const simdf& b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+// mask ? a : b, mask lanes must be all ones or all zeros
+inline simdf simdSelect(const simdf& mask, const simdf& a, const simdf& b) { return _mm256_blendv_ps(b, a, mask); }
+#if defined(__FMA__)
+inline simdf simdMadd(const simdf& a, const simdf& b, const simdf& c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+inline simdf simdMadd(const simdf& a, const simdf& b, const simdf& c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+
+#elif EL_ARCH_X86_64 || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_WIDTH 4
+
+typedef __m128 simdf;
+
+inline simdf simdLoad(const float* p) { return _mm_loadu_ps(p); }
+inline void simdStore(float* p, const simdf& v) { _mm_storeu_ps(p, v); }
+inline simdf simdLoadMask(const unsigned int* p) { return _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)p)); }
+inline void simdLoadTransposed(const float* base, const int* indices, simdf* out) {
+	__m128 r0 = _mm_loadu_ps(base + indices[0]);
+	__m128 r1 = _mm_loadu_ps(base + indices[1]);
+	__m128 r2 = _mm_loadu_ps(base + indices[2]);
+	__m128 r3 = _mm_loadu_ps(base + indices[3]);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	out[0] = r0;
+	out[1] = r1;
+	out[2] = r2;
+	out[3] = r3;
+}
+inline simdf simdSet(float f) { return _mm_set1_ps(f); }
+inline simdf simdZero() { return _mm_setzero_ps(); }
+inline simdf simdAdd(const simdf& a, const simdf& b) { return _mm_add_ps(a, b); }
+inline simdf simdSub(const simdf& a, const simdf& b) { return _mm_sub_ps(a, b); }
+inline simdf simdMul(const simdf& a, const simdf& b) { return _mm_mul_ps(a, b); }
+inline simdf simdDiv(const simdf& a, const simdf& b) { return _mm_div_ps(a, b); }
+inline simdf simdSqrt(const simdf& a) { return _mm_sqrt_ps(a); }
+inline simdf simdMin(const simdf& a, const simdf& b) { return _mm_min_ps(a, b); }
+inline simdf simdMax(const simdf& a, const simdf& b) { return _mm_max_ps(a, b); }
+inline simdf simdAnd(const simdf& a, const simdf& b) { return _mm_and_ps(a, b); }
+inline simdf simdXor(const simdf& a, const simdf& b) { return _mm_xor_ps(a, b); }
+inline simdf simdLess(const simdf& a, const simdf& b) { return _mm_cmplt_ps(a, b); }
+inline simdf simdSelect(const simdf& mask, const simdf& a, const simdf& b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline simdf simdMadd(const simdf& a, const simdf& b, const simdf& c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+#else
+#include <cstring>
+#define SIMD_WIDTH 4
+
+struct simdf {
+	float v[4];
+};
+
+namespace SIMDHelpers {
+	inline unsigned int Bits(float f) { unsigned int u; memcpy(&u, &f, sizeof(float)); return u; }
+	inline float Float(unsigned int u) { float f; memcpy(&f, &u, sizeof(float)); return f; }
+}
+
+#define SIMD_SCALAR_OP(expr) simdf r; for (int i = 0; i < 4; ++i) { r.v[i] = expr; } return r;
+
+inline simdf simdLoad(const float* p) { simdf r; memcpy(r.v, p, sizeof(r.v)); return r; }
+inline void simdStore(float* p, const simdf& v) { memcpy(p, v.v, sizeof(v.v)); }
+inline simdf simdLoadMask(const unsigned int* p) { simdf r; memcpy(r.v, p, sizeof(r.v)); return r; }
+inline simdf simdSet(float f) { SIMD_SCALAR_OP(f) }
+inline simdf simdZero() { SIMD_SCALAR_OP(0.0f) }
+inline simdf simdAdd(const simdf& a, const simdf& b) { SIMD_SCALAR_OP(a.v[i] + b.v[i]) }
+inline simdf simdSub(const simdf& a, const simdf& b) { SIMD_SCALAR_OP(a.v[i] - b.v[i]) }
+inline simdf simdMul(const simdf& a, const simdf& b) { SIMD_SCALAR_OP(a.v[i] * b.v[i]) }
+inline simdf simdDiv(const simdf& a, const simdf& b) { SIMD_SCALAR_OP(a.v[i] / b.v[i]) }
+inline simdf simdSqrt(const simdf& a) { SIMD_SCALAR_OP(sqrtf(a.v[i])) }
+inline simdf simdMin(const simdf& a, const simdf& b) { SIMD_SCALAR_OP(a.v[i] < b.v[i] ? a.v[i] : b.v[i]) }
+inline simdf simdMax(const simdf& a, const simdf& b) { SIMD_SCALAR_OP(a.v[i] > b.v[i] ? a.v[i] : b.v[i]) }
+inline simdf simdAnd(const simdf& a, const simdf& b) { SIMD_SCALAR_OP(SIMDHelpers::Float(SIMDHelpers::Bits(a.v[i]) & SIMDHelpers::Bits(b.v[i]))) }
+inline simdf simdXor(const simdf& a, const simdf& b) { SIMD_SCALAR_OP(SIMDHelpers::Float(SIMDHelpers::Bits(a.v[i]) ^ SIMDHelpers::Bits(b.v[i]))) }
+inline simdf simdLess(const simdf& a, const simdf& b) { SIMD_SCALAR_OP(SIMDHelpers::Float(a.v[i] < b.v[i] ? 0xFFFFFFFFu : 0u)) }
+inline simdf simdSelect(const simdf& mask, const simdf& a, const simdf& b) { SIMD_SCALAR_OP(SIMDHelpers::Bits(mask.v[i]) ? a.v[i] : b.v[i]) }
+inline simdf simdMadd(const simdf& a, const simdf& b, const simdf& c) { SIMD_SCALAR_OP(a.v[i] * b.v[i] + c.v[i]) }
+
+inline void simdLoadTransposed(const float* base, const int* indices, simdf* out) {
+	for (int r = 0; r < 4; ++r) {
+		for (int i = 0; i < 4; ++i) {
+			out[r].v[i] = base[indices[i] + r];
+		}
+	}
+}
+
+#undef SIMD_SCALAR_OP
+#endif
+
+// Shared helpers built on the primitives above
+
+inline simdf simdLerp(const simdf& a, const simdf& b, const simdf& t) {
+	return simdMadd(simdSub(b, a), t, a);
+}
+
+// Flips the sign of the lanes of x where condition is negative
+inline simdf simdFlipSign(const simdf& x, const simdf& condition) {
+	return simdXor(x, simdAnd(condition, simdSet(-0.0f)));
+}
+
+// Four component dot product, a and b point at the x, y, z and w vectors
+inline simdf simdDot4(const simdf* a, const simdf* b) {
+	simdf d = simdMul(a[0], b[0]);
+	d = simdMadd(a[1], b[1], d);
+	d = simdMadd(a[2], b[2], d);
+	return simdMadd(a[3], b[3], d);
+}
+
+inline void simdNormalize4(simdf* q) {
+	simdf invLen = simdDiv(simdSet(1.0f), simdSqrt(simdDot4(q, q)));
+	for (int i = 0; i < 4; ++i) {
+		q[i] = simdMul(q[i], invLen);
+	}
+}
+
+// Lane wise quaternion product, same order convention as operator*(quat, quat)
+inline void simdQuatMul(const simdf* q1, const simdf* q2, simdf* out) {
+	simdf x = simdMul(q2[0], q1[3]);
+	x = simdMadd(q2[1], q1[2], x);
+	x = simdSub(x, simdMul(q2[2], q1[1]));
+	x = simdMadd(q2[3], q1[0], x);
+	simdf y = simdMul(q2[1], q1[3]);
+	y = simdSub(y, simdMul(q2[0], q1[2]));
+	y = simdMadd(q2[2], q1[0], y);
+	y = simdMadd(q2[3], q1[1], y);
+	simdf z = simdMul(q2[0], q1[1]);
+	z = simdSub(z, simdMul(q2[1], q1[0]));
+	z = simdMadd(q2[2], q1[3], z);
+	z = simdMadd(q2[3], q1[2], z);
+	simdf w = simdMul(q2[3], q1[3]);
+	w = simdSub(w, simdMul(q2[0], q1[0]));
+	w = simdSub(w, simdMul(q2[1], q1[1]));
+	w = simdSub(w, simdMul(q2[2], q1[2]));
+	out[0] = x;
+	out[1] = y;
+	out[2] = z;
+	out[3] = w;
+}
+
+// Rounds count up to a whole number of SIMD lanes
+inline unsigned int simdPadded(unsigned int count) {
+	return (count + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+}
+
+#endif // _H_SIMD_
@@ -15,6 +15,7 @@ void Skeleton::Set(const Pose& rest, const Pose& bind, const std::vector<std::st
 	mBindPose = bind;
 	mJointNames = names;
 	UpdateInverseBindPose();
+	UpdateJointOrder();
 }
 
 void Skeleton::UpdateInverseBindPose()
@@ -22,9 +23,33 @@ void Skeleton::UpdateInverseBindPose()
 	unsigned int size = mBindPose.Size();
 	mInvBindPose.resize(size);
 
+	mDualQuaternionInvBindPose.resize(size);
+
 	for (unsigned int i = 0; i < size; ++i) {
 		Transform world = mBindPose.GetGlobalTransform(i);
 		mInvBindPose[i] = inverse(transformToMat4(world));
+		mDualQuaternionInvBindPose[i] = conjugate(transformToDualQuat(world));
+	}
+}
+
+void Skeleton::UpdateJointOrder()
+{
+	unsigned int size = mRestPose.Size();
+	mJointOrder.clear();
+	mJointOrder.reserve(size);
+
+	// Emit the unvisited part of every joint's parent chain, root first
+	std::vector<bool> visited(size, false);
+	std::vector<unsigned int> chain;
+	for (unsigned int i = 0; i < size; ++i) {
+		chain.clear();
+		for (int joint = (int)i; joint >= 0 && !visited[joint]; joint = mRestPose.GetParent(joint)) {
+			visited[joint] = true;
+			chain.push_back((unsigned int)joint);
+		}
+		for (unsigned int j = (unsigned int)chain.size(); j > 0; --j) {
+			mJointOrder.push_back(chain[j - 1]);
+		}
 	}
 }
 
@@ -47,3 +72,33 @@ std::vector<std::string>& Skeleton::GetJointNames() {
 std::string& Skeleton::GetJointName(unsigned int idx) {
 	return mJointNames[idx];
 }
+
+std::vector<unsigned int>& Skeleton::GetJointOrder() {
+	return mJointOrder;
+}
+
+void Skeleton::GetSkinPalette(Pose& pose, std::vector<mat4>& out) {
+	pose.GetMatrixPalette(out, mJointOrder);
+	unsigned int size = (unsigned int)out.size();
+	if (size > mInvBindPose.size()) {
+		size = (unsigned int)mInvBindPose.size();
+	}
+	for (unsigned int i = 0; i < size; ++i) {
+		out[i] = out[i] * mInvBindPose[i];
+	}
+}
+
+std::vector<DualQuaternion>& Skeleton::GetDualQuaternionInvBindPose() {
+	return mDualQuaternionInvBindPose;
+}
+
+void Skeleton::GetDualQuaternionSkinPalette(Pose& pose, std::vector<DualQuaternion>& out, std::vector<Transform>& globals) {
+	pose.GetDualQuaternionPalette(out, mJointOrder, globals);
+	unsigned int size = (unsigned int)out.size();
+	if (size > mDualQuaternionInvBindPose.size()) {
+		size = (unsigned int)mDualQuaternionInvBindPose.size();
+	}
+	for (unsigned int i = 0; i < size; ++i) {
+		out[i] = mDualQuaternionInvBindPose[i] * out[i];
+	}
+}
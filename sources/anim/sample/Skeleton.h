@@ -11,9 +11,12 @@ protected:
 	Pose mRestPose;
 	Pose mBindPose;
 	std::vector<mat4> mInvBindPose;
+	std::vector<DualQuaternion> mDualQuaternionInvBindPose;
 	std::vector<std::string> mJointNames;
+	std::vector<unsigned int> mJointOrder; // Every joint after its parent
 protected:
 	void UpdateInverseBindPose();
+	void UpdateJointOrder();
 public:
 	Skeleton();
 	Skeleton(const Pose& rest, const Pose& bind, const std::vector<std::string>& names);
@@ -25,6 +28,15 @@ public:
 	std::vector<mat4>& GetInvBindPose();
 	std::vector<std::string>& GetJointNames();
 	std::string& GetJointName(unsigned int index);
+	// Joint indices sorted so parents come before their children, see Pose::GetMatrixPalette
+	std::vector<unsigned int>& GetJointOrder();
+	// Final skinning matrices, pose palette times inverse bind pose, one product per joint.
+	// Build it once per frame and share it between every mesh of the character.
+	void GetSkinPalette(Pose& pose, std::vector<mat4>& out);
+	// The same for dual quaternion skinning, inverse bind pose first then the pose.
+	// globals is scratch for Pose::GetDualQuaternionPalette, keep it with out
+	std::vector<DualQuaternion>& GetDualQuaternionInvBindPose();
+	void GetDualQuaternionSkinPalette(Pose& pose, std::vector<DualQuaternion>& out, std::vector<Transform>& globals);
 };
 
 #endif 
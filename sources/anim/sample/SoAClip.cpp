@@ -0,0 +1,325 @@
+#include "SoAClip.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SoAClipHelpers {
+	template<typename T, int N>
+	bool SameTimeline(Track<T, N>& track, const std::vector<float>& times, Interpolation interpolation) {
+		unsigned int size = track.Size();
+		if (size != times.size() || track.GetInterpolation() != interpolation) {
+			return false;
+		}
+		for (unsigned int i = 0; i < size; ++i) {
+			if (fabsf(track[i].mTime - times[i]) > 0.00001f) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename T, int N>
+	void ReadTimeline(Track<T, N>& track, std::vector<float>& outTimes, Interpolation& outInterpolation) {
+		unsigned int size = track.Size();
+		outTimes.resize(size);
+		for (unsigned int i = 0; i < size; ++i) {
+			outTimes[i] = track[i].mTime;
+		}
+		outInterpolation = track.GetInterpolation();
+	}
+
+	inline void Normalize(float* v, int n) {
+		if (n != 4) {
+			return;
+		}
+		float lenSq = v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3];
+		if (lenSq < QUAT_EPSILON) {
+			return;
+		}
+		float invLen = 1.0f / sqrtf(lenSq);
+		for (int i = 0; i < 4; ++i) {
+			v[i] *= invLen;
+		}
+	}
+
+	inline void Write(float* block, unsigned int padded, unsigned int component, unsigned int joint, const float* v, int n) {
+		for (int i = 0; i < n; ++i) {
+			block[(component + i) * padded + joint] = v[i];
+		}
+	}
+
+	// Copies (shared timeline) or resamples one channel into the key blocks
+	template<typename T, int N>
+	void WriteTrack(SoAClip& clip, std::vector<float>& keys, std::vector<unsigned int>& masks, const std::vector<float>& times,
+		Track<T, N>& track, bool resample, unsigned int keyStride, unsigned int blockSize,
+		unsigned int padded, unsigned int component, unsigned int joint) {
+		if (track.Size() == 0) {
+			return;
+		}
+		for (int i = 0; i < N; ++i) {
+			masks[(component + i) * padded + joint] = 0xFFFFFFFFu;
+		}
+
+		unsigned int numKeys = (unsigned int)times.size();
+		for (unsigned int k = 0; k < numKeys; ++k) {
+			float* key = &keys[k * keyStride];
+			if (track.Size() == 1) { // Constant, same value in every key, tangents stay zero
+				T value = track.GetValue(0);
+				Write(key, padded, component, joint, (const float*)&value, N);
+				continue;
+			}
+			if (resample) {
+				T value = track.Sample(times[k], false);
+				Write(key, padded, component, joint, (const float*)&value, N);
+				continue;
+			}
+			Frame<N>& frame = track[k];
+			float value[N];
+			memcpy(value, frame.mValue, sizeof(value));
+			Normalize(value, N);
+			Write(key, padded, component, joint, value, N);
+			if (clip.GetInterpolation() == Interpolation::Cubic) {
+				Write(key + blockSize, padded, component, joint, frame.mIn, N);
+				Write(key + blockSize * 2, padded, component, joint, frame.mOut, N);
+			}
+		}
+	}
+} // End SoAClipHelpers namespace
+
+SoAClip::SoAClip() {
+	mName = "No name given";
+	mInterpolation = Interpolation::Linear;
+	mNumJoints = 0;
+	mPaddedJoints = 0;
+	mStartTime = 0.0f;
+	mEndTime = 0.0f;
+	mLooping = true;
+}
+
+unsigned int SoAClip::BlockSize() {
+	return mPaddedJoints * SoAPose::NumComponents;
+}
+
+unsigned int SoAClip::KeyStride() {
+	return mInterpolation == Interpolation::Cubic ? BlockSize() * 3 : BlockSize();
+}
+
+void SoAClip::Set(Clip& clip, unsigned int numJoints, float sampleRate) {
+	mName = clip.GetName();
+	mLooping = clip.GetLooping();
+	mStartTime = clip.GetStartTime();
+	mEndTime = clip.GetEndTime();
+	mNumJoints = numJoints;
+	mPaddedJoints = simdPadded(numJoints);
+	mTimes.clear();
+
+	// Use the source keys directly if every animated channel lines up
+	bool shared = true;
+	unsigned int numTracks = clip.Size();
+	for (unsigned int i = 0; i < numTracks && shared; ++i) {
+		unsigned int joint = clip.GetIdAtIndex(i);
+		if (joint >= numJoints) {
+			continue;
+		}
+		TransformTrack& track = clip[joint];
+		VectorTrack& position = track.GetPositionTrack();
+		QuaternionTrack& rotation = track.GetRotationTrack();
+		VectorTrack& scale = track.GetScaleTrack();
+		if (mTimes.size() == 0) {
+			if (position.Size() > 1) {
+				SoAClipHelpers::ReadTimeline(position, mTimes, mInterpolation);
+			}
+			else if (rotation.Size() > 1) {
+				SoAClipHelpers::ReadTimeline(rotation, mTimes, mInterpolation);
+			}
+			else if (scale.Size() > 1) {
+				SoAClipHelpers::ReadTimeline(scale, mTimes, mInterpolation);
+			}
+		}
+		shared = (position.Size() <= 1 || SoAClipHelpers::SameTimeline(position, mTimes, mInterpolation)) &&
+			(rotation.Size() <= 1 || SoAClipHelpers::SameTimeline(rotation, mTimes, mInterpolation)) &&
+			(scale.Size() <= 1 || SoAClipHelpers::SameTimeline(scale, mTimes, mInterpolation));
+	}
+
+	bool resample = !shared || mTimes.size() < 2;
+	if (resample) {
+		mInterpolation = Interpolation::Linear;
+		unsigned int numKeys = 2;
+		if (sampleRate > 0.0f) {
+			// Round away float noise so clips exported at sampleRate land on their own keys
+			numKeys = std::max(2u, (unsigned int)ceilf((mEndTime - mStartTime) * sampleRate - 0.001f) + 1);
+		}
+		mTimes.resize(numKeys);
+		for (unsigned int k = 0; k < numKeys; ++k) {
+			float time = mStartTime + (mEndTime - mStartTime) * (float)k / (float)(numKeys - 1);
+			mTimes[k] = time;
+		}
+	}
+
+	unsigned int keyStride = KeyStride();
+	mKeys.assign(mTimes.size() * keyStride, 0.0f);
+	mMasks.assign(BlockSize(), 0u);
+	for (unsigned int i = 0; i < numTracks; ++i) {
+		unsigned int joint = clip.GetIdAtIndex(i);
+		if (joint >= numJoints) {
+			continue;
+		}
+		TransformTrack& track = clip[joint];
+		SoAClipHelpers::WriteTrack(*this, mKeys, mMasks, mTimes, track.GetPositionTrack(), resample,
+			keyStride, BlockSize(), mPaddedJoints, SoAPose::PositionX, joint);
+		SoAClipHelpers::WriteTrack(*this, mKeys, mMasks, mTimes, track.GetRotationTrack(), resample,
+			keyStride, BlockSize(), mPaddedJoints, SoAPose::RotationX, joint);
+		SoAClipHelpers::WriteTrack(*this, mKeys, mMasks, mTimes, track.GetScaleTrack(), resample,
+			keyStride, BlockSize(), mPaddedJoints, SoAPose::ScaleX, joint);
+	}
+}
+
+float SoAClip::Sample(SoAPose& outPose, float time) {
+	if (GetDuration() == 0.0f || mTimes.size() < 2) {
+		return 0.0f;
+	}
+	time = AdjustTimeToFitRange(time);
+	if (outPose.Size() != mNumJoints) {
+		outPose.Resize(mNumJoints);
+	}
+
+	// One search for every joint
+	std::vector<float>::iterator next = std::upper_bound(mTimes.begin() + 1, mTimes.end() - 1, time);
+	unsigned int frame = (unsigned int)(next - mTimes.begin()) - 1;
+	float frameDelta = mTimes[frame + 1] - mTimes[frame];
+	float t = 0.0f;
+	if (frameDelta > 0.0f) {
+		t = (time - mTimes[frame]) / frameDelta;
+	}
+
+	unsigned int padded = mPaddedJoints;
+	unsigned int blockSize = BlockSize();
+	unsigned int keyStride = KeyStride();
+	const float* key0 = &mKeys[frame * keyStride];
+	const float* key1 = key0 + keyStride;
+	simdf vt = simdSet(t);
+
+	// Hermite basis, only used by cubic clips
+	float tt = t * t;
+	float ttt = tt * t;
+	simdf h1 = simdSet(2.0f * ttt - 3.0f * tt + 1.0f);
+	simdf h2 = simdSet(-2.0f * ttt + 3.0f * tt);
+	simdf h3 = simdSet((ttt - 2.0f * tt + t) * frameDelta);
+	simdf h4 = simdSet((ttt - tt) * frameDelta);
+
+	for (unsigned int j = 0; j < padded; j += SIMD_WIDTH) {
+		simdf result[SoAPose::NumComponents];
+		if (mInterpolation == Interpolation::Constant) {
+			for (unsigned int c = 0; c < SoAPose::NumComponents; ++c) {
+				result[c] = simdLoad(key0 + c * padded + j);
+			}
+		}
+		else if (mInterpolation == Interpolation::Linear) {
+			simdf a[SoAPose::NumComponents];
+			simdf b[SoAPose::NumComponents];
+			for (unsigned int c = 0; c < SoAPose::NumComponents; ++c) {
+				a[c] = simdLoad(key0 + c * padded + j);
+				b[c] = simdLoad(key1 + c * padded + j);
+			}
+			// Neighborhood, then nlerp the rotations
+			simdf d = simdDot4(&a[SoAPose::RotationX], &b[SoAPose::RotationX]);
+			for (unsigned int c = SoAPose::RotationX; c <= SoAPose::RotationW; ++c) {
+				b[c] = simdFlipSign(b[c], d);
+			}
+			for (unsigned int c = 0; c < SoAPose::NumComponents; ++c) {
+				result[c] = simdLerp(a[c], b[c], vt);
+			}
+			simdNormalize4(&result[SoAPose::RotationX]);
+		}
+		else {
+			simdf p1[SoAPose::NumComponents];
+			simdf p2[SoAPose::NumComponents];
+			for (unsigned int c = 0; c < SoAPose::NumComponents; ++c) {
+				p1[c] = simdLoad(key0 + c * padded + j);
+				p2[c] = simdLoad(key1 + c * padded + j);
+			}
+			simdf d = simdDot4(&p1[SoAPose::RotationX], &p2[SoAPose::RotationX]);
+			for (unsigned int c = SoAPose::RotationX; c <= SoAPose::RotationW; ++c) {
+				p2[c] = simdFlipSign(p2[c], d);
+			}
+			for (unsigned int c = 0; c < SoAPose::NumComponents; ++c) {
+				simdf s1 = simdLoad(key0 + blockSize * 2 + c * padded + j); // out tangent
+				simdf s2 = simdLoad(key1 + blockSize + c * padded + j); // in tangent
+				simdf r = simdMul(p1[c], h1);
+				r = simdMadd(p2[c], h2, r);
+				r = simdMadd(s1, h3, r);
+				result[c] = simdMadd(s2, h4, r);
+			}
+			simdNormalize4(&result[SoAPose::RotationX]);
+		}
+
+		// Channels the clip does not animate keep what is already in the pose
+		for (unsigned int c = 0; c < SoAPose::NumComponents; ++c) {
+			float* out = outPose.GetComponent(c) + j;
+			simdf mask = simdLoadMask(&mMasks[c * padded + j]);
+			simdStore(out, simdSelect(mask, result[c], simdLoad(out)));
+		}
+	}
+
+	return time;
+}
+
+float SoAClip::AdjustTimeToFitRange(float inTime) {
+	if (mLooping) {
+		float duration = mEndTime - mStartTime;
+		if (duration <= 0) {
+			return 0.0f;
+		}
+		inTime = fmodf(inTime - mStartTime, mEndTime - mStartTime);
+		if (inTime < 0.0f) {
+			inTime += mEndTime - mStartTime;
+		}
+		inTime = inTime + mStartTime;
+	}
+	else {
+		if (inTime < mStartTime) {
+			inTime = mStartTime;
+		}
+		if (inTime > mEndTime) {
+			inTime = mEndTime;
+		}
+	}
+	return inTime;
+}
+
+unsigned int SoAClip::Size() {
+	return (unsigned int)mTimes.size();
+}
+
+Interpolation SoAClip::GetInterpolation() {
+	return mInterpolation;
+}
+
+std::string& SoAClip::GetName() {
+	return mName;
+}
+
+float SoAClip::GetDuration() {
+	return mEndTime - mStartTime;
+}
+
+float SoAClip::GetStartTime() {
+	return mStartTime;
+}
+
+float SoAClip::GetEndTime() {
+	return mEndTime;
+}
+
+bool SoAClip::GetLooping() {
+	return mLooping;
+}
+
+void SoAClip::SetLooping(bool inLooping) {
+	mLooping = inLooping;
+}
+
+SoAClip MakeSoAClip(Clip& clip, unsigned int numJoints, float sampleRate) {
+	SoAClip result;
+	result.Set(clip, numJoints, sampleRate);
+	return result;
+}
@@ -0,0 +1,46 @@
+#ifndef _H_SOACLIP_
+#define _H_SOACLIP_
+
+#include <vector>
+#include <string>
+#include "Clip.h"
+#include "SoAPose.h"
+
+// A clip evaluated SIMD_WIDTH joints at a time. Every joint shares one timeline, so a
+// single frame search serves the whole skeleton, and each key is stored in the same
+// component major layout as SoAPose. Cubic clips store value, in and out blocks per key.
+class SoAClip {
+protected:
+	std::vector<float> mTimes;
+	std::vector<float> mKeys;
+	std::vector<unsigned int> mMasks;
+	std::string mName;
+	Interpolation mInterpolation;
+	unsigned int mNumJoints;
+	unsigned int mPaddedJoints;
+	float mStartTime;
+	float mEndTime;
+	bool mLooping;
+protected:
+	float AdjustTimeToFitRange(float inTime);
+	unsigned int BlockSize();
+	unsigned int KeyStride();
+public:
+	SoAClip();
+	// Keeps the source keys when every animated channel shares the same key times,
+	// otherwise resamples all channels linearly at sampleRate
+	void Set(Clip& clip, unsigned int numJoints, float sampleRate);
+	float Sample(SoAPose& outPose, float inTime);
+	unsigned int Size();
+	Interpolation GetInterpolation();
+	std::string& GetName();
+	float GetDuration();
+	float GetStartTime();
+	float GetEndTime();
+	bool GetLooping();
+	void SetLooping(bool inLooping);
+};
+
+SoAClip MakeSoAClip(Clip& clip, unsigned int numJoints, float sampleRate = 30.0f);
+
+#endif
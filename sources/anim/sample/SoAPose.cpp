@@ -0,0 +1,334 @@
+#include "SoAPose.h"
+#include <algorithm>
+
+SoAPose::SoAPose() {
+	mSize = 0;
+	mPaddedSize = 0;
+}
+
+SoAPose::SoAPose(unsigned int numJoints) {
+	mSize = 0;
+	mPaddedSize = 0;
+	Resize(numJoints);
+}
+
+void SoAPose::Resize(unsigned int size) {
+	if (size == mSize) {
+		return;
+	}
+	mSize = size;
+	mPaddedSize = simdPadded(size);
+	mParents.resize(size);
+	mData.resize(mPaddedSize * NumComponents);
+
+	// Identity transforms, padding lanes included, keep every lane finite
+	for (unsigned int i = 0; i < mPaddedSize; ++i) {
+		SetLocalTransform(i, Transform());
+	}
+}
+
+unsigned int SoAPose::Size() {
+	return mSize;
+}
+
+unsigned int SoAPose::PaddedSize() {
+	return mPaddedSize;
+}
+
+float* SoAPose::GetComponent(unsigned int component) {
+	return &mData[component * mPaddedSize];
+}
+
+Transform SoAPose::GetLocalTransform(unsigned int index) {
+	const float* d = &mData[index];
+	unsigned int s = mPaddedSize;
+	return Transform(
+		vec3(d[PositionX * s], d[PositionY * s], d[PositionZ * s]),
+		quat(d[RotationX * s], d[RotationY * s], d[RotationZ * s], d[RotationW * s]),
+		vec3(d[ScaleX * s], d[ScaleY * s], d[ScaleZ * s]));
+}
+
+void SoAPose::SetLocalTransform(unsigned int index, const Transform& t) {
+	float* d = &mData[index];
+	unsigned int s = mPaddedSize;
+	d[PositionX * s] = t.position.x;
+	d[PositionY * s] = t.position.y;
+	d[PositionZ * s] = t.position.z;
+	d[RotationX * s] = t.rotation.x;
+	d[RotationY * s] = t.rotation.y;
+	d[RotationZ * s] = t.rotation.z;
+	d[RotationW * s] = t.rotation.w;
+	d[ScaleX * s] = t.scale.x;
+	d[ScaleY * s] = t.scale.y;
+	d[ScaleZ * s] = t.scale.z;
+}
+
+int SoAPose::GetParent(unsigned int index) {
+	return mParents[index];
+}
+
+void SoAPose::SetParent(unsigned int index, int parent) {
+	mParents[index] = parent;
+}
+
+void SoAPose::FromPose(Pose& pose) {
+	unsigned int size = pose.Size();
+	Resize(size);
+	for (unsigned int i = 0; i < size; ++i) {
+		SetLocalTransform(i, pose.GetLocalTransform(i));
+		mParents[i] = pose.GetParent(i);
+	}
+}
+
+void SoAPose::ToPose(Pose& outPose) {
+	if (outPose.Size() != mSize) {
+		outPose.Resize(mSize);
+	}
+	// Parents rarely change, and setting one invalidates a cached pose
+	for (unsigned int i = 0; i < mSize; ++i) {
+		if (outPose.GetParent(i) != mParents[i]) {
+			outPose.SetParent(i, mParents[i]);
+		}
+	}
+	Transform* joints = outPose.GetLocalTransforms();
+	for (unsigned int i = 0; i < mSize; ++i) {
+		joints[i] = GetLocalTransform(i);
+	}
+}
+
+void SoAPose::GetMatrixPalette(std::vector<mat4>& out, const std::vector<unsigned int>& order) {
+	unsigned int size = mSize;
+	unsigned int padded = mPaddedSize;
+	if (out.size() != size) {
+		out.resize(size);
+	}
+	mLocalMatrices.resize(padded * 12);
+
+	// Rotation basis scaled per axis, then the position. Same expansion as
+	// quat * vec3, so non unit rotations match transformToMat4.
+	const float* d = &mData[0];
+	float* m = &mLocalMatrices[0];
+	for (unsigned int j = 0; j < padded; j += SIMD_WIDTH) {
+		simdf x = simdLoad(d + RotationX * padded + j);
+		simdf y = simdLoad(d + RotationY * padded + j);
+		simdf z = simdLoad(d + RotationZ * padded + j);
+		simdf w = simdLoad(d + RotationW * padded + j);
+		simdf xx = simdMul(x, x), yy = simdMul(y, y), zz = simdMul(z, z), ww = simdMul(w, w);
+		simdf xy = simdMul(x, y), xz = simdMul(x, z), yz = simdMul(y, z);
+		simdf wx = simdMul(w, x), wy = simdMul(w, y), wz = simdMul(w, z);
+		simdf two = simdSet(2.0f);
+		simdf sx = simdLoad(d + ScaleX * padded + j);
+		simdf sy = simdLoad(d + ScaleY * padded + j);
+		simdf sz = simdLoad(d + ScaleZ * padded + j);
+
+		simdf basis[12];
+		basis[0] = simdMul(simdSub(simdAdd(ww, xx), simdAdd(yy, zz)), sx);
+		basis[1] = simdMul(simdMul(two, simdAdd(xy, wz)), sx);
+		basis[2] = simdMul(simdMul(two, simdSub(xz, wy)), sx);
+		basis[3] = simdMul(simdMul(two, simdSub(xy, wz)), sy);
+		basis[4] = simdMul(simdSub(simdAdd(ww, yy), simdAdd(xx, zz)), sy);
+		basis[5] = simdMul(simdMul(two, simdAdd(yz, wx)), sy);
+		basis[6] = simdMul(simdMul(two, simdAdd(xz, wy)), sz);
+		basis[7] = simdMul(simdMul(two, simdSub(yz, wx)), sz);
+		basis[8] = simdMul(simdSub(simdAdd(ww, zz), simdAdd(xx, yy)), sz);
+		basis[9] = simdLoad(d + PositionX * padded + j);
+		basis[10] = simdLoad(d + PositionY * padded + j);
+		basis[11] = simdLoad(d + PositionZ * padded + j);
+		for (unsigned int c = 0; c < 12; ++c) {
+			simdStore(m + c * padded + j, basis[c]);
+		}
+	}
+
+	bool ordered = order.size() == size;
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int joint = ordered ? order[i] : i;
+		const float* l = m + joint;
+		mat4 local(
+			l[0], l[padded], l[padded * 2], 0,
+			l[padded * 3], l[padded * 4], l[padded * 5], 0,
+			l[padded * 6], l[padded * 7], l[padded * 8], 0,
+			l[padded * 9], l[padded * 10], l[padded * 11], 1);
+		out[joint] = local;
+	}
+
+	// Parent first joints chain in one pass, otherwise every joint walks its parents
+	if (ordered) {
+		for (unsigned int i = 0; i < size; ++i) {
+			unsigned int joint = order[i];
+			int parent = mParents[joint];
+			if (parent >= 0) {
+				out[joint] = out[parent] * out[joint];
+			}
+		}
+		return;
+	}
+	std::vector<mat4> locals = out;
+	for (unsigned int i = 0; i < size; ++i) {
+		for (int p = mParents[i]; p >= 0; p = mParents[p]) {
+			out[i] = locals[p] * out[i];
+		}
+	}
+}
+
+std::vector<float> MakeJointMask(SoAPose& pose, int root, float weight) {
+	unsigned int size = pose.Size();
+	std::vector<float> result(pose.PaddedSize(), 0.0f);
+	for (unsigned int i = 0; i < size; ++i) {
+		int joint = (int)i;
+		while (root >= 0 && joint >= 0 && joint != root) {
+			joint = pose.GetParent((unsigned int)joint);
+		}
+		if (joint >= 0) {
+			result[i] = weight;
+		}
+	}
+	return result;
+}
+
+namespace SoAPoseHelpers {
+	// Masks shorter than the padded pose read as zero past their end
+	const float* PaddedMask(const std::vector<float>& mask, unsigned int padded, std::vector<float>& storage) {
+		if (mask.size() >= padded) {
+			return &mask[0];
+		}
+		storage.assign(padded, 0.0f);
+		std::copy(mask.begin(), mask.end(), storage.begin());
+		return &storage[0];
+	}
+
+	void MatchSize(SoAPose& output, SoAPose& source) {
+		if (output.Size() == source.Size()) {
+			return;
+		}
+		unsigned int size = source.Size();
+		output.Resize(size);
+		for (unsigned int i = 0; i < size; ++i) {
+			output.SetParent(i, source.GetParent(i));
+		}
+	}
+
+	// mask may be null, every joint then uses the same weight
+	void Blend(SoAPose& output, SoAPose& a, SoAPose& b, float t, const float* mask) {
+		MatchSize(output, a);
+		unsigned int padded = a.PaddedSize();
+		const float* da = a.GetComponent(0);
+		const float* db = b.GetComponent(0);
+		float* dout = output.GetComponent(0);
+		simdf vt = simdSet(t);
+
+		for (unsigned int j = 0; j < padded; j += SIMD_WIDTH) {
+			simdf weight = mask == 0 ? vt : simdMul(vt, simdLoad(mask + j));
+			simdf qa[4];
+			simdf qb[4];
+			for (unsigned int c = 0; c < 4; ++c) {
+				qa[c] = simdLoad(da + (SoAPose::RotationX + c) * padded + j);
+				qb[c] = simdLoad(db + (SoAPose::RotationX + c) * padded + j);
+			}
+			simdf d = simdDot4(qa, qb);
+			simdf q[4];
+			for (unsigned int c = 0; c < 4; ++c) {
+				q[c] = simdLerp(qa[c], simdFlipSign(qb[c], d), weight);
+			}
+			simdNormalize4(q);
+
+			for (unsigned int c = SoAPose::PositionX; c <= SoAPose::PositionZ; ++c) {
+				simdStore(dout + c * padded + j, simdLerp(simdLoad(da + c * padded + j), simdLoad(db + c * padded + j), weight));
+			}
+			for (unsigned int c = 0; c < 4; ++c) {
+				simdStore(dout + (SoAPose::RotationX + c) * padded + j, q[c]);
+			}
+			for (unsigned int c = SoAPose::ScaleX; c <= SoAPose::ScaleZ; ++c) {
+				simdStore(dout + c * padded + j, simdLerp(simdLoad(da + c * padded + j), simdLoad(db + c * padded + j), weight));
+			}
+		}
+	}
+
+	// A null base means additive already holds deltas, see MakeAdditiveClip
+	void Add(SoAPose& output, SoAPose& input, SoAPose& additive, SoAPose* base, float weight, const float* mask) {
+		MatchSize(output, input);
+		unsigned int padded = input.PaddedSize();
+		const float* din = input.GetComponent(0);
+		const float* dadd = additive.GetComponent(0);
+		const float* dbase = base == 0 ? 0 : base->GetComponent(0);
+		float* dout = output.GetComponent(0);
+		simdf vw = simdSet(weight);
+		simdf one = simdSet(1.0f);
+		simdf sign = simdSet(-0.0f);
+
+		for (unsigned int j = 0; j < padded; j += SIMD_WIDTH) {
+			simdf w = mask == 0 ? vw : simdMul(vw, simdLoad(mask + j));
+
+			// delta = inverse(base) * additive, the conjugate is enough for unit rotations
+			simdf add[4];
+			simdf in[4];
+			for (unsigned int c = 0; c < 4; ++c) {
+				add[c] = simdLoad(dadd + (SoAPose::RotationX + c) * padded + j);
+				in[c] = simdLoad(din + (SoAPose::RotationX + c) * padded + j);
+			}
+			simdf delta[4] = { add[0], add[1], add[2], add[3] };
+			if (dbase != 0) {
+				simdf inv[4];
+				for (unsigned int c = 0; c < 4; ++c) {
+					inv[c] = simdLoad(dbase + (SoAPose::RotationX + c) * padded + j);
+				}
+				for (unsigned int c = 0; c < 3; ++c) {
+					inv[c] = simdXor(inv[c], sign);
+				}
+				simdQuatMul(inv, add, delta);
+			}
+
+			// nlerp(identity, delta, w), on the identity's side of the hypersphere
+			simdf identity[4] = { simdZero(), simdZero(), simdZero(), one };
+			for (unsigned int c = 0; c < 4; ++c) {
+				delta[c] = simdLerp(identity[c], simdFlipSign(delta[c], delta[3]), w);
+			}
+			simdNormalize4(delta);
+
+			simdf q[4];
+			simdQuatMul(in, delta, q);
+			simdNormalize4(q);
+
+			for (unsigned int c = 0; c < SoAPose::NumComponents; ++c) {
+				if (c >= SoAPose::RotationX && c <= SoAPose::RotationW) {
+					simdStore(dout + c * padded + j, q[c - SoAPose::RotationX]);
+					continue;
+				}
+				simdf d = simdLoad(dadd + c * padded + j);
+				if (dbase != 0) {
+					d = simdSub(d, simdLoad(dbase + c * padded + j));
+				}
+				simdStore(dout + c * padded + j, simdMadd(d, w, simdLoad(din + c * padded + j)));
+			}
+		}
+	}
+} // End SoAPoseHelpers namespace
+
+void Blend(SoAPose& output, SoAPose& a, SoAPose& b, float t) {
+	SoAPoseHelpers::Blend(output, a, b, t, 0);
+}
+
+void Blend(SoAPose& output, SoAPose& a, SoAPose& b, float t, const std::vector<float>& mask) {
+	std::vector<float> storage;
+	SoAPoseHelpers::Blend(output, a, b, t, SoAPoseHelpers::PaddedMask(mask, a.PaddedSize(), storage));
+}
+
+void Add(SoAPose& output, SoAPose& input, SoAPose& additive, SoAPose& additiveBase, float weight) {
+	SoAPoseHelpers::Add(output, input, additive, &additiveBase, weight, 0);
+}
+
+void Add(SoAPose& output, SoAPose& input, SoAPose& additive, SoAPose& additiveBase, float weight,
+	const std::vector<float>& mask) {
+	std::vector<float> storage;
+	SoAPoseHelpers::Add(output, input, additive, &additiveBase, weight,
+		SoAPoseHelpers::PaddedMask(mask, input.PaddedSize(), storage));
+}
+
+void AddDelta(SoAPose& output, SoAPose& input, SoAPose& delta, float weight) {
+	SoAPoseHelpers::Add(output, input, delta, 0, weight, 0);
+}
+
+void AddDelta(SoAPose& output, SoAPose& input, SoAPose& delta, float weight, const std::vector<float>& mask) {
+	std::vector<float> storage;
+	SoAPoseHelpers::Add(output, input, delta, 0, weight,
+		SoAPoseHelpers::PaddedMask(mask, input.PaddedSize(), storage));
+}
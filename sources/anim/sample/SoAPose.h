@@ -0,0 +1,68 @@
+#ifndef _H_SOAPOSE_
+#define _H_SOAPOSE_
+
+#include <vector>
+#include "Pose.h"
+#include "SIMD.h"
+
+// Structure of arrays pose, every transform component is its own float array padded to
+// SIMD_WIDTH so whole vectors of joints can be read and written at once.
+// Components are laid out position xyz, rotation xyzw, scale xyz.
+class SoAPose {
+public:
+	enum Component {
+		PositionX, PositionY, PositionZ,
+		RotationX, RotationY, RotationZ, RotationW,
+		ScaleX, ScaleY, ScaleZ,
+		NumComponents
+	};
+protected:
+	std::vector<float> mData;
+	std::vector<int> mParents;
+	std::vector<float> mLocalMatrices; // Palette scratch, 12 affine components per joint
+	unsigned int mSize;
+	unsigned int mPaddedSize;
+public:
+	SoAPose();
+	SoAPose(unsigned int numJoints);
+	void Resize(unsigned int size);
+	unsigned int Size();
+	unsigned int PaddedSize();
+
+	float* GetComponent(unsigned int component);
+	Transform GetLocalTransform(unsigned int index);
+	void SetLocalTransform(unsigned int index, const Transform& transform);
+	int GetParent(unsigned int index);
+	void SetParent(unsigned int index, int parent);
+
+	void FromPose(Pose& pose);
+	void ToPose(Pose& outPose);
+
+	// order must list every joint after its parent (Skeleton::GetJointOrder). Local
+	// matrices are built SIMD_WIDTH joints at a time, then chained in one ordered pass.
+	void GetMatrixPalette(std::vector<mat4>& out, const std::vector<unsigned int>& order);
+};
+
+// Per joint blend weights, padded to the pose's SIMD width. Joints in the hierarchy
+// under root (root included) get weight, every other joint and the padding get zero.
+// A root of -1 selects every joint.
+std::vector<float> MakeJointMask(SoAPose& pose, int root, float weight = 1.0f);
+
+// Lerps positions and scales and nlerps rotations (neighborhood corrected) from a to b.
+// All poses must share a skeleton, output may be a or b.
+void Blend(SoAPose& output, SoAPose& a, SoAPose& b, float t);
+// As above, joint j blends by t * mask[j]
+void Blend(SoAPose& output, SoAPose& a, SoAPose& b, float t, const std::vector<float>& mask);
+
+// Applies the difference between additive and additiveBase on top of input, scaled by
+// weight. Positions and scales add their deltas, rotations apply
+// inverse(base) * additive, nlerped from identity by weight.
+void Add(SoAPose& output, SoAPose& input, SoAPose& additive, SoAPose& additiveBase, float weight);
+void Add(SoAPose& output, SoAPose& input, SoAPose& additive, SoAPose& additiveBase, float weight,
+	const std::vector<float>& mask);
+// Same as Add for a pose sampled from an additive clip, which already holds
+// the deltas, see MakeAdditiveClip and MakeDeltaPose
+void AddDelta(SoAPose& output, SoAPose& input, SoAPose& delta, float weight);
+void AddDelta(SoAPose& output, SoAPose& input, SoAPose& delta, float weight, const std::vector<float>& mask);
+
+#endif
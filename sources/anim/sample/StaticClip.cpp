@@ -0,0 +1,207 @@
+#include "StaticClip.h"
+
+namespace StaticClipHelpers {
+	template<typename T, int N>
+	void Add(Track<T, N>& track, unsigned int joint,
+		std::vector<StaticTrack<T, N, Interpolation::Constant>>& constant,
+		std::vector<StaticTrack<T, N, Interpolation::Linear>>& linear,
+		std::vector<StaticTrack<T, N, Interpolation::Cubic>>& cubic) {
+		unsigned int size = track.Size();
+		if (size == 0) {
+			return;
+		}
+		Interpolation interpolation = size == 1 ? Interpolation::Constant : track.GetInterpolation();
+		if (interpolation == Interpolation::Constant) {
+			constant.push_back(StaticTrack<T, N, Interpolation::Constant>());
+			constant.back().Set(track);
+			constant.back().SetId(joint);
+		}
+		else if (interpolation == Interpolation::Linear) {
+			linear.push_back(StaticTrack<T, N, Interpolation::Linear>());
+			linear.back().Set(track);
+			linear.back().SetId(joint);
+		}
+		else {
+			cubic.push_back(StaticTrack<T, N, Interpolation::Cubic>());
+			cubic.back().Set(track);
+			cubic.back().SetId(joint);
+		}
+	}
+
+	// One homogeneous loop, channel is the Transform member the tracks write. Returns the
+	// cursor of the next array.
+	template<bool LOOPING, typename TRACK, typename T>
+	TrackCursor* SampleArray(std::vector<TRACK>& tracks, T Transform::* channel, Pose& outPose, float time, TrackCursor* cursors) {
+		unsigned int size = (unsigned int)tracks.size();
+		if (cursors == 0) {
+			for (unsigned int i = 0; i < size; ++i) {
+				unsigned int joint = tracks[i].GetId();
+				Transform local = outPose.GetLocalTransform(joint);
+				local.*channel = tracks[i].template Sample<LOOPING>(time);
+				outPose.SetLocalTransform(joint, local);
+			}
+			return 0;
+		}
+		for (unsigned int i = 0; i < size; ++i) {
+			unsigned int joint = tracks[i].GetId();
+			Transform local = outPose.GetLocalTransform(joint);
+			local.*channel = tracks[i].template Sample<LOOPING>(time, cursors[i]);
+			outPose.SetLocalTransform(joint, local);
+		}
+		return cursors + size;
+	}
+
+	template<typename TRACK>
+	unsigned int GetMemorySize(std::vector<TRACK>& tracks) {
+		unsigned int result = 0;
+		for (unsigned int i = 0, size = (unsigned int)tracks.size(); i < size; ++i) {
+			result += tracks[i].GetMemorySize();
+		}
+		return result;
+	}
+} // End StaticClipHelpers namespace
+
+StaticClip::StaticClip() {
+	mName = "No name given";
+	mStartTime = 0.0f;
+	mEndTime = 0.0f;
+	mLooping = true;
+}
+
+void StaticClip::Set(Clip& clip) {
+	mName = clip.GetName();
+	mLooping = clip.GetLooping();
+	mStartTime = clip.GetStartTime();
+	mEndTime = clip.GetEndTime();
+
+	mConstantPositions.clear();
+	mLinearPositions.clear();
+	mCubicPositions.clear();
+	mConstantRotations.clear();
+	mLinearRotations.clear();
+	mCubicRotations.clear();
+	mConstantScales.clear();
+	mLinearScales.clear();
+	mCubicScales.clear();
+
+	for (unsigned int i = 0, size = clip.Size(); i < size; ++i) {
+		unsigned int joint = clip.GetIdAtIndex(i);
+		TransformTrack& track = clip[joint];
+		StaticClipHelpers::Add(track.GetPositionTrack(), joint, mConstantPositions, mLinearPositions, mCubicPositions);
+		StaticClipHelpers::Add(track.GetRotationTrack(), joint, mConstantRotations, mLinearRotations, mCubicRotations);
+		StaticClipHelpers::Add(track.GetScaleTrack(), joint, mConstantScales, mLinearScales, mCubicScales);
+	}
+}
+
+template<bool LOOPING>
+void StaticClip::SampleChannels(Pose& outPose, float time, TrackCursor* cursors) {
+	cursors = StaticClipHelpers::SampleArray<LOOPING>(mConstantPositions, &Transform::position, outPose, time, cursors);
+	cursors = StaticClipHelpers::SampleArray<LOOPING>(mLinearPositions, &Transform::position, outPose, time, cursors);
+	cursors = StaticClipHelpers::SampleArray<LOOPING>(mCubicPositions, &Transform::position, outPose, time, cursors);
+	cursors = StaticClipHelpers::SampleArray<LOOPING>(mConstantRotations, &Transform::rotation, outPose, time, cursors);
+	cursors = StaticClipHelpers::SampleArray<LOOPING>(mLinearRotations, &Transform::rotation, outPose, time, cursors);
+	cursors = StaticClipHelpers::SampleArray<LOOPING>(mCubicRotations, &Transform::rotation, outPose, time, cursors);
+	cursors = StaticClipHelpers::SampleArray<LOOPING>(mConstantScales, &Transform::scale, outPose, time, cursors);
+	cursors = StaticClipHelpers::SampleArray<LOOPING>(mLinearScales, &Transform::scale, outPose, time, cursors);
+	StaticClipHelpers::SampleArray<LOOPING>(mCubicScales, &Transform::scale, outPose, time, cursors);
+}
+
+float StaticClip::Sample(Pose& outPose, float time) {
+	if (GetDuration() == 0.0f) {
+		return 0.0f;
+	}
+	time = AdjustTimeToFitRange(time);
+	if (mLooping) {
+		SampleChannels<true>(outPose, time, 0);
+	}
+	else {
+		SampleChannels<false>(outPose, time, 0);
+	}
+	return time;
+}
+
+float StaticClip::Sample(Pose& outPose, float time, ClipCursor& cursor) {
+	if (GetDuration() == 0.0f) {
+		return 0.0f;
+	}
+	time = AdjustTimeToFitRange(time);
+	unsigned int size = Size();
+	if (cursor.mChannels.size() != size) {
+		cursor.mChannels.resize(size);
+	}
+	TrackCursor* cursors = size > 0 ? &cursor.mChannels[0] : 0;
+	if (mLooping) {
+		SampleChannels<true>(outPose, time, cursors);
+	}
+	else {
+		SampleChannels<false>(outPose, time, cursors);
+	}
+	return time;
+}
+
+float StaticClip::AdjustTimeToFitRange(float inTime) {
+	if (mLooping) {
+		float duration = mEndTime - mStartTime;
+		if (duration <= 0) {
+			return 0.0f;
+		}
+		inTime = fmodf(inTime - mStartTime, mEndTime - mStartTime);
+		if (inTime < 0.0f) {
+			inTime += mEndTime - mStartTime;
+		}
+		inTime = inTime + mStartTime;
+	}
+	else {
+		if (inTime < mStartTime) {
+			inTime = mStartTime;
+		}
+		if (inTime > mEndTime) {
+			inTime = mEndTime;
+		}
+	}
+	return inTime;
+}
+
+unsigned int StaticClip::Size() {
+	return (unsigned int)(mConstantPositions.size() + mLinearPositions.size() + mCubicPositions.size() +
+		mConstantRotations.size() + mLinearRotations.size() + mCubicRotations.size() +
+		mConstantScales.size() + mLinearScales.size() + mCubicScales.size());
+}
+
+unsigned int StaticClip::GetMemorySize() {
+	return StaticClipHelpers::GetMemorySize(mConstantPositions) + StaticClipHelpers::GetMemorySize(mLinearPositions) +
+		StaticClipHelpers::GetMemorySize(mCubicPositions) + StaticClipHelpers::GetMemorySize(mConstantRotations) +
+		StaticClipHelpers::GetMemorySize(mLinearRotations) + StaticClipHelpers::GetMemorySize(mCubicRotations) +
+		StaticClipHelpers::GetMemorySize(mConstantScales) + StaticClipHelpers::GetMemorySize(mLinearScales) +
+		StaticClipHelpers::GetMemorySize(mCubicScales);
+}
+
+std::string& StaticClip::GetName() {
+	return mName;
+}
+
+float StaticClip::GetDuration() {
+	return mEndTime - mStartTime;
+}
+
+float StaticClip::GetStartTime() {
+	return mStartTime;
+}
+
+float StaticClip::GetEndTime() {
+	return mEndTime;
+}
+
+bool StaticClip::GetLooping() {
+	return mLooping;
+}
+
+void StaticClip::SetLooping(bool inLooping) {
+	mLooping = inLooping;
+}
+
+StaticClip MakeStaticClip(Clip& clip) {
+	StaticClip result;
+	result.Set(clip);
+	return result;
+}
@@ -0,0 +1,49 @@
+#ifndef _H_STATICCLIP_
+#define _H_STATICCLIP_
+
+#include <vector>
+#include <string>
+#include "Clip.h"
+#include "StaticTrack.h"
+
+// A clip that keeps its channels in one array per channel and interpolation mode, so
+// every loop in Sample runs over tracks of a single type with no per track branching.
+// Looping is resolved once per call. Channels are stored in the order they are sampled,
+// which is also the order of the cursors in ClipCursor::mChannels.
+class StaticClip {
+protected:
+	std::vector<StaticTrack<vec3, 3, Interpolation::Constant>> mConstantPositions;
+	std::vector<StaticTrack<vec3, 3, Interpolation::Linear>> mLinearPositions;
+	std::vector<StaticTrack<vec3, 3, Interpolation::Cubic>> mCubicPositions;
+	std::vector<StaticTrack<quat, 4, Interpolation::Constant>> mConstantRotations;
+	std::vector<StaticTrack<quat, 4, Interpolation::Linear>> mLinearRotations;
+	std::vector<StaticTrack<quat, 4, Interpolation::Cubic>> mCubicRotations;
+	std::vector<StaticTrack<vec3, 3, Interpolation::Constant>> mConstantScales;
+	std::vector<StaticTrack<vec3, 3, Interpolation::Linear>> mLinearScales;
+	std::vector<StaticTrack<vec3, 3, Interpolation::Cubic>> mCubicScales;
+	std::string mName;
+	float mStartTime;
+	float mEndTime;
+	bool mLooping;
+protected:
+	float AdjustTimeToFitRange(float inTime);
+	template<bool LOOPING>
+	void SampleChannels(Pose& outPose, float time, TrackCursor* cursors);
+public:
+	StaticClip();
+	void Set(Clip& clip);
+	float Sample(Pose& outPose, float inTime);
+	float Sample(Pose& outPose, float inTime, ClipCursor& cursor);
+	unsigned int Size(); // Number of animated channels
+	std::string& GetName();
+	float GetDuration();
+	float GetStartTime();
+	float GetEndTime();
+	bool GetLooping();
+	void SetLooping(bool inLooping);
+	unsigned int GetMemorySize();
+};
+
+StaticClip MakeStaticClip(Clip& clip);
+
+#endif
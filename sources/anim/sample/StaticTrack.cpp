@@ -0,0 +1,11 @@
+#include "StaticTrack.h"
+
+template StaticTrack<vec3, 3, Interpolation::Constant>;
+template StaticTrack<vec3, 3, Interpolation::Linear>;
+template StaticTrack<vec3, 3, Interpolation::Cubic>;
+template StaticTrack<quat, 4, Interpolation::Constant>;
+template StaticTrack<quat, 4, Interpolation::Linear>;
+template StaticTrack<quat, 4, Interpolation::Cubic>;
+template StaticTrack<float, 1, Interpolation::Constant>;
+template StaticTrack<float, 1, Interpolation::Linear>;
+template StaticTrack<float, 1, Interpolation::Cubic>;
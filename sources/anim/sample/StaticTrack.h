@@ -0,0 +1,149 @@
+#ifndef _H_STATICTRACK_
+#define _H_STATICTRACK_
+
+#include <vector>
+#include <cmath>
+
+#include "Track.h"
+#include "CompactTrack.h"
+
+// A track whose interpolation is part of its type. Values are stored as T, so sampling
+// never goes through a float*, and with the interpolation and looping known at compile
+// time the whole sample path is branch free and can be inlined into the caller's loop.
+// Cubic tracks store in, value and out per key. A single key track samples as constant.
+template<typename T, int N, Interpolation I>
+class StaticTrack {
+protected:
+	std::vector<float> mTimes;
+	std::vector<T> mValues;
+	unsigned int mId;
+protected:
+	T SampleFrame(float trackTime, int frame);
+public:
+	StaticTrack();
+	void Set(Track<T, N>& input);
+	unsigned int GetId();
+	void SetId(unsigned int id);
+	unsigned int Size();
+	float GetStartTime() const;
+	float GetEndTime() const;
+	template<bool LOOPING>
+	T Sample(float time);
+	template<bool LOOPING>
+	T Sample(float time, TrackCursor& cursor);
+	unsigned int GetMemorySize();
+};
+
+namespace StaticTrackHelpers {
+	// Raw frame values, quaternion tangents must not be normalized
+	inline void Load(const float* value, float& out) {
+		out = value[0];
+	}
+
+	inline void Load(const float* value, vec3& out) {
+		out = vec3(value[0], value[1], value[2]);
+	}
+
+	inline void Load(const float* value, quat& out) {
+		out = quat(value[0], value[1], value[2], value[3]);
+	}
+} // End StaticTrackHelpers namespace
+
+template<typename T, int N, Interpolation I>
+StaticTrack<T, N, I>::StaticTrack() {
+	mId = 0;
+}
+
+template<typename T, int N, Interpolation I>
+void StaticTrack<T, N, I>::Set(Track<T, N>& input) {
+	unsigned int size = input.Size();
+	mTimes.resize(size);
+	mValues.resize(I == Interpolation::Cubic ? size * 3 : size);
+	for (unsigned int i = 0; i < size; ++i) {
+		Frame<N>& frame = input[i];
+		mTimes[i] = frame.mTime;
+		if (I == Interpolation::Cubic) {
+			StaticTrackHelpers::Load(frame.mIn, mValues[i * 3]);
+			mValues[i * 3 + 1] = input.GetValue(i);
+			StaticTrackHelpers::Load(frame.mOut, mValues[i * 3 + 2]);
+		}
+		else {
+			mValues[i] = input.GetValue(i);
+		}
+	}
+}
+
+template<typename T, int N, Interpolation I>
+unsigned int StaticTrack<T, N, I>::GetId() {
+	return mId;
+}
+
+template<typename T, int N, Interpolation I>
+void StaticTrack<T, N, I>::SetId(unsigned int id) {
+	mId = id;
+}
+
+template<typename T, int N, Interpolation I>
+unsigned int StaticTrack<T, N, I>::Size() {
+	return (unsigned int)mTimes.size();
+}
+
+template<typename T, int N, Interpolation I>
+float StaticTrack<T, N, I>::GetStartTime() const {
+	return mTimes.front();
+}
+
+template<typename T, int N, Interpolation I>
+float StaticTrack<T, N, I>::GetEndTime() const {
+	return mTimes.back();
+}
+
+template<typename T, int N, Interpolation I>
+unsigned int StaticTrack<T, N, I>::GetMemorySize() {
+	return (unsigned int)(sizeof(float) * mTimes.size() + sizeof(T) * mValues.size());
+}
+
+template<typename T, int N, Interpolation I>
+T StaticTrack<T, N, I>::SampleFrame(float trackTime, int frame) {
+	if (I == Interpolation::Constant) {
+		return mValues[frame < 0 ? 0 : frame];
+	}
+	if (frame < 0) {
+		return T();
+	}
+
+	// Only the last two keys can share a time, FrameIndex steps past any earlier pair.
+	// A time clamped or wrapped onto them samples the later key, as the end of a
+	// segment would
+	float frameDelta = mTimes[frame + 1] - mTimes[frame];
+	float t = 1.0f;
+	if (frameDelta > 0.0f) {
+		t = (trackTime - mTimes[frame]) / frameDelta;
+	}
+	else if (trackTime < mTimes[frame]) {
+		t = 0.0f;
+	}
+	if (I == Interpolation::Linear) {
+		return TrackHelpers::Interpolate(mValues[frame], mValues[frame + 1], t);
+	}
+
+	const T* key1 = &mValues[frame * 3];
+	const T* key2 = key1 + 3;
+	return TrackHelpers::Hermite(t, key1[1], key1[2] * frameDelta, key2[1], key2[0] * frameDelta);
+}
+
+template<typename T, int N, Interpolation I>
+template<bool LOOPING>
+T StaticTrack<T, N, I>::Sample(float time) {
+	float trackTime = CompactTrackHelpers::AdjustTimeToFitTrack(mTimes, time, LOOPING);
+	return SampleFrame(trackTime, CompactTrackHelpers::FrameIndex(mTimes, trackTime));
+}
+
+template<typename T, int N, Interpolation I>
+template<bool LOOPING>
+T StaticTrack<T, N, I>::Sample(float time, TrackCursor& cursor) {
+	float trackTime = CompactTrackHelpers::AdjustTimeToFitTrack(mTimes, time, LOOPING);
+	return SampleFrame(trackTime, CompactTrackHelpers::FrameIndex(mTimes, trackTime, cursor));
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "StreamRing.h"
+
+StreamRing::StreamRing(unsigned int target) {
+	mHandle = 0;
+	mTarget = target;
+	mRegionSize = 0;
+	mRegion = 0;
+	mOffset = 0;
+	mPersistent = 0;
+	for (unsigned int i = 0; i < STREAM_RING_REGIONS; ++i) {
+		mFences[i] = 0;
+	}
+}
+
+StreamRing::~StreamRing() {
+	Release();
+}
+
+bool StreamRing::IsPersistent() {
+	return GLAD_GL_VERSION_4_4 != 0;
+}
+
+void StreamRing::Release() {
+	for (unsigned int i = 0; i < STREAM_RING_REGIONS; ++i) {
+		if (mFences[i] != 0) {
+			glDeleteSync(mFences[i]);
+			mFences[i] = 0;
+		}
+	}
+	if (mHandle != 0) {
+		if (mPersistent != 0) {
+			glBindBuffer(mTarget, mHandle);
+			glUnmapBuffer(mTarget);
+			glBindBuffer(mTarget, 0);
+			mPersistent = 0;
+		}
+		glDeleteBuffers(1, &mHandle);
+		mHandle = 0;
+	}
+}
+
+void StreamRing::Reserve(unsigned int bytes) {
+	// Immutable storage can not be resized, start over with a new buffer. Regions stay
+	// aligned so any attribute offset into them is valid.
+	Release();
+	mRegionSize = (bytes + 255) / 256 * 256;
+	mRegion = STREAM_RING_REGIONS - 1;
+	unsigned int total = mRegionSize * STREAM_RING_REGIONS;
+
+	glGenBuffers(1, &mHandle);
+	glBindBuffer(mTarget, mHandle);
+	if (IsPersistent()) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(mTarget, total, 0, flags);
+		mPersistent = glMapBufferRange(mTarget, 0, total, flags);
+	}
+	else {
+		glBufferData(mTarget, total, 0, GL_STREAM_DRAW);
+	}
+	glBindBuffer(mTarget, 0);
+}
+
+void* StreamRing::Map(unsigned int bytes) {
+	if (bytes > mRegionSize || mHandle == 0) {
+		Reserve(bytes);
+	}
+
+	// Draws issued so far read the current region, fence them before moving on
+	if (mPersistent != 0) {
+		if (mFences[mRegion] != 0) {
+			glDeleteSync(mFences[mRegion]);
+		}
+		mFences[mRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	mRegion = (mRegion + 1) % STREAM_RING_REGIONS;
+	mOffset = mRegion * mRegionSize;
+
+	if (mPersistent != 0) {
+		GLsync fence = mFences[mRegion];
+		if (fence != 0) {
+			// Only blocks if the GPU is more than two frames behind
+			GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+			while (glClientWaitSync(fence, flags, 1000000) == GL_TIMEOUT_EXPIRED) {
+				flags = 0;
+			}
+			glDeleteSync(fence);
+			mFences[mRegion] = 0;
+		}
+		return (char*)mPersistent + mOffset;
+	}
+
+	glBindBuffer(mTarget, mHandle);
+	if (mRegion == 0) {
+		// Detach the storage the GPU may still read, the driver hands out fresh memory
+		glBufferData(mTarget, mRegionSize * STREAM_RING_REGIONS, 0, GL_STREAM_DRAW);
+	}
+	void* result = glMapBufferRange(mTarget, mOffset, bytes,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	glBindBuffer(mTarget, 0);
+	return result;
+}
+
+void StreamRing::Unmap() {
+	if (mPersistent != 0 || mHandle == 0) {
+		return; // Coherent, nothing to flush
+	}
+	glBindBuffer(mTarget, mHandle);
+	glUnmapBuffer(mTarget);
+	glBindBuffer(mTarget, 0);
+}
+
+unsigned int StreamRing::GetHandle() {
+	return mHandle;
+}
+
+unsigned int StreamRing::GetOffset() {
+	return mOffset;
+}
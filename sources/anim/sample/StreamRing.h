@@ -0,0 +1,44 @@
+#ifndef _H_STREAMRING_
+#define _H_STREAMRING_
+
+#include <glad/glad.h>
+
+#define STREAM_RING_REGIONS 3
+
+// A buffer split into three regions for data rewritten every frame. Each Map moves on
+// to the next region, so the CPU writes while the GPU still reads the previous two
+// frames. With GL 4.4 the buffer is mapped once, persistently, and a fence per region
+// keeps a write from overtaking a draw still using it. Older contexts orphan the
+// storage when the ring wraps and map each region unsynchronized.
+class StreamRing {
+protected:
+	unsigned int mHandle;
+	unsigned int mTarget;
+	unsigned int mRegionSize;
+	unsigned int mRegion;
+	unsigned int mOffset;
+	void* mPersistent;
+	GLsync mFences[STREAM_RING_REGIONS];
+private:
+	StreamRing(const StreamRing& other);
+	StreamRing& operator=(const StreamRing& other);
+protected:
+	void Reserve(unsigned int bytes);
+	void Release();
+public:
+	// target is GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+	StreamRing(unsigned int target);
+	~StreamRing();
+
+	// Room for bytes in the next region, valid until Unmap. Regions grow as needed,
+	// which replaces the buffer, so read the handle after mapping.
+	void* Map(unsigned int bytes);
+	void Unmap();
+
+	unsigned int GetHandle();
+	// Byte offset of the last mapped region, where draws should read from
+	unsigned int GetOffset();
+	static bool IsPersistent();
+};
+
+#endif
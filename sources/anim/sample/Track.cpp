@@ -3,6 +3,20 @@
 template Track<float, 1>;
 template Track<vec3, 3>;
 template Track<quat, 4>;
+template FastTrack<float, 1>;
+template FastTrack<vec3, 3>;
+template FastTrack<quat, 4>;
+
+template FastTrack<float, 1> OptimizeTrack(Track<float, 1>& input, float sampleRate, float tolerance);
+template FastTrack<vec3, 3> OptimizeTrack(Track<vec3, 3>& input, float sampleRate, float tolerance);
+template FastTrack<quat, 4> OptimizeTrack(Track<quat, 4>& input, float sampleRate, float tolerance);
+
+template bool IsConstantTrack(Track<float, 1>& input, float tolerance);
+template bool IsConstantTrack(Track<vec3, 3>& input, float tolerance);
+template bool IsConstantTrack(Track<quat, 4>& input, float tolerance);
+template Track<float, 1> ReduceTrack(Track<float, 1>& input, float tolerance);
+template Track<vec3, 3> ReduceTrack(Track<vec3, 3>& input, float tolerance);
+template Track<quat, 4> ReduceTrack(Track<quat, 4>& input, float tolerance);
 
 
 template<> float Track<float, 1>::Cast(float* value) {
@@ -17,3 +31,180 @@ template<> quat Track<quat, 4>::Cast(float* value) {
 	quat r = quat(value[0], value[1], value[2], value[3]);
 	return normalized(r);
 }
+
+namespace TrackHelpers {
+	inline float Difference(float a, float b) {
+		return fabsf(a - b);
+	}
+
+	// len snaps anything under 0.001 to zero, too coarse for error tolerances
+	inline float Difference(const vec3& a, const vec3& b) {
+		return sqrtf(lenSq(a - b));
+	}
+
+	inline float Difference(const quat& a, const quat& b) {
+		// Angle of the rotation between a and b, atan2 stays precise for small angles
+		quat delta = inverse(a) * b;
+		return 2.0f * atan2f(sqrtf(lenSq(vec3(delta.x, delta.y, delta.z))), fabsf(delta.w));
+	}
+
+	inline void SetFrameValue(Frame<1>& frame, float value) {
+		frame.mValue[0] = value;
+	}
+
+	inline void SetFrameValue(Frame<3>& frame, const vec3& value) {
+		memcpy(frame.mValue, value.v, 3 * sizeof(float));
+	}
+
+	inline void SetFrameValue(Frame<4>& frame, const quat& value) {
+		memcpy(frame.mValue, value.v, 4 * sizeof(float));
+	}
+
+	// Checks that the segment from key first to key last of input stays within tolerance
+	// of input at every key it skips and half way between every pair of source keys
+	template<typename T, int N>
+	bool SegmentFits(Track<T, N>& input, Track<T, N>& segment, unsigned int first, unsigned int last, float tolerance) {
+		segment[0] = input[first];
+		segment[1] = input[last];
+		TrackCursor cursor;
+		for (unsigned int i = first; i < last; ++i) {
+			float time = input[i].mTime;
+			float halfway = (time + input[i + 1].mTime) * 0.5f;
+			if (i > first && Difference(input.GetValue(i), segment.Sample(time, false)) > tolerance) {
+				return false;
+			}
+			if (Difference(input.Sample(halfway, false, cursor), segment.Sample(halfway, false)) > tolerance) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+template<typename T, int N>
+FastTrack<T, N> OptimizeTrack(Track<T, N>& input, float sampleRate, float tolerance) {
+	FastTrack<T, N> result;
+	unsigned int size = input.Size();
+	result.SetInterpolation(input.GetInterpolation());
+
+	bool resample = size > 1 && sampleRate > 0.0f &&
+		input.GetInterpolation() != Interpolation::Constant;
+
+	// Evenly spaced keys already index exactly through the lookup table, keep them
+	if (resample) {
+		float interval = input[1].mTime - input[0].mTime;
+		bool uniform = true;
+		for (unsigned int i = 2; i < size && uniform; ++i) {
+			float delta = input[i].mTime - input[i - 1].mTime;
+			uniform = fabsf(delta - interval) <= interval * 0.01f;
+		}
+		resample = !uniform;
+	}
+	if (resample) {
+		float startTime = input.GetStartTime();
+		float endTime = input.GetEndTime();
+		unsigned int numFrames = (unsigned int)ceilf((endTime - startTime) * sampleRate) + 1;
+
+		result.SetInterpolation(Interpolation::Linear);
+		result.Resize(numFrames);
+		for (unsigned int i = 0; i < numFrames; ++i) {
+			float time = std::min(startTime + (float)i / sampleRate, endTime);
+			Frame<N>& frame = result[i];
+			memset(&frame, 0, sizeof(Frame<N>));
+			frame.mTime = time;
+			TrackHelpers::SetFrameValue(frame, input.Sample(time, false));
+		}
+		result.UpdateIndexLookupTable(sampleRate);
+
+		// Compare both curves in between the new keys, where linear resampling loses the most
+		const unsigned int numChecks = 4;
+		for (unsigned int i = 0; i + 1 < numFrames && resample; ++i) {
+			float t0 = result[i].mTime;
+			float t1 = result[i + 1].mTime;
+			for (unsigned int j = 1; j < numChecks; ++j) {
+				float time = t0 + (t1 - t0) * (float)j / (float)numChecks;
+				if (TrackHelpers::Difference(input.Sample(time, false), result.Sample(time, false)) > tolerance) {
+					resample = false;
+					break;
+				}
+			}
+		}
+	}
+
+	if (!resample) {
+		result.SetInterpolation(input.GetInterpolation());
+		result.Resize(size);
+		for (unsigned int i = 0; i < size; ++i) {
+			result[i] = input[i];
+		}
+	}
+
+	result.UpdateIndexLookupTable(sampleRate);
+	return result;
+}
+
+
+template<typename T, int N>
+bool IsConstantTrack(Track<T, N>& input, float tolerance) {
+	unsigned int size = input.Size();
+	if (size <= 1) {
+		return true;
+	}
+
+	T first = input.GetValue(0);
+	TrackCursor cursor;
+	for (unsigned int i = 1; i < size; ++i) {
+		// Cubic tangents can move the curve away between two equal keys
+		float halfway = (input[i - 1].mTime + input[i].mTime) * 0.5f;
+		if (TrackHelpers::Difference(first, input.GetValue(i)) > tolerance ||
+			TrackHelpers::Difference(first, input.Sample(halfway, false, cursor)) > tolerance) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template<typename T, int N>
+Track<T, N> ReduceTrack(Track<T, N>& input, float tolerance) {
+	Track<T, N> result;
+	unsigned int size = input.Size();
+	result.SetInterpolation(input.GetInterpolation());
+
+	if (size > 1 && IsConstantTrack(input, tolerance)) {
+		result.Resize(1);
+		result[0] = input[0];
+		memset(result[0].mIn, 0, N * sizeof(float));
+		memset(result[0].mOut, 0, N * sizeof(float));
+		return result;
+	}
+	if (size <= 2) {
+		result.Resize(size);
+		for (unsigned int i = 0; i < size; ++i) {
+			result[i] = input[i];
+		}
+		return result;
+	}
+
+	// Greedy, grow each segment from the last kept key until it no longer fits
+	std::vector<unsigned int> keep;
+	keep.push_back(0);
+	Track<T, N> segment;
+	segment.SetInterpolation(input.GetInterpolation());
+	segment.Resize(2);
+
+	unsigned int first = 0;
+	for (unsigned int last = 2; last < size; ++last) {
+		if (!TrackHelpers::SegmentFits(input, segment, first, last, tolerance)) {
+			first = last - 1;
+			keep.push_back(first);
+		}
+	}
+	keep.push_back(size - 1);
+
+	unsigned int numKeys = (unsigned int)keep.size();
+	result.Resize(numKeys);
+	for (unsigned int i = 0; i < numKeys; ++i) {
+		result[i] = input[keep[i]];
+	}
+	return result;
+}
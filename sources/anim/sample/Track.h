@@ -3,12 +3,24 @@
 
 #include <vector>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 
 #include "Frame.h"
 #include "vec3.h"
 #include "quat.h"
 #include "Interpolation.h"
 
+// How far a cursor walks from its last segment before falling back to a binary search
+#define TRACK_CURSOR_MAX_STEPS 4
+
+// Remembers the segment a track was last sampled in, one per track per playback
+struct TrackCursor {
+	int mFrame;
+	inline TrackCursor() : mFrame(-1) { }
+	inline void Reset() { mFrame = -1; }
+};
+
 template<typename T, int N>
 class Track {
 protected:
@@ -18,8 +30,13 @@ protected:
 	T SampleConstant(float time, bool looping);
 	T SampleLinear(float time, bool looping);
 	T SampleCubic(float time, bool looping);
+	T SampleConstant(int frame);
+	T SampleLinear(int frame, float trackTime);
+	T SampleCubic(int frame, float trackTime);
+	T SampleFrame(int frame, float trackTime);
 	T Hermite(float time, const T& point1, const T& slope1,	const T& point2, const T& slope2);
 	int FrameIndex(float time, bool looping);
+	int FrameIndex(float trackTime, TrackCursor& cursor);
 	float AdjustTimeToFitTrack(float time, bool looping);
 	T Cast(float* value);
 public:
@@ -31,13 +48,26 @@ public:
 	float GetStartTime() const;
 	float GetEndTime() const;
 	T Sample(float time, bool looping);
+	T Sample(float time, bool looping, TrackCursor& cursor);
 	Frame<N>& operator[](unsigned int index);
+	T GetValue(unsigned int index);
+	unsigned int GetMemorySize();
 };
 
 typedef Track<float, 1> ScalarTrack;
 typedef Track<vec3, 3> VectorTrack;
 typedef Track<quat, 4> QuaternionTrack;
 
+// True if no point of the curve is further than tolerance from its first key (distance
+// for scalar and vector tracks, radians for rotation tracks)
+template<typename T, int N>
+bool IsConstantTrack(Track<T, N>& input, float tolerance);
+
+// Removes every key the curve can be rebuilt without while staying within tolerance
+// of the input, at the source keys and half way between them. Constant tracks are
+// reduced to their first key, TransformTrack assigns those without sampling.
+template<typename T, int N>
+Track<T, N> ReduceTrack(Track<T, N>& input, float tolerance);
 
 template<typename T, int N>
 Track<T, N>::Track()
@@ -69,11 +99,36 @@ T Track<T, N>::Sample(float time, bool looping)
     return SampleCubic(time, looping);
 }
 
+template<typename T, int N>
+T Track<T, N>::Sample(float time, bool looping, TrackCursor& cursor)
+{
+    // Wrap or clamp once, the cursor lookup works on track time directly
+    float trackTime = AdjustTimeToFitTrack(time, looping);
+    return SampleFrame(FrameIndex(trackTime, cursor), trackTime);
+}
+
+template<typename T, int N>
+T Track<T, N>::SampleFrame(int frame, float trackTime)
+{
+    if (mInterpolation == Interpolation::Constant) {
+        return SampleConstant(frame);
+    }
+    else if (mInterpolation == Interpolation::Linear) {
+        return SampleLinear(frame, trackTime);
+    }
+    return SampleCubic(frame, trackTime);
+}
+
 template<typename T, int N>
 Frame<N>& Track<T, N>::operator[](unsigned int index) {
     return mFrames[index];
 }
 
+template<typename T, int N>
+T Track<T, N>::GetValue(unsigned int index) {
+    return Cast(&mFrames[index].mValue[0]);
+}
+
 template<typename T, int N>
 void Track<T, N>::Resize(unsigned int size) {
     mFrames.resize(size);
@@ -84,6 +139,11 @@ unsigned int Track<T, N>::Size() {
     return mFrames.size();
 }
 
+template<typename T, int N>
+unsigned int Track<T, N>::GetMemorySize() {
+    return (unsigned int)(mFrames.size() * sizeof(Frame<N>));
+}
+
 template<typename T, int N>
 Interpolation Track<T, N>::GetInterpolation() {
     return mInterpolation;
@@ -130,24 +190,30 @@ namespace TrackHelpers {
             b = -b;
         }
     }
-}; // End Track Helpers namespace
 
-template<typename T, int N>
-T Track<T, N>::Hermite(float t, const T& p1, const T& s1, const T& _p2, const T& s2)
-{
-    float tt = t * t;
-    float ttt = tt * t;
+    template<typename T>
+    T Hermite(float t, const T& p1, const T& s1, const T& _p2, const T& s2)
+    {
+        float tt = t * t;
+        float ttt = tt * t;
 
-    T p2 = _p2;
-    TrackHelpers::Neighborhood(p1, p2);
+        T p2 = _p2;
+        Neighborhood(p1, p2);
 
-    float h1 = 2.0f * ttt - 3.0f * tt + 1.0f;
-    float h2 = -2.0f * ttt + 3.0f * tt;
-    float h3 = ttt - 2.0f * tt + t;
-    float h4 = ttt - tt;
+        float h1 = 2.0f * ttt - 3.0f * tt + 1.0f;
+        float h2 = -2.0f * ttt + 3.0f * tt;
+        float h3 = ttt - 2.0f * tt + t;
+        float h4 = ttt - tt;
 
-    T result = p1 * h1 + p2 * h2 + s1 * h3 + s2 * h4;
-    return TrackHelpers::AdjustHermiteResult(result);
+        T result = p1 * h1 + p2 * h2 + s1 * h3 + s2 * h4;
+        return AdjustHermiteResult(result);
+    }
+}; // End Track Helpers namespace
+
+template<typename T, int N>
+T Track<T, N>::Hermite(float t, const T& p1, const T& s1, const T& p2, const T& s2)
+{
+    return TrackHelpers::Hermite(t, p1, s1, p2, s2);
 }
 
 template<typename T, int N>
@@ -184,6 +250,46 @@ int Track<T, N>::FrameIndex(float time, bool looping) {
     return -1;
 } // End of FrameIndex
 
+template<typename T, int N>
+int Track<T, N>::FrameIndex(float trackTime, TrackCursor& cursor) {
+    int last = (int)mFrames.size() - 2;
+    if (last < 0) {
+        return -1;
+    }
+
+    // Playback usually stays in, or moves a few keys away from, the last segment
+    int frame = cursor.mFrame;
+    if (frame >= 0 && frame <= last) {
+        if (trackTime >= mFrames[frame].mTime) {
+            for (int step = 0; step < TRACK_CURSOR_MAX_STEPS; ++step) {
+                if (frame == last || trackTime < mFrames[frame + 1].mTime) {
+                    cursor.mFrame = frame;
+                    return frame;
+                }
+                ++frame;
+            }
+        }
+        else {
+            for (int step = 0; step < TRACK_CURSOR_MAX_STEPS && frame > 0; ++step) {
+                --frame;
+                if (frame == 0 || trackTime >= mFrames[frame].mTime) {
+                    cursor.mFrame = frame;
+                    return frame;
+                }
+            }
+        }
+    }
+
+    // Seek or loop, binary search for the last key at or before trackTime
+    typename std::vector<Frame<N>>::iterator next = std::upper_bound(
+        mFrames.begin() + 1, mFrames.begin() + last + 1, trackTime,
+        [](float time, const Frame<N>& f) { return time < f.mTime; });
+    frame = (int)(next - mFrames.begin()) - 1;
+
+    cursor.mFrame = frame;
+    return frame;
+}
+
 template<typename T, int N>
 float Track<T, N>::AdjustTimeToFitTrack(float time, bool looping)
 {
@@ -212,7 +318,11 @@ float Track<T, N>::AdjustTimeToFitTrack(float time, bool looping)
 
 template<typename T, int N>
 T Track<T, N>::SampleConstant(float time, bool looping) {
-    int frame = FrameIndex(time, looping);
+    return SampleConstant(FrameIndex(time, looping));
+}
+
+template<typename T, int N>
+T Track<T, N>::SampleConstant(int frame) {
     if (frame < 0 || frame >= (int)mFrames.size()) {
         return T();
     }
@@ -222,13 +332,16 @@ T Track<T, N>::SampleConstant(float time, bool looping) {
 
 template<typename T, int N>
 T Track<T, N>::SampleLinear(float time, bool looping) {
-    int thisFrame = FrameIndex(time, looping);
+    return SampleLinear(FrameIndex(time, looping), AdjustTimeToFitTrack(time, looping));
+}
+
+template<typename T, int N>
+T Track<T, N>::SampleLinear(int thisFrame, float trackTime) {
     if (thisFrame < 0 || thisFrame >= (int)(mFrames.size() - 1)) {
         return T();
     }
     int nextFrame = thisFrame + 1;
 
-    float trackTime = AdjustTimeToFitTrack(time, looping);
     float frameDelta = mFrames[nextFrame].mTime - mFrames[thisFrame].mTime;
     if (frameDelta <= 0.0f) {
         return T();
@@ -243,13 +356,16 @@ T Track<T, N>::SampleLinear(float time, bool looping) {
 
 template<typename T, int N>
 T Track<T, N>::SampleCubic(float time, bool looping) {
-    int thisFrame = FrameIndex(time, looping);
+    return SampleCubic(FrameIndex(time, looping), AdjustTimeToFitTrack(time, looping));
+}
+
+template<typename T, int N>
+T Track<T, N>::SampleCubic(int thisFrame, float trackTime) {
     if (thisFrame < 0 || thisFrame >= (int)(mFrames.size() - 1)) {
         return T();
     }
     int nextFrame = thisFrame + 1;
 
-    float trackTime = AdjustTimeToFitTrack(time, looping);
     float frameDelta = mFrames[nextFrame].mTime - mFrames[thisFrame].mTime;
     if (frameDelta <= 0.0f) {
         return T();
@@ -270,4 +386,120 @@ T Track<T, N>::SampleCubic(float time, bool looping) {
 }
 
 
+// A track with a precomputed time to frame lookup table, FrameIndex is a multiply
+// and a table read instead of a search. Track has no virtual functions, so only
+// Sample called on a FastTrack uses the table, through a Track& it searches.
+template<typename T, int N>
+class FastTrack : public Track<T, N> {
+protected:
+	std::vector<unsigned int> mSampledFrames;
+	float mSampleRate;
+protected:
+	int FrameIndex(float trackTime, TrackCursor& cursor);
+	int LookupFrame(float trackTime);
+public:
+	FastTrack();
+	T Sample(float time, bool looping);
+	T Sample(float time, bool looping, TrackCursor& cursor);
+	void UpdateIndexLookupTable(float sampleRate);
+	float GetSampleRate();
+	unsigned int GetMemorySize();
+};
+
+typedef FastTrack<float, 1> FastScalarTrack;
+typedef FastTrack<vec3, 3> FastVectorTrack;
+typedef FastTrack<quat, 4> FastQuaternionTrack;
+
+// Resamples input at sampleRate if the result stays within tolerance of the source
+// curve (distance for scalar and vector tracks, radians for rotation tracks),
+// otherwise keeps the source keys. Either way the result gets a lookup table.
+template<typename T, int N>
+FastTrack<T, N> OptimizeTrack(Track<T, N>& input, float sampleRate, float tolerance);
+
+template<typename T, int N>
+FastTrack<T, N>::FastTrack() {
+    mSampleRate = 0.0f;
+}
+
+template<typename T, int N>
+T FastTrack<T, N>::Sample(float time, bool looping) {
+    // Wrap or clamp once, the table and the search both take track time
+    float trackTime = this->AdjustTimeToFitTrack(time, looping);
+    int frame = mSampledFrames.size() != 0 ? LookupFrame(trackTime) : Track<T, N>::FrameIndex(trackTime, false);
+    return this->SampleFrame(frame, trackTime);
+}
+
+template<typename T, int N>
+T FastTrack<T, N>::Sample(float time, bool looping, TrackCursor& cursor) {
+    float trackTime = this->AdjustTimeToFitTrack(time, looping);
+    return this->SampleFrame(FrameIndex(trackTime, cursor), trackTime);
+}
+
+template<typename T, int N>
+float FastTrack<T, N>::GetSampleRate() {
+    return mSampleRate;
+}
+
+template<typename T, int N>
+unsigned int FastTrack<T, N>::GetMemorySize() {
+    return Track<T, N>::GetMemorySize() + (unsigned int)(mSampledFrames.size() * sizeof(unsigned int));
+}
+
+template<typename T, int N>
+void FastTrack<T, N>::UpdateIndexLookupTable(float sampleRate) {
+    mSampleRate = sampleRate;
+    mSampledFrames.clear();
+
+    int numFrames = (int)this->mFrames.size();
+    if (numFrames <= 1 || sampleRate <= 0.0f) {
+        return;
+    }
+
+    float startTime = this->GetStartTime();
+    float duration = this->GetEndTime() - startTime;
+    unsigned int numSamples = (unsigned int)(duration * sampleRate) + 2;
+    mSampledFrames.resize(numSamples);
+
+    int frame = 0;
+    for (unsigned int i = 0; i < numSamples; ++i) {
+        float time = startTime + (float)i / sampleRate;
+        while (frame < numFrames - 2 && time >= this->mFrames[frame + 1].mTime) {
+            ++frame;
+        }
+        mSampledFrames[i] = (unsigned int)frame;
+    }
+}
+
+template<typename T, int N>
+int FastTrack<T, N>::LookupFrame(float trackTime) {
+    int last = (int)this->mFrames.size() - 2;
+    if (last < 0 || mSampledFrames.size() == 0) {
+        return -1;
+    }
+
+    int sample = (int)((trackTime - this->mFrames[0].mTime) * mSampleRate);
+    if (sample < 0) {
+        sample = 0;
+    }
+    if (sample >= (int)mSampledFrames.size()) {
+        sample = (int)mSampledFrames.size() - 1;
+    }
+
+    // Keys closer together than the sample rate can leave the table one segment behind
+    int frame = (int)mSampledFrames[sample];
+    while (frame < last && trackTime >= this->mFrames[frame + 1].mTime) {
+        ++frame;
+    }
+    return frame;
+}
+
+template<typename T, int N>
+int FastTrack<T, N>::FrameIndex(float trackTime, TrackCursor& cursor) {
+    if (mSampledFrames.size() == 0) {
+        return Track<T, N>::FrameIndex(trackTime, cursor);
+    }
+    cursor.mFrame = LookupFrame(trackTime);
+    return cursor.mFrame;
+}
+
 #endif 
@@ -1,34 +1,53 @@
 #include "TransformTrack.h"
 
-TransformTrack::TransformTrack() {
+template TTransformTrack<VectorTrack, QuaternionTrack>;
+template TTransformTrack<FastVectorTrack, FastQuaternionTrack>;
+template TTransformTrack<CompactVectorTrack, CompactQuaternionTrack>;
+template TTransformTrack<QuantizedVectorTrack, QuantizedQuaternionTrack>;
+template TTransformTrack<CubicVectorTrack, CubicQuaternionTrack>;
+
+template <typename VTRACK, typename QTRACK>
+TTransformTrack<VTRACK, QTRACK>::TTransformTrack() {
 	mId = 0;
 }
 
-unsigned int TransformTrack::GetId() {
+template <typename VTRACK, typename QTRACK>
+unsigned int TTransformTrack<VTRACK, QTRACK>::GetId() {
 	return mId;
 }
 
-void TransformTrack::SetId(unsigned int id) {
+template <typename VTRACK, typename QTRACK>
+void TTransformTrack<VTRACK, QTRACK>::SetId(unsigned int id) {
 	mId = id;
 }
 
-VectorTrack& TransformTrack::GetPositionTrack() {
+template <typename VTRACK, typename QTRACK>
+VTRACK& TTransformTrack<VTRACK, QTRACK>::GetPositionTrack() {
 	return mPosition;
 }
 
-QuaternionTrack& TransformTrack::GetRotationTrack() {
+template <typename VTRACK, typename QTRACK>
+QTRACK& TTransformTrack<VTRACK, QTRACK>::GetRotationTrack() {
 	return mRotation;
 }
 
-VectorTrack& TransformTrack::GetScaleTrack() {
+template <typename VTRACK, typename QTRACK>
+VTRACK& TTransformTrack<VTRACK, QTRACK>::GetScaleTrack() {
 	return mScale;
 }
 
-bool TransformTrack::IsValid() {
+template <typename VTRACK, typename QTRACK>
+bool TTransformTrack<VTRACK, QTRACK>::IsValid() {
 	return mPosition.Size() > 1 || mRotation.Size() > 1 || mScale.Size() > 1;
 }
 
-float TransformTrack::GetStartTime() {
+template <typename VTRACK, typename QTRACK>
+unsigned int TTransformTrack<VTRACK, QTRACK>::GetMemorySize() {
+	return mPosition.GetMemorySize() + mRotation.GetMemorySize() + mScale.GetMemorySize();
+}
+
+template <typename VTRACK, typename QTRACK>
+float TTransformTrack<VTRACK, QTRACK>::GetStartTime() {
 	float result = 0.0f;
 	bool isSet = false;
 
@@ -54,7 +73,8 @@ float TransformTrack::GetStartTime() {
 	return result;
 }
 
-float TransformTrack::GetEndTime() {
+template <typename VTRACK, typename QTRACK>
+float TTransformTrack<VTRACK, QTRACK>::GetEndTime() {
 	float result = 0.0f;
 	bool isSet = false;
 
@@ -80,17 +100,244 @@ float TransformTrack::GetEndTime() {
 	return result;
 }
 
-Transform TransformTrack::Sample(const Transform& ref,
+template <typename VTRACK, typename QTRACK>
+Transform TTransformTrack<VTRACK, QTRACK>::Sample(const Transform& ref,
 	float time, bool looping) {
 	Transform result = ref; // Assign default values
 	if (mPosition.Size() > 1) { // Only assign if animated
 		result.position = mPosition.Sample(time, looping);
 	}
+	else if (mPosition.Size() == 1) { // Constant, no search or interpolation
+		result.position = mPosition.GetValue(0);
+	}
 	if (mRotation.Size() > 1) { // Only assign if animated
 		result.rotation = mRotation.Sample(time, looping);
 	}
+	else if (mRotation.Size() == 1) { // Constant, no search or interpolation
+		result.rotation = mRotation.GetValue(0);
+	}
 	if (mScale.Size() > 1) { // Only assign if animated
 		result.scale = mScale.Sample(time, looping);
 	}
+	else if (mScale.Size() == 1) { // Constant, no search or interpolation
+		result.scale = mScale.GetValue(0);
+	}
+	return result;
+}
+
+template <typename VTRACK, typename QTRACK>
+Transform TTransformTrack<VTRACK, QTRACK>::Sample(const Transform& ref,
+	float time, bool looping, TransformTrackCursor& cursor) {
+	Transform result = ref; // Assign default values
+	if (mPosition.Size() > 1) { // Only assign if animated
+		result.position = mPosition.Sample(time, looping, cursor.mPosition);
+	}
+	else if (mPosition.Size() == 1) { // Constant, no search or interpolation
+		result.position = mPosition.GetValue(0);
+	}
+	if (mRotation.Size() > 1) { // Only assign if animated
+		result.rotation = mRotation.Sample(time, looping, cursor.mRotation);
+	}
+	else if (mRotation.Size() == 1) { // Constant, no search or interpolation
+		result.rotation = mRotation.GetValue(0);
+	}
+	if (mScale.Size() > 1) { // Only assign if animated
+		result.scale = mScale.Sample(time, looping, cursor.mScale);
+	}
+	else if (mScale.Size() == 1) { // Constant, no search or interpolation
+		result.scale = mScale.GetValue(0);
+	}
+	return result;
+}
+
+FastTransformTrack OptimizeTransformTrack(TransformTrack& input, float sampleRate, float tolerance) {
+	FastTransformTrack result;
+
+	result.SetId(input.GetId());
+	result.GetPositionTrack() = OptimizeTrack<vec3, 3>(input.GetPositionTrack(), sampleRate, tolerance);
+	result.GetRotationTrack() = OptimizeTrack<quat, 4>(input.GetRotationTrack(), sampleRate, tolerance);
+	result.GetScaleTrack() = OptimizeTrack<vec3, 3>(input.GetScaleTrack(), sampleRate, tolerance);
+
+	return result;
+}
+
+CompactTransformTrack PackTransformTrack(TransformTrack& input) {
+	CompactTransformTrack result;
+
+	result.SetId(input.GetId());
+	result.GetPositionTrack() = PackTrack<vec3, 3>(input.GetPositionTrack());
+	result.GetRotationTrack() = PackTrack<quat, 4>(input.GetRotationTrack());
+	result.GetScaleTrack() = PackTrack<vec3, 3>(input.GetScaleTrack());
+
+	return result;
+}
+
+QuantizedTransformTrack QuantizeTransformTrack(TransformTrack& input) {
+	QuantizedTransformTrack result;
+
+	result.SetId(input.GetId());
+	result.GetPositionTrack() = QuantizeTrack<vec3, 3>(input.GetPositionTrack());
+	result.GetRotationTrack() = QuantizeTrack<quat, 4>(input.GetRotationTrack());
+	result.GetScaleTrack() = QuantizeTrack<vec3, 3>(input.GetScaleTrack());
+
+	return result;
+}
+
+CubicTransformTrack PrecomputeTransformTrack(TransformTrack& input) {
+	CubicTransformTrack result;
+
+	result.SetId(input.GetId());
+	result.GetPositionTrack() = PrecomputeTrack<vec3, 3>(input.GetPositionTrack());
+	result.GetRotationTrack() = PrecomputeTrack<quat, 4>(input.GetRotationTrack());
+	result.GetScaleTrack() = PrecomputeTrack<vec3, 3>(input.GetScaleTrack());
+
+	return result;
+}
+
+TransformTrack ReduceTransformTrack(TransformTrack& input, float positionError, float angleError, float scaleError) {
+	TransformTrack result;
+
+	result.SetId(input.GetId());
+	result.GetPositionTrack() = ReduceTrack<vec3, 3>(input.GetPositionTrack(), positionError);
+	result.GetRotationTrack() = ReduceTrack<quat, 4>(input.GetRotationTrack(), angleError);
+	result.GetScaleTrack() = ReduceTrack<vec3, 3>(input.GetScaleTrack(), scaleError);
+
+	return result;
+}
+
+namespace TransformTrackHelpers {
+	inline vec3 Delta(const vec3& value, const vec3& reference) {
+		return value - reference;
+	}
+
+	inline quat Delta(const quat& value, const quat& reference) {
+		return inverse(reference) * value;
+	}
+
+	// The part of Delta that is linear in value, applied to tangents
+	inline vec3 DeltaTangent(const vec3& tangent, const vec3&) {
+		return tangent;
+	}
+
+	inline quat DeltaTangent(const quat& tangent, const quat& reference) {
+		return inverse(reference) * tangent;
+	}
+
+	// The reference channel at time, or constant if the reference does not animate it
+	template<typename T, int N>
+	T ReferenceAt(Track<T, N>* reference, const T& constant, float time, bool looping) {
+		if (reference == 0 || reference->Size() == 0) {
+			return constant;
+		}
+		if (reference->Size() == 1) {
+			return reference->GetValue(0);
+		}
+		return reference->Sample(time, looping);
+	}
+
+	// Key times of both tracks, plus sampleRate keys in between if either one is cubic.
+	// They span the input's keys, or the reference's if the input does not animate
+	template<typename T, int N>
+	void AdditiveKeyTimes(Track<T, N>& input, Track<T, N>& reference, float sampleRate, std::vector<float>& outTimes) {
+		outTimes.clear();
+		unsigned int size = input.Size();
+		for (unsigned int i = 0; i < size; ++i) {
+			outTimes.push_back(input[i].mTime);
+		}
+		bool animated = size > 1;
+		float start = animated ? input.GetStartTime() : reference.GetStartTime();
+		float end = animated ? input.GetEndTime() : reference.GetEndTime();
+		for (unsigned int i = 0, numReference = reference.Size(); i < numReference; ++i) {
+			float time = reference[i].mTime;
+			if (time >= start && time <= end) {
+				outTimes.push_back(time);
+			}
+		}
+		if (input.GetInterpolation() == Interpolation::Cubic || reference.GetInterpolation() == Interpolation::Cubic) {
+			unsigned int samples = (unsigned int)ceilf((end - start) * sampleRate - 0.001f);
+			for (unsigned int i = 1; i < samples; ++i) {
+				outTimes.push_back(start + (end - start) * ((float)i / (float)samples));
+			}
+		}
+		std::sort(outTimes.begin(), outTimes.end());
+		unsigned int count = 0;
+		for (unsigned int i = 0, numTimes = (unsigned int)outTimes.size(); i < numTimes; ++i) {
+			if (count == 0 || outTimes[i] - outTimes[count - 1] > 0.0001f) {
+				outTimes[count++] = outTimes[i];
+			}
+		}
+		outTimes.resize(count);
+	}
+
+	template<typename T, int N>
+	Track<T, N> MakeAdditiveTrack(Track<T, N>& input, Track<T, N>* reference, const T& constant, bool looping, float sampleRate) {
+		unsigned int size = input.Size();
+		if (reference != 0 && reference->Size() > 1) {
+			// The delta of two curves is not a curve of the same kind, resample it linearly.
+			// An input that does not animate still follows the reference over time, from
+			// its one key or, without keys, from the rest value the pose keeps
+			std::vector<float> times;
+			AdditiveKeyTimes(input, *reference, sampleRate, times);
+			Interpolation interpolation = size > 1 ? input.GetInterpolation() : reference->GetInterpolation();
+			Track<T, N> result;
+			result.SetInterpolation(interpolation == Interpolation::Constant ? Interpolation::Constant : Interpolation::Linear);
+			result.Resize((unsigned int)times.size());
+			for (unsigned int i = 0, numTimes = (unsigned int)times.size(); i < numTimes; ++i) {
+				T value = size > 1 ? input.Sample(times[i], false) : (size == 1 ? input.GetValue(0) : constant);
+				T delta = Delta(value, ReferenceAt(reference, constant, times[i], looping));
+				Frame<N>& frame = result[i];
+				frame.mTime = times[i];
+				memcpy(frame.mValue, &delta, N * sizeof(float));
+				memset(frame.mIn, 0, N * sizeof(float));
+				memset(frame.mOut, 0, N * sizeof(float));
+			}
+			return result;
+		}
+
+		// A fixed reference, every key and tangent converts on its own
+		Track<T, N> result = input;
+		T ref = ReferenceAt(reference, constant, size > 0 ? input[0].mTime : 0.0f, looping);
+		for (unsigned int i = 0; i < size; ++i) {
+			Frame<N>& frame = result[i];
+			T delta = Delta(input.GetValue(i), ref);
+			memcpy(frame.mValue, &delta, N * sizeof(float));
+			if (input.GetInterpolation() != Interpolation::Cubic) {
+				continue;
+			}
+			T in;
+			T out;
+			memcpy(&in, frame.mIn, N * sizeof(float));
+			memcpy(&out, frame.mOut, N * sizeof(float));
+			in = DeltaTangent(in, ref);
+			out = DeltaTangent(out, ref);
+			memcpy(frame.mIn, &in, N * sizeof(float));
+			memcpy(frame.mOut, &out, N * sizeof(float));
+		}
+		return result;
+	}
+} // End TransformTrackHelpers namespace
+
+TransformTrack MakeAdditiveTransformTrack(TransformTrack& input, const Transform& reference) {
+	TransformTrack result;
+
+	result.SetId(input.GetId());
+	result.GetPositionTrack() = TransformTrackHelpers::MakeAdditiveTrack<vec3, 3>(input.GetPositionTrack(), 0, reference.position, false, 0.0f);
+	result.GetRotationTrack() = TransformTrackHelpers::MakeAdditiveTrack<quat, 4>(input.GetRotationTrack(), 0, reference.rotation, false, 0.0f);
+	result.GetScaleTrack() = TransformTrackHelpers::MakeAdditiveTrack<vec3, 3>(input.GetScaleTrack(), 0, reference.scale, false, 0.0f);
+
+	return result;
+}
+
+TransformTrack MakeAdditiveTransformTrack(TransformTrack& input, TransformTrack& reference, const Transform& rest, bool looping, float sampleRate) {
+	TransformTrack result;
+
+	result.SetId(input.GetId());
+	result.GetPositionTrack() = TransformTrackHelpers::MakeAdditiveTrack<vec3, 3>(input.GetPositionTrack(),
+		&reference.GetPositionTrack(), rest.position, looping, sampleRate);
+	result.GetRotationTrack() = TransformTrackHelpers::MakeAdditiveTrack<quat, 4>(input.GetRotationTrack(),
+		&reference.GetRotationTrack(), rest.rotation, looping, sampleRate);
+	result.GetScaleTrack() = TransformTrackHelpers::MakeAdditiveTrack<vec3, 3>(input.GetScaleTrack(),
+		&reference.GetScaleTrack(), rest.scale, looping, sampleRate);
+
 	return result;
 }
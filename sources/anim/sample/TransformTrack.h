@@ -2,25 +2,59 @@
 #define _H_TRANSFORMTRACK_
 
 #include "Track.h"
+#include "CompactTrack.h"
+#include "QuantizedTrack.h"
+#include "CubicTrack.h"
 #include "Transform.h"
 
-class TransformTrack {
+struct TransformTrackCursor {
+	TrackCursor mPosition;
+	TrackCursor mRotation;
+	TrackCursor mScale;
+};
+
+template <typename VTRACK, typename QTRACK>
+class TTransformTrack {
 protected:
 	unsigned int mId;
-	VectorTrack mPosition;
-	QuaternionTrack mRotation;
-	VectorTrack mScale;
+	VTRACK mPosition;
+	QTRACK mRotation;
+	VTRACK mScale;
 public:
-	TransformTrack();
+	TTransformTrack();
 	unsigned int GetId();
 	void SetId(unsigned int id);
-	VectorTrack& GetPositionTrack();
-	QuaternionTrack& GetRotationTrack();
-	VectorTrack& GetScaleTrack();
+	VTRACK& GetPositionTrack();
+	QTRACK& GetRotationTrack();
+	VTRACK& GetScaleTrack();
 	float GetStartTime();
 	float GetEndTime();
 	bool IsValid();
+	unsigned int GetMemorySize();
 	Transform Sample(const Transform& ref, float time, bool looping);
+	Transform Sample(const Transform& ref, float time, bool looping, TransformTrackCursor& cursor);
 };
 
+typedef TTransformTrack<VectorTrack, QuaternionTrack> TransformTrack;
+typedef TTransformTrack<FastVectorTrack, FastQuaternionTrack> FastTransformTrack;
+typedef TTransformTrack<CompactVectorTrack, CompactQuaternionTrack> CompactTransformTrack;
+typedef TTransformTrack<QuantizedVectorTrack, QuantizedQuaternionTrack> QuantizedTransformTrack;
+typedef TTransformTrack<CubicVectorTrack, CubicQuaternionTrack> CubicTransformTrack;
+
+FastTransformTrack OptimizeTransformTrack(TransformTrack& input, float sampleRate, float tolerance);
+CompactTransformTrack PackTransformTrack(TransformTrack& input);
+QuantizedTransformTrack QuantizeTransformTrack(TransformTrack& input);
+CubicTransformTrack PrecomputeTransformTrack(TransformTrack& input);
+// Reduces every channel with ReduceTrack, positionError and scaleError are distances,
+// angleError is in radians
+TransformTrack ReduceTransformTrack(TransformTrack& input, float positionError, float angleError, float scaleError);
+// Stores every key as a delta from reference: positions and scales subtract it, rotations
+// become inverse(reference) * key. Tangents are converted the same way.
+TransformTrack MakeAdditiveTransformTrack(TransformTrack& input, const Transform& reference);
+// As above, against the reference track sampled on top of rest. Channels the reference
+// animates are resampled linearly at the key times of both tracks, and at sampleRate if
+// either one is cubic, since the delta of two curves is not a curve of the same kind.
+TransformTrack MakeAdditiveTransformTrack(TransformTrack& input, TransformTrack& reference, const Transform& rest,
+	bool looping, float sampleRate = 30.0f);
+
 #endif
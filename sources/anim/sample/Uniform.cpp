@@ -6,6 +6,7 @@
 #include "vec4.h"
 #include "mat4.h"
 #include "quat.h"
+#include "DualQuaternion.h"
 
 template Uniform<int>;
 template Uniform<ivec4>;
@@ -16,6 +17,7 @@ template Uniform<vec3>;
 template Uniform<vec4>;
 template Uniform<quat>;
 template Uniform<mat4>;
+template Uniform<DualQuaternion>;
 
 template Uniform<glm::ivec4>;
 template Uniform<glm::ivec2>;
@@ -49,6 +51,12 @@ void Uniform<mat4>::Set(unsigned int slot, mat4* inputArray, unsigned int arrayL
 	glUniformMatrix4fv(slot, (GLsizei)arrayLength, false, (float*)&inputArray[0]);
 }
 
+// mat2x4 in the shader, the real part is the first column
+template<>
+void Uniform<DualQuaternion>::Set(unsigned int slot, DualQuaternion* inputArray, unsigned int arrayLength) {
+	glUniformMatrix2x4fv(slot, (GLsizei)arrayLength, false, (float*)&inputArray[0]);
+}
+
 template<>
 void Uniform<glm::mat4>::Set(unsigned int slot, glm::mat4* inputArray, unsigned int arrayLength) {
 	glUniformMatrix4fv(slot, (GLsizei)arrayLength, false, (float*)&inputArray[0]);
@@ -0,0 +1,103 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool() {
+	mNextJob = 0;
+	mJob = 0;
+	mContext = 0;
+	mNumJobs = 0;
+	mGeneration = 0;
+	mNumActive = 0;
+	mQuit = false;
+}
+
+WorkerPool::~WorkerPool() {
+	Stop();
+}
+
+void WorkerPool::Start(unsigned int numThreads) {
+	Stop();
+	// After a restart the generation is whatever the last batch left, new threads must
+	// only wake for batches that come after it
+	unsigned int generation;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = false;
+		generation = mGeneration;
+	}
+	mThreads.reserve(numThreads);
+	for (unsigned int i = 0; i < numThreads; ++i) {
+		mThreads.push_back(std::thread(&WorkerPool::WorkerLoop, this, generation));
+	}
+}
+
+void WorkerPool::Stop() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mWake.notify_all();
+	for (unsigned int i = 0, size = (unsigned int)mThreads.size(); i < size; ++i) {
+		mThreads[i].join();
+	}
+	mThreads.clear();
+}
+
+unsigned int WorkerPool::Size() {
+	return (unsigned int)mThreads.size();
+}
+
+void WorkerPool::RunJobs() {
+	for (unsigned int i = mNextJob.fetch_add(1); i < mNumJobs; i = mNextJob.fetch_add(1)) {
+		mJob(mContext, i);
+	}
+}
+
+void WorkerPool::WorkerLoop(unsigned int generation) {
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWake.wait(lock, [&]() { return mQuit || mGeneration != generation; });
+			if (mQuit) {
+				return;
+			}
+			generation = mGeneration;
+		}
+
+		RunJobs();
+
+		// Every thread checks in before Run returns, so none can still be reading
+		// this batch's job when the next one is set up
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (--mNumActive == 0) {
+			mDone.notify_one();
+		}
+	}
+}
+
+void WorkerPool::Run(WorkerJob job, void* context, unsigned int numJobs) {
+	if (numJobs == 0) {
+		return;
+	}
+	if (mThreads.size() == 0 || numJobs == 1) {
+		for (unsigned int i = 0; i < numJobs; ++i) {
+			job(context, i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJob = job;
+		mContext = context;
+		mNumJobs = numJobs;
+		mNextJob = 0;
+		mNumActive = (unsigned int)mThreads.size();
+		mGeneration += 1;
+	}
+	mWake.notify_all();
+
+	RunJobs();
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mDone.wait(lock, [&]() { return mNumActive == 0; });
+}
@@ -0,0 +1,48 @@
+#ifndef _H_WORKERPOOL_
+#define _H_WORKERPOOL_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Job callback, index runs from 0 to the count passed to Run
+typedef void (*WorkerJob)(void* context, unsigned int index);
+
+// Persistent threads that split a batch of numbered jobs with the calling thread.
+// Threads are created once in Start and sleep between batches, Run hands out job
+// indices through an atomic counter and returns only after every job has finished,
+// so whatever the jobs wrote can be used (or uploaded) straight away.
+class WorkerPool {
+protected:
+	std::vector<std::thread> mThreads;
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::condition_variable mDone;
+	std::atomic<unsigned int> mNextJob;
+	WorkerJob mJob;
+	void* mContext;
+	unsigned int mNumJobs;
+	unsigned int mGeneration;
+	unsigned int mNumActive;
+	bool mQuit;
+protected:
+	// generation is the last batch the thread must not run
+	void WorkerLoop(unsigned int generation);
+	void RunJobs();
+private:
+	WorkerPool(const WorkerPool&);
+	WorkerPool& operator=(const WorkerPool&);
+public:
+	WorkerPool();
+	~WorkerPool();
+	// numThreads is the number of threads besides the caller, 0 runs every job inline
+	void Start(unsigned int numThreads);
+	void Stop();
+	// Threads besides the caller
+	unsigned int Size();
+	void Run(WorkerJob job, void* context, unsigned int numJobs);
+};
+
+#endif